@@ -18,6 +18,28 @@ void block_endorse::erase(const uint64_t height) {
     while (endorsement_itr != _endorsement.end()) {
         endorsement_itr = _endorsement.erase(endorsement_itr);
     }
+
+    // endorsements of the height that were never migrated
+    block_endorse::legacy_endorsement_table _legacy_endorsement(get_self(), height);
+    auto legacy_itr = _legacy_endorsement.begin();
+    while (legacy_itr != _legacy_endorsement.end()) {
+        legacy_itr = _legacy_endorsement.erase(legacy_itr);
+    }
+}
+
+//@auth get_self()
+[[eosio::action]]
+void block_endorse::migrateendt(const uint64_t height) {
+    require_auth(get_self());
+
+    auto config = _config.get();
+    block_endorse::legacy_endorsement_table _legacy_endorsement(get_self(), height);
+    auto legacy_itr = _legacy_endorsement.begin();
+    check(legacy_itr != _legacy_endorsement.end(), "blkendt.xsat::migrateendt: no legacy endorsements at this height");
+    while (legacy_itr != _legacy_endorsement.end()) {
+        migrate_endorsement(height, *legacy_itr, config);
+        legacy_itr = _legacy_endorsement.erase(legacy_itr);
+    }
 }
 
 //@auth get_self()
@@ -40,6 +62,10 @@ void block_endorse::config(const uint64_t limit_endorse_height, const uint16_t l
     config.consensus_interval_seconds = consensus_interval_seconds;
     config.min_xsat_qualification = min_xsat_qualification;
     _config.set(config, get_self());
+
+    // keep the qualified validators of endrmng.xsat on the same threshold
+    endorse_manage::setxsatqual_action _setxsatqual(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+    _setxsatqual.send(min_xsat_qualification);
 }
 
 //@auth validator
@@ -47,15 +73,51 @@ void block_endorse::config(const uint64_t limit_endorse_height, const uint16_t l
 void block_endorse::endorse(const name& validator, const uint64_t height, const checksum256& hash) {
     require_auth(validator);
 
-    // Verify whether the endorsement height exceeds limit_endorse_height, 0 means no limit
     auto config = _config.get();
-    check(config.limit_endorse_height == 0 || config.limit_endorse_height >= height,
-          "1001:blkendt.xsat::endorse: the current endorsement status is disabled");
+    utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto chain_state = _chain_state.get();
+
+    // fee deduction
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    pay.send(height, hash, validator, ENDORSE, 1);
+
+    if (endorse_block(validator, height, hash, config, chain_state)) {
+        utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _consensus.send(height, hash);
+    }
+}
+
+//@auth validator
+[[eosio::action]]
+void block_endorse::batchendorse(const name& validator, const std::vector<endorse_block_info>& blocks) {
+    require_auth(validator);
+    check(!blocks.empty(), "blkendt.xsat::batchendorse: blocks cannot be empty");
 
+    // Shared state is read once for the whole batch
+    auto config = _config.get();
     utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto chain_state = _chain_state.get();
+
+    // fee deduction, one payment covering every endorsement
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    pay.send(blocks.front().height, blocks.front().hash, validator, ENDORSE, blocks.size());
+
+    utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+    for (const auto& block : blocks) {
+        if (endorse_block(validator, block.height, block.hash, config, chain_state)) {
+            _consensus.send(block.height, block.hash);
+        }
+    }
+}
+
+template <typename T>
+bool block_endorse::endorse_block(const name& validator, const uint64_t height, const checksum256& hash,
+                                  const config_row& config, const T& chain_state) {
+    // Verify whether the endorsement height exceeds limit_endorse_height, 0 means no limit
+    check(config.limit_endorse_height == 0 || config.limit_endorse_height >= height,
+          "1001:blkendt.xsat::endorse: the current endorsement status is disabled");
 
     // Blocks that are already irreversible do not need to be endorsed
-    auto chain_state = _chain_state.get();
     check(chain_state.irreversible_height < height && chain_state.migrating_height != height,
           "1002:blkendt.xsat::endorse: the current block is irreversible and does not need to be endorsed");
 
@@ -65,13 +127,20 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
         "1003:blkendt.xsat::endorse: the endorsement height cannot exceed height "
             + std::to_string(chain_state.parsed_height + config.limit_num_endorsed_blocks));
 
-    // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, validator, ENDORSE, 1);
-
     block_endorse::endorsement_table _endorsement(get_self(), height);
     auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
     auto endorsement_itr = endorsement_idx.find(hash);
+    if (endorsement_itr == endorsement_idx.end()) {
+        // Endorsements recorded before the upgrade are carried over before this one is added
+        block_endorse::legacy_endorsement_table _legacy_endorsement(get_self(), height);
+        auto legacy_idx = _legacy_endorsement.get_index<"byhash"_n>();
+        auto legacy_itr = legacy_idx.find(hash);
+        if (legacy_itr != legacy_idx.end()) {
+            migrate_endorsement(height, *legacy_itr, config);
+            legacy_idx.erase(legacy_itr);
+            endorsement_itr = endorsement_idx.find(hash);
+        }
+    }
     bool reached_consensus = false;
     if (endorsement_itr == endorsement_idx.end()) {
         // Verify whether the endorsement time of the next height is reached
@@ -91,88 +160,188 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
 
         bool xsat_stake_active
             = config.xsat_stake_activation_height > 0 && height >= config.xsat_stake_activation_height;
-        // Obtain qualified validators based on the pledge amount.
+        // Qualified validators are snapshotted once per epoch based on the pledge amount.
         // If the block height of the activated xsat pledge amount is reached, directly switch to xsat pledge, otherwise use the btc pledge amount.
-        std::vector<requested_validator_info> requested_validators
-            = xsat_stake_active ? get_valid_validator_by_xsat_stake(config.min_xsat_qualification.amount)
-                                : get_valid_validator_by_btc_stake();
-        check(requested_validators.size() >= config.min_validators,
+        const auto validator_set = get_validator_set(
+            height, xsat_stake_active,
+            xsat_stake_active ? config.min_xsat_qualification.amount : MIN_BTC_STAKE_FOR_VALIDATOR,
+            chain_state.irreversible_height);
+        check(validator_set.num_validators >= config.min_validators,
               "1004:blkendt.xsat::endorse: the number of valid validators must be greater than or equal to "
                   + std::to_string(config.min_validators));
 
-        auto itr = std::find_if(requested_validators.begin(), requested_validators.end(),
-                                [&](const requested_validator_info& a) {
-                                    return a.account == validator;
-                                });
+        validator_member_table _validator_member(get_self(), validator_set.id);
+        auto member_itr = _validator_member.find(validator.value);
         auto err_msg = xsat_stake_active ? "1005:blkendt.xsat::endorse: the validator has less than "
                                                + config.min_xsat_qualification.to_string() + " staked"
                                          : "1005:blkendt.xsat::endorse: the validator has less than 100 BTC staked";
-        check(itr != requested_validators.end(), err_msg);
-        provider_validator_info provider_info{
-            .account = itr->account, .staking = itr->staking, .created_at = current_time_point()};
-        requested_validators.erase(itr);
+        check(member_itr != _validator_member.end(), err_msg);
         auto endt_itr = _endorsement.emplace(get_self(), [&](auto& row) {
             row.id = _endorsement.available_primary_key();
             row.hash = hash;
-            row.provider_validators.push_back(provider_info);
-            row.requested_validators = requested_validators;
+            row.validator_set_id = validator_set.id;
+            row.num_validators = validator_set.num_validators;
+            row.provider_bitmap.resize((validator_set.num_validators + 7) / 8);
+            endorsement_row::set(row.provider_bitmap, member_itr->index);
+            row.created_at = current_time_point();
+            if (row.reached_consensus()) {
+                row.consensus_bitmap = row.provider_bitmap;
+            }
         });
-        reached_consensus = endt_itr->num_reached_consensus() <= endt_itr->provider_validators.size();
+        reached_consensus = endt_itr->reached_consensus();
     } else {
-        check(std::find_if(endorsement_itr->provider_validators.begin(), endorsement_itr->provider_validators.end(),
-                           [&](const provider_validator_info& a) {
-                               return a.account == validator;
-                           })
-                  == endorsement_itr->provider_validators.end(),
+        validator_member_table _validator_member(get_self(), endorsement_itr->validator_set_id);
+        auto member_itr = _validator_member.find(validator.value);
+        check(member_itr != _validator_member.end(),
+              "1007:blkendt.xsat::endorse: the validator has less than 100 BTC staked");
+        check(!endorsement_itr->is_endorsed(member_itr->index),
               "1006:blkendt.xsat::endorse: validator is on the list of provider validators");
 
-        auto itr = std::find_if(endorsement_itr->requested_validators.begin(),
-                                endorsement_itr->requested_validators.end(), [&](const requested_validator_info& a) {
-                                    return a.account == validator;
-                                });
-        check(itr != endorsement_itr->requested_validators.end(),
-              "1007:blkendt.xsat::endorse: the validator has less than 100 BTC staked");
         endorsement_idx.modify(endorsement_itr, same_payer, [&](auto& row) {
-            row.provider_validators.push_back(
-                {.account = itr->account, .staking = itr->staking, .created_at = current_time_point()});
-            row.requested_validators.erase(itr);
+            endorsement_row::set(row.provider_bitmap, member_itr->index);
+            if (row.consensus_bitmap.empty() && row.reached_consensus()) {
+                row.consensus_bitmap = row.provider_bitmap;
+            }
         });
-        reached_consensus = endorsement_itr->num_reached_consensus() <= endorsement_itr->provider_validators.size();
+        reached_consensus = endorsement_itr->reached_consensus();
     }
 
-    if (reached_consensus) {
-        utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
-        _consensus.send(height, hash);
+    return reached_consensus;
+}
+
+block_endorse::validator_set_row block_endorse::get_validator_set(const uint64_t height, const bool xsat_stake_active,
+                                                                  const uint64_t min_qualification,
+                                                                  const uint64_t irreversible_height) {
+    // Reuse the snapshot of the current epoch unless the qualification rules changed since it was taken
+    const uint64_t epoch = height / CHAIN_PARAMS.difficulty_adjustment_interval();
+    auto validator_set_idx = _validator_set.get_index<"byepoch"_n>();
+    auto validator_set_itr = validator_set_idx.lower_bound(epoch);
+    while (validator_set_itr != validator_set_idx.end() && validator_set_itr->epoch == epoch) {
+        if (validator_set_itr->xsat_stake_active == xsat_stake_active
+            && validator_set_itr->min_qualification == min_qualification) {
+            return *validator_set_itr;
+        }
+        validator_set_itr++;
     }
+
+    prune_validator_sets(irreversible_height);
+
+    std::vector<requested_validator_info> validators
+        = xsat_stake_active ? get_valid_validator_by_xsat_stake() : get_valid_validator_by_btc_stake();
+    check(validators.size() <= std::numeric_limits<uint16_t>::max(),
+          "blkendt.xsat::endorse: too many validators to snapshot");
+
+    const uint64_t validator_set_id = _validator_set.available_primary_key();
+    validator_member_table _validator_member(get_self(), validator_set_id);
+    for (uint16_t index = 0; index < validators.size(); index++) {
+        _validator_member.emplace(get_self(), [&](auto& row) {
+            row.account = validators[index].account;
+            row.index = index;
+            row.staking = validators[index].staking;
+        });
+    }
+
+    auto new_itr = _validator_set.emplace(get_self(), [&](auto& row) {
+        row.id = validator_set_id;
+        row.epoch = epoch;
+        row.xsat_stake_active = xsat_stake_active;
+        row.min_qualification = min_qualification;
+        row.num_validators = validators.size();
+        row.created_at = current_time_point();
+    });
+    return *new_itr;
 }
 
-std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_validator_by_btc_stake() {
-    endorse_manage::validator_table _validator
-        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
-    auto idx = _validator.get_index<"byqualifictn"_n>();
-    auto itr = idx.lower_bound(MIN_BTC_STAKE_FOR_VALIDATOR);
-    std::vector<requested_validator_info> result;
-    while (itr != idx.end()) {
-        result.emplace_back(
-            requested_validator_info{.account = itr->owner, .staking = static_cast<uint64_t>(itr->quantity.amount)});
-        itr++;
+void block_endorse::prune_validator_sets(const uint64_t irreversible_height) {
+    // Snapshots older than the previous epoch of the irreversible height are no longer referenced by pending endorsements
+    const uint64_t irreversible_epoch = irreversible_height / CHAIN_PARAMS.difficulty_adjustment_interval();
+    auto validator_set_itr = _validator_set.begin();
+    if (validator_set_itr == _validator_set.end() || validator_set_itr->epoch + 1 >= irreversible_epoch) {
+        return;
     }
-    return result;
+
+    validator_member_table _validator_member(get_self(), validator_set_itr->id);
+    auto member_itr = _validator_member.begin();
+    while (member_itr != _validator_member.end()) {
+        member_itr = _validator_member.erase(member_itr);
+    }
+    _validator_set.erase(validator_set_itr);
 }
 
-std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_validator_by_xsat_stake(
-    const uint64_t min_xsat_qualification) {
-    endorse_manage::validator_table _validator
-        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
-    auto idx = _validator.get_index<"bystakedxsat"_n>();
-    auto itr = idx.lower_bound(min_xsat_qualification);
-    std::vector<requested_validator_info> result;
-    while (itr != idx.end()) {
-        if (itr->quantity.amount > 0) {
-            result.emplace_back(requested_validator_info{.account = itr->owner,
-                                                         .staking = static_cast<uint64_t>(itr->quantity.amount)});
+void block_endorse::migrate_endorsement(const uint64_t height, const legacy_endorsement_row& legacy,
+                                        const config_row& config) {
+    block_endorse::endorsement_table _endorsement(get_self(), height);
+    auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
+    check(endorsement_idx.find(legacy.hash) == endorsement_idx.end(),
+          "blkendt.xsat::migrateendt: the block already has an endorsement in endorsebits");
+
+    // The endorsed validators take the first bits in endorsement order, followed by the unendorsed ones
+    const uint64_t validator_set_id = _validator_set.available_primary_key();
+    validator_member_table _validator_member(get_self(), validator_set_id);
+    uint16_t index = 0;
+    for (const auto& validator : legacy.provider_validators) {
+        _validator_member.emplace(get_self(), [&](auto& row) {
+            row.account = validator.account;
+            row.index = index++;
+            row.staking = validator.staking;
+        });
+    }
+    for (const auto& validator : legacy.requested_validators) {
+        _validator_member.emplace(get_self(), [&](auto& row) {
+            row.account = validator.account;
+            row.index = index++;
+            row.staking = validator.staking;
+        });
+    }
+
+    // A zero `min_qualification` never matches the rules of a new endorsement, so the snapshot is not reused
+    const uint16_t num_validators = legacy.num_validators();
+    _validator_set.emplace(get_self(), [&](auto& row) {
+        row.id = validator_set_id;
+        row.epoch = height / CHAIN_PARAMS.difficulty_adjustment_interval();
+        row.xsat_stake_active
+            = config.xsat_stake_activation_height > 0 && height >= config.xsat_stake_activation_height;
+        row.min_qualification = 0;
+        row.num_validators = num_validators;
+        row.created_at = current_time_point();
+    });
+
+    // rwddist.xsat used to pay consensus rewards to the first `num_reached_consensus` endorsers
+    const uint16_t num_providers = legacy.provider_validators.size();
+    _endorsement.emplace(get_self(), [&](auto& row) {
+        row.id = _endorsement.available_primary_key();
+        row.hash = legacy.hash;
+        row.validator_set_id = validator_set_id;
+        row.num_validators = num_validators;
+        row.provider_bitmap.resize((num_validators + 7) / 8);
+        for (uint16_t i = 0; i < num_providers; i++) {
+            endorsement_row::set(row.provider_bitmap, i);
         }
-        itr++;
+        if (legacy.reached_consensus()) {
+            row.consensus_bitmap.resize(row.provider_bitmap.size());
+            for (uint16_t i = 0; i < legacy.num_reached_consensus(); i++) {
+                endorsement_row::set(row.consensus_bitmap, i);
+            }
+        }
+        row.created_at = num_providers > 0 ? legacy.provider_validators.front().created_at : current_time_point();
+    });
+}
+
+std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_validator_by_btc_stake() {
+    return get_qualified_validators(endorse_manage::BTC_QUALIFIED_SCOPE);
+}
+
+std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_validator_by_xsat_stake() {
+    return get_qualified_validators(endorse_manage::XSAT_QUALIFIED_SCOPE);
+}
+
+std::vector<block_endorse::requested_validator_info> block_endorse::get_qualified_validators(const name& scope) {
+    // endrmng.xsat maintains the qualified validators on every stake change
+    endorse_manage::qualified_validator_table _qualified(ENDORSER_MANAGE_CONTRACT, scope.value);
+    std::vector<requested_validator_info> result;
+    for (auto itr = _qualified.begin(); itr != _qualified.end(); itr++) {
+        result.emplace_back(
+            requested_validator_info{.account = itr->validator, .staking = static_cast<uint64_t>(itr->quantity.amount)});
     }
     return result;
 }
\ No newline at end of file
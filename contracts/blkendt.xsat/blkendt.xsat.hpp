@@ -50,6 +50,148 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     };
     typedef eosio::singleton<"config"_n, config_row> config_table;
 
+    /**
+     * ## TABLE `valsets`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key, referenced by `endorsebits.validator_set_id`
+     * - `{uint64_t} epoch` - the difficulty adjustment epoch (`height / 2016`) the snapshot was taken for
+     * - `{bool} xsat_stake_active` - whether validators were qualified by XSAT stake instead of BTC stake
+     * - `{uint64_t} min_qualification` - the minimum stake used to qualify validators for this snapshot, 0 for a snapshot migrated from `endorsements`
+     * - `{uint16_t} num_validators` - the number of qualified validators in the snapshot
+     * - `{time_point_sec} created_at` - created at time
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 0,
+     *   "epoch": 416,
+     *   "xsat_stake_active": false,
+     *   "min_qualification": "10000000000",
+     *   "num_validators": 3,
+     *   "created_at": "2024-08-13T00:00:00"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] validator_set_row {
+        uint64_t id;
+        uint64_t epoch;
+        bool xsat_stake_active;
+        uint64_t min_qualification;
+        uint16_t num_validators;
+        time_point_sec created_at;
+        uint64_t primary_key() const { return id; }
+        uint64_t by_epoch() const { return epoch; }
+    };
+    typedef eosio::multi_index<
+        "valsets"_n, validator_set_row,
+        eosio::indexed_by<"byepoch"_n, const_mem_fun<validator_set_row, uint64_t, &validator_set_row::by_epoch>>>
+        validator_set_table;
+
+    /**
+     * ## TABLE `valmembers`
+     *
+     * ### scope `validator_set_id`
+     * ### params
+     *
+     * - `{name} account` - primary key, validator account
+     * - `{uint16_t} index` - the validator's bit position in the endorsement bitmap
+     * - `{uint64_t} staking` - the validator's staking amount when the snapshot was taken
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "account": "alice",
+     *   "index": 0,
+     *   "staking": "10000000000"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] validator_member_row {
+        name account;
+        uint16_t index;
+        uint64_t staking;
+        uint64_t primary_key() const { return account.value; }
+        uint64_t by_index() const { return index; }
+    };
+    typedef eosio::multi_index<
+        "valmembers"_n, validator_member_row,
+        eosio::indexed_by<"byindex"_n, const_mem_fun<validator_member_row, uint64_t, &validator_member_row::by_index>>>
+        validator_member_table;
+
+    /**
+     * ## TABLE `endorsebits`
+     *
+     * ### scope `height`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{checksum256} hash` - endorsement block hash
+     * - `{uint64_t} validator_set_id` - the `valsets` snapshot the bitmaps are indexed against
+     * - `{uint16_t} num_validators` - the number of validators in the snapshot
+     * - `{std::vector<uint8_t>} provider_bitmap` - bit `index` is set once the validator at `index` has endorsed
+     * - `{std::vector<uint8_t>} consensus_bitmap` - copy of `provider_bitmap` taken when consensus was first reached, empty before that
+     * - `{time_point_sec} created_at` - created at time
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 0,
+     *   "hash": "00000000000000000000da20f7d8e9e6412d4f1d8b62d88264cddbdd48256ba0",
+     *   "validator_set_id": 0,
+     *   "num_validators": 3,
+     *   "provider_bitmap": "03",
+     *   "consensus_bitmap": "03",
+     *   "created_at": "2024-08-13T00:00:00"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] endorsement_row {
+        uint64_t id;
+        checksum256 hash;
+        uint64_t validator_set_id;
+        uint16_t num_validators;
+        std::vector<uint8_t> provider_bitmap;
+        std::vector<uint8_t> consensus_bitmap;
+        time_point_sec created_at;
+        uint64_t primary_key() const { return id; }
+        checksum256 by_hash() const { return hash; }
+
+        uint16_t num_endorsed() const {
+            uint16_t count = 0;
+            for (const auto byte : provider_bitmap) {
+                count += __builtin_popcount(byte);
+            }
+            return count;
+        }
+
+        bool is_endorsed(const uint16_t index) const { return is_set(provider_bitmap, index); }
+
+        bool is_consensus_provider(const uint16_t index) const { return is_set(consensus_bitmap, index); }
+
+        uint64_t num_reached_consensus() const { return xsat::utils::num_reached_consensus(num_validators); }
+
+        bool reached_consensus() const {
+            const auto endorsed = num_endorsed();
+            return endorsed > 0 && endorsed >= num_reached_consensus();
+        }
+
+        static bool is_set(const std::vector<uint8_t>& bitmap, const uint16_t index) {
+            return index / 8 < bitmap.size() && (bitmap[index / 8] >> (index % 8)) & 1;
+        }
+
+        static void set(std::vector<uint8_t>& bitmap, const uint16_t index) { bitmap[index / 8] |= 1 << (index % 8); }
+    };
+    typedef eosio::multi_index<
+        "endorsebits"_n, endorsement_row,
+        eosio::indexed_by<"byhash"_n, const_mem_fun<endorsement_row, checksum256, &endorsement_row::by_hash>>>
+        endorsement_table;
+
     /**
      * ## STRUCT `requested_validator_info`
      *
@@ -97,12 +239,16 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
      * ## TABLE `endorsements`
      *
      * ### scope `height`
+     *
+     * Endorsements written before `endorsebits`, no new rows are added. A row is moved to `endorsebits` by
+     * `migrateendt` or by the next endorsement of its block, and dropped by `erase`.
+     *
      * ### params
      *
      * - `{uint64_t} id` - primary key
      * - `{checksum256} hash` - endorsement block hash
      * - `{std::vector<requested_validator_info>} requested_validators` - list of unendorsed validators
-     * - `{std::vector<provider_validator_info>} provider_validators` - list of endorsed validators
+     * - `{std::vector<provider_validator_info>} provider_validators` - list of endorsed validators, in endorsement order
      *
      * ### example
      *
@@ -123,7 +269,7 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
      * }
      * ```
      */
-    struct [[eosio::table]] endorsement_row {
+    struct [[eosio::table]] legacy_endorsement_row {
         uint64_t id;
         checksum256 hash;
         std::vector<requested_validator_info> requested_validators;
@@ -133,18 +279,17 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
 
         uint16_t num_validators() const { return requested_validators.size() + provider_validators.size(); }
 
-        uint64_t num_reached_consensus() const {
-            return xsat::utils::num_reached_consensus(requested_validators.size() + provider_validators.size());
-        }
+        uint64_t num_reached_consensus() const { return xsat::utils::num_reached_consensus(num_validators()); }
 
         bool reached_consensus() const {
             return provider_validators.size() > 0 && provider_validators.size() >= num_reached_consensus();
         }
     };
     typedef eosio::multi_index<
-        "endorsements"_n, endorsement_row,
-        eosio::indexed_by<"byhash"_n, const_mem_fun<endorsement_row, checksum256, &endorsement_row::by_hash>>>
-        endorsement_table;
+        "endorsements"_n, legacy_endorsement_row,
+        eosio::indexed_by<"byhash"_n,
+                          const_mem_fun<legacy_endorsement_row, checksum256, &legacy_endorsement_row::by_hash>>>
+        legacy_endorsement_table;
 
     /**
      * ## ACTION `config`
@@ -195,6 +340,47 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     [[eosio::action]]
     void endorse(const name& validator, const uint64_t height, const checksum256& hash);
 
+    /**
+     * ## STRUCT `endorse_block_info`
+     *
+     * - `{uint64_t} height` - to endorse the height of the block
+     * - `{checksum256} hash` - to endorse the hash of the block
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840000,
+     *   "hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5"
+     * }
+     * ```
+     */
+    struct endorse_block_info {
+        uint64_t height;
+        checksum256 hash;
+    };
+
+    /**
+     * ## ACTION `batchendorse`
+     *
+     * - **authority**: `validator`
+     *
+     * > Endorse multiple blocks at once, the fee is paid once for all blocks and `consensus` is sent in order for every block that reached consensus
+     *
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{std::vector<endorse_block_info>} blocks` - the blocks to endorse
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat batchendorse '["alice", [{"height": 840000, "hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5"}, {"height": 840001, "hash": "00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463"}]]' -p alice
+     * ```
+     */
+    [[eosio::action]]
+    void batchendorse(const name& validator, const std::vector<endorse_block_info>& blocks);
+
     /**
      * ## ACTION `erase`
      *
@@ -215,16 +401,60 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     [[eosio::action]]
     void erase(const uint64_t height);
 
+    /**
+     * ## ACTION `migrateendt`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Move the legacy `endorsements` rows of a height to `endorsebits`
+     *
+     * Every row gets its own `valsets` snapshot with `min_qualification` 0, which is never reused for new endorsements.
+     * The endorsed validators take the first bits in endorsement order, followed by the unendorsed ones. If the block
+     * had reached consensus, the first `num_reached_consensus` endorsers form `consensus_bitmap`, the validators
+     * rwddist.xsat paid consensus rewards to before the upgrade.
+     *
+     * Upgrade order: deploy blkendt.xsat together with utxomng.xsat and rwddist.xsat, then call `migrateendt` for every
+     * height above `irreversible_height` that still has `endorsements` rows. Until then `processblock` stops at the
+     * first such height, because utxomng.xsat only reads `endorsebits`. Endorsing a legacy block migrates it first, and
+     * `erase` drops the legacy rows of heights that become irreversible.
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - the height whose legacy endorsements are migrated
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat migrateendt '[840000]' -p blkendt.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void migrateendt(const uint64_t height);
+
 #ifdef DEBUG
     [[eosio::action]]
     void cleartable(const name table_name, const optional<uint64_t> scope, const optional<uint64_t> max_rows);
+
+    [[eosio::action]]
+    void addlegacyend(const uint64_t height, const checksum256& hash,
+                      const std::vector<provider_validator_info>& provider_validators,
+                      const std::vector<requested_validator_info>& requested_validators);
 #endif
 
     using erase_action = eosio::action_wrapper<"erase"_n, &block_endorse::erase>;
 
    private:
+    template <typename T>
+    bool endorse_block(const name& validator, const uint64_t height, const checksum256& hash, const config_row& config,
+                       const T& chain_state);
+
+    validator_set_row get_validator_set(const uint64_t height, const bool xsat_stake_active,
+                                        const uint64_t min_qualification, const uint64_t irreversible_height);
+    void prune_validator_sets(const uint64_t irreversible_height);
+    void migrate_endorsement(const uint64_t height, const legacy_endorsement_row& legacy, const config_row& config);
     std::vector<requested_validator_info> get_valid_validator_by_btc_stake();
-    std::vector<requested_validator_info> get_valid_validator_by_xsat_stake(const uint64_t min_xsat_qualification);
+    std::vector<requested_validator_info> get_valid_validator_by_xsat_stake();
+    std::vector<requested_validator_info> get_qualified_validators(const name& scope);
 
 #ifdef DEBUG
     template <typename T>
@@ -232,4 +462,5 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
 #endif
    private:
     config_table _config = config_table(_self, _self.value);
+    validator_set_table _validator_set = validator_set_table(_self, _self.value);
 };
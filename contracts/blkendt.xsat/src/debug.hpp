@@ -14,11 +14,35 @@ void block_endorse::cleartable(const name table_name, const optional<uint64_t> s
     const uint64_t value = scope ? *scope : get_self().value;
 
     endorsement_table _endorsement(get_self(), value);
+    legacy_endorsement_table _legacy_endorsement(get_self(), value);
+    validator_member_table _validator_member(get_self(), value);
 
-    if (table_name == "endorsements"_n)
+    if (table_name == "endorsebits"_n)
         clear_table(_endorsement, rows_to_clear);
+    else if (table_name == "endorsements"_n)
+        clear_table(_legacy_endorsement, rows_to_clear);
+    else if (table_name == "valsets"_n)
+        clear_table(_validator_set, rows_to_clear);
+    else if (table_name == "valmembers"_n)
+        clear_table(_validator_member, rows_to_clear);
     else if (table_name == "config"_n)
         _config.remove();
     else
         check(false, "blkendt.xsat::cleartable: [table_name] unknown table to clear");
 }
+
+// writes an `endorsements` row in the layout used before `endorsebits`
+[[eosio::action]]
+void block_endorse::addlegacyend(const uint64_t height, const checksum256& hash,
+                                 const std::vector<provider_validator_info>& provider_validators,
+                                 const std::vector<requested_validator_info>& requested_validators) {
+    require_auth(get_self());
+
+    legacy_endorsement_table _legacy_endorsement(get_self(), height);
+    _legacy_endorsement.emplace(get_self(), [&](auto& row) {
+        row.id = _legacy_endorsement.available_primary_key();
+        row.hash = hash;
+        row.provider_validators = provider_validators;
+        row.requested_validators = requested_validators;
+    });
+}
@@ -7,6 +7,8 @@
 #include <bitcoin/core/pow.hpp>
 #include <cmath>
 #include "../internal/defines.hpp"
+#include "../internal/events.hpp"
+#include "../internal/parsing.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -48,11 +50,11 @@ void block_sync::delchunks(const uint64_t bucket_id) {
     require_auth(UTXO_MANAGE_CONTRACT);
 
     // erase block.chunk
-    auto iter = eosio::internal_use_do_not_use::db_lowerbound_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, 0);
+    auto iter = xsat::profile::db_lowerbound_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, 0);
     while (iter >= 0) {
         uint64_t ignored;
-        auto next_iter = eosio::internal_use_do_not_use::db_next_i64(iter, &ignored);
-        eosio::internal_use_do_not_use::db_remove_i64(iter);
+        auto next_iter = xsat::profile::db_next_i64(iter, &ignored);
+        xsat::profile::db_remove_i64(iter);
         iter = next_iter;
     }
 }
@@ -78,8 +80,8 @@ void block_sync::initbucket(const name& synchronizer, const uint64_t height, con
           "2005:blksync.xsat::initbucket: the block has reached consensus");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, PUSH_CHUNK, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, PUSH_CHUNK, 1);
 
     block_bucket_table _block_bucket = block_bucket_table(get_self(), synchronizer.value);
     auto block_bucket_idx = _block_bucket.get_index<"byblockid"_n>();
@@ -122,8 +124,8 @@ void block_sync::initbucket(const name& synchronizer, const uint64_t height, con
     }
 
     // log
-    block_sync::bucketlog_action _bucketlog(get_self(), {get_self(), "active"_n});
-    _bucketlog.send(bucket_id, synchronizer, height, hash, block_size, num_chunks, chunk_size);
+    xsat::events::emit<block_sync::bucketlog_action>(get_self(), bucket_id, synchronizer, height, hash, block_size,
+                                                     num_chunks, chunk_size);
 }
 
 //@auth synchronizer
@@ -152,20 +154,18 @@ void block_sync::pushchunk(const name& synchronizer, const uint64_t height, cons
         "2013:blksync.xsat::pushchunk: cannot push chunk in the current state [" + get_block_status_name(status) + "]");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, PUSH_CHUNK, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, PUSH_CHUNK, 1);
 
     uint32_t pre_size = 0;
     // emplace/modify chunk
     auto bucket_id = block_bucket_itr->bucket_id;
-    auto chunk_itr
-        = eosio::internal_use_do_not_use::db_find_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, chunk_id);
+    auto chunk_itr = xsat::profile::db_find_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, chunk_id);
     if (chunk_itr >= 0) {
-        pre_size = eosio::internal_use_do_not_use::db_get_i64(chunk_itr, nullptr, 0);
-        eosio::internal_use_do_not_use::db_update_i64(chunk_itr, get_self().value, _ds.pos(), data_size);
+        pre_size = xsat::profile::db_get_i64(chunk_itr, nullptr, 0);
+        xsat::profile::db_update_i64(chunk_itr, get_self().value, _ds.pos(), data_size);
     } else {
-        eosio::internal_use_do_not_use::db_store_i64(bucket_id, BLOCK_CHUNK.value, get_self().value, chunk_id,
-                                                     _ds.pos(), data_size);
+        xsat::profile::db_store_i64(bucket_id, BLOCK_CHUNK.value, get_self().value, chunk_id, _ds.pos(), data_size);
     }
     block_bucket_idx.modify(block_bucket_itr, same_payer, [&](auto& row) {
         if (chunk_itr < 0) {
@@ -187,8 +187,8 @@ void block_sync::pushchunk(const name& synchronizer, const uint64_t height, cons
     });
 
     // log
-    block_sync::chunklog_action _chunklog(get_self(), {get_self(), "active"_n});
-    _chunklog.send(block_bucket_itr->bucket_id, chunk_id, block_bucket_itr->uploaded_num_chunks);
+    xsat::events::emit<block_sync::chunklog_action>(get_self(), block_bucket_itr->bucket_id, chunk_id,
+                                                    block_bucket_itr->uploaded_num_chunks);
 }
 
 //@auth synchronizer
@@ -209,17 +209,16 @@ void block_sync::delchunk(const name& synchronizer, const uint64_t height, const
               + "]");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, PUSH_CHUNK, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, PUSH_CHUNK, 1);
 
     auto bucket_id = block_bucket_itr->bucket_id;
 
-    auto chunk_itr
-        = eosio::internal_use_do_not_use::db_find_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, chunk_id);
+    auto chunk_itr = xsat::profile::db_find_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, chunk_id);
     check(chunk_itr >= 0, "2016:blksync.xsat::delchunk: chunk_id does not exist");
 
-    auto chunk_size = eosio::internal_use_do_not_use::db_get_i64(chunk_itr, nullptr, 0);
-    eosio::internal_use_do_not_use::db_remove_i64(chunk_itr);
+    auto chunk_size = xsat::profile::db_get_i64(chunk_itr, nullptr, 0);
+    xsat::profile::db_remove_i64(chunk_itr);
 
     block_bucket_idx.modify(block_bucket_itr, same_payer, [&](auto& row) {
         row.uploaded_num_chunks -= 1;
@@ -235,8 +234,8 @@ void block_sync::delchunk(const name& synchronizer, const uint64_t height, const
     });
 
     // log
-    block_sync::delchunklog_action _delchunklog(get_self(), {get_self(), "active"_n});
-    _delchunklog.send(bucket_id, chunk_id, block_bucket_itr->uploaded_num_chunks);
+    xsat::events::emit<block_sync::delchunklog_action>(get_self(), bucket_id, chunk_id,
+                                                       block_bucket_itr->uploaded_num_chunks);
 }
 
 //@auth synchronizer
@@ -251,17 +250,17 @@ void block_sync::delbucket(const name& synchronizer, const uint64_t height, cons
         xsat::utils::compute_block_id(height, hash), "2017:blksync.xsat::delbucket: [blockbuckets] does not exists");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, PUSH_CHUNK, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, PUSH_CHUNK, 1);
 
     auto bucket_id = block_bucket_itr->bucket_id;
 
     // erase block.chunk
-    auto iter = eosio::internal_use_do_not_use::db_lowerbound_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, 0);
+    auto iter = xsat::profile::db_lowerbound_i64(get_self().value, bucket_id, BLOCK_CHUNK.value, 0);
     while (iter >= 0) {
         uint64_t ignored;
-        auto next_iter = eosio::internal_use_do_not_use::db_next_i64(iter, &ignored);
-        eosio::internal_use_do_not_use::db_remove_i64(iter);
+        auto next_iter = xsat::profile::db_next_i64(iter, &ignored);
+        xsat::profile::db_remove_i64(iter);
         iter = next_iter;
     }
 
@@ -277,8 +276,7 @@ void block_sync::delbucket(const name& synchronizer, const uint64_t height, cons
     }
 
     // log
-    block_sync::delbucketlog_action _delbucketlog(get_self(), {get_self(), "active"_n});
-    _delbucketlog.send(bucket_id);
+    xsat::events::emit<block_sync::delbucketlog_action>(get_self(), bucket_id);
 }
 
 //@auth synchronizer
@@ -296,8 +294,8 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
                                                  + get_block_status_name(block_bucket_itr->status) + "]");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, VERIFY, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, VERIFY, 1);
     auto status = block_bucket_itr->status;
 
     if (utxo_manage::check_consensus(height, hash)) {
@@ -354,8 +352,8 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
         uint64_t block_id = 0;
         if (block_miner_itr == block_miner_idx.end()) {
             if (miner) {
-                utxo_manage::config_table _config(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-                auto config = _config.get();
+                const auto& config = xsat::cache::get_singleton<utxo_manage::config_table>(
+                    UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
                 expired_block_num = current_block_number() + config.num_miner_priority_blocks;
             }
             block_id = _block_miner.available_primary_key();
@@ -406,8 +404,8 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
         }
 
         if (status == verify_pass) {
-            utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
-            _consensus.send(height, hash);
+            xsat::profile::send<utxo_manage::consensus_action>(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                               hash);
         }
 
         // update block status
@@ -426,8 +424,7 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
     check(block_miner_itr->expired_block_num <= current_block_number(),
           "2022:blksync.xsat::verify: waiting for miners to produce blocks");
 
-    utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
-    _consensus.send(height, hash);
+    xsat::profile::send<utxo_manage::consensus_action>(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n}, height, hash);
 
     block_bucket_idx.modify(block_bucket_itr, same_payer, [&](auto& row) {
         row.status = verify_pass;
@@ -436,45 +433,6 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
     return {.status = get_block_status_name(verify_pass), .block_hash = hash};
 }
 
-optional<string> block_sync::check_transaction(const bitcoin::core::transaction tx) {
-    if (tx.inputs.empty()) {
-        return "bad-txns-vin-empty";
-    }
-
-    if (tx.outputs.empty()) {
-        return "bad-txns-vout-empty";
-    }
-
-    uint64_t value_out = 0;
-    for (const auto& output : tx.outputs) {
-        if (output.value > BTC_SUPPLY) {
-            return "bad-txns-vout-toolarge";
-        }
-        value_out += output.value;
-        if (value_out > BTC_SUPPLY) {
-            return "bad-txns-txouttotal-toolarge";
-        }
-    }
-    auto is_coinbase = tx.is_coinbase();
-    std::set<out_point> vin_out_points;
-    for (const auto& input : tx.inputs) {
-        if (!vin_out_points.insert(out_point{.tx_id = input.previous_output_hash, .index = input.previous_output_index})
-                 .second) {
-            return "bad-txns-inputs-duplicate";
-        }
-        if (is_coinbase) {
-            auto script_size = tx.inputs[0].script_sig.data.size();
-            if (script_size < 2 || script_size > 100) {
-                return "bad-cb-length";
-            }
-        } else {
-            if (input.previous_output_hash == bitcoin::uint256_t(0)) {
-                return "bad-txns-prevout-null";
-            }
-        }
-    }
-}
-
 //@private
 template <typename ITR>
 optional<string> block_sync::check_merkle(const ITR& block_bucket_itr, verify_info_data& verify_info) {
@@ -483,160 +441,15 @@ optional<string> block_sync::check_merkle(const ITR& block_bucket_itr, verify_in
     const auto height = block_bucket_itr->height;
 
     auto block_data = read_bucket(get_self(), bucket_id, BLOCK_CHUNK, verify_info.processed_position, block_size);
-    eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
-
-    auto hash = block_bucket_itr->hash;
-    // verify header
-    if (verify_info.processed_position == 0) {
-        bitcoin::core::block_header block_header;
-        block_stream >> block_header;
-
-        auto block_hash = bitcoin::be_checksum256_from_uint(block_header.hash());
-
-        if (block_hash != hash) {
-            return "hash_mismatch";
-        }
-
-        if (block_header.version_are_invalid(height, CHAIN_PARAMS)) {
-            return "bad-version";
-        }
-
-        if (!block_header.target_is_valid()) {
-            return "invalid_target";
-        }
 
-        verify_info.num_transactions = bitcoin::varint::decode(block_stream);
-        // check transactions size
-        if (verify_info.num_transactions == 0) {
-            return "tx_size_limits";
-        }
-
-        verify_info.previous_block_hash = bitcoin::be_checksum256_from_uint(block_header.previous_block_hash);
-        verify_info.work = bitcoin::be_checksum256_from_uint(block_header.work());
-        verify_info.header_merkle = bitcoin::le_checksum256_from_uint(block_header.merkle);
-        verify_info.timestamp = block_header.timestamp;
-        verify_info.bits = block_header.bits;
-    }
-
-    // deserialization transaction
-    utxo_manage::config_table _config(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-    auto config = _config.get();
-    auto num_txs_per_verification = config.num_txs_per_verification;
-    auto pending_transactions = verify_info.num_transactions - verify_info.processed_transactions;
-    auto rows = num_txs_per_verification;
-    if (rows > pending_transactions) {
-        rows = pending_transactions;
-    }
-    std::vector<bitcoin::core::transaction> transactions;
-    transactions.reserve(rows);
-    for (auto i = 0; i < rows; i++) {
-        // Coinbase needs to obtain witness data
-        bool allow_witness = verify_info.processed_position == 0 && i == 0;
-        bitcoin::core::transaction transaction(&block_data, allow_witness);
-        block_stream >> transaction;
-
-        auto err_msg = check_transaction(transaction);
-        if (err_msg.has_value()) {
-            return err_msg;
-        }
-
-        transactions.emplace_back(std::move(transaction));
-    }
-
-    if (!verify_info.has_witness) {
-        verify_info.has_witness = std::any_of(transactions.cbegin(), transactions.cend(), [](const auto& trx) {
-            return trx.witness.size() > 0;
-        });
-    }
-
-    // check witness ?
-    if (verify_info.processed_position == 0 && transactions.front().inputs.size() > 0) {
-        if (!transactions.front().is_coinbase()) {
-            return "coinbase_missing";
-        }
-        const auto& cbtrx = transactions.front();
-        verify_info.witness_reserve_value = cbtrx.get_witness_reserve_value();
-        if (cbtrx.witness.size() > 0 && !verify_info.witness_reserve_value.has_value()) {
-            return "bad-witness-nonce-size";
-        }
-
-        verify_info.witness_commitment = cbtrx.get_witness_commitment();
-
-        find_miner(cbtrx.outputs, verify_info.miner, verify_info.btc_miners);
-    }
-
-    auto need_witness_check
-        = verify_info.witness_reserve_value.has_value() && verify_info.witness_commitment.has_value();
-
-    // obtain relay merkle
-    bool mutated;
-    bitcoin::uint256_t header_merkle = bitcoin::core::generate_header_merkle(transactions, &mutated);
-    if (mutated) {
-        return "bad_txns_duplicate";
-    }
-
-    bitcoin::uint256_t witness_merkle;
-    if (need_witness_check) {
-        witness_merkle = bitcoin::core::generate_witness_merkle(transactions, /*mutated=*/nullptr);
-    }
-
-    // calculate to the same layer
-    if (verify_info.num_transactions > num_txs_per_verification && rows != num_txs_per_verification) {
-        uint8_t current_layer = static_cast<uint8_t>(std::ceil(std::log2(rows)));
-        vector<bitcoin::uint256_t> cur_hashes;
-        cur_hashes.reserve(2);
-        for (; current_layer < config.num_merkle_layer; current_layer++) {
-            cur_hashes = {header_merkle, header_merkle};
-            header_merkle = bitcoin::generate_merkle_root(cur_hashes);
-            if (need_witness_check) {
-                cur_hashes = {witness_merkle, witness_merkle};
-                witness_merkle = bitcoin::generate_merkle_root(cur_hashes);
-            }
-        }
-    }
-
-    // save sub merkle
-    verify_info.relay_header_merkle.emplace_back(bitcoin::le_checksum256_from_uint(header_merkle));
-    if (need_witness_check) {
-        verify_info.relay_witness_merkle.emplace_back(bitcoin::le_checksum256_from_uint(witness_merkle));
-    }
-
-    // save processed position
-    verify_info.processed_transactions += rows;
-    verify_info.processed_position += block_stream.tellp();
-
-    // check data size
-    if (verify_info.num_transactions == verify_info.processed_transactions
-        && verify_info.processed_position < block_size) {
-        return "data_exceeds";
-    }
-
-    if (verify_info.processed_position == block_size
-        && verify_info.num_transactions > verify_info.processed_transactions) {
-        return "missing_block_data";
-    }
-
-    // verify merkle
-    if (verify_info.num_transactions == verify_info.processed_transactions
-        && verify_info.processed_position == block_size) {
-        // verify header merkle
-        auto header_merkle_root = bitcoin::generate_merkle_root(verify_info.relay_header_merkle);
-        if (header_merkle_root != bitcoin::le_uint_from_checksum256(verify_info.header_merkle)) {
-            return "merkle_invalid";
-        }
-
-        // verify witness merkle
-        if (need_witness_check) {
-            auto witness_merkle_root = bitcoin::core::generate_witness_merkle(verify_info.relay_witness_merkle,
-                                                                              *verify_info.witness_reserve_value);
-            if (witness_merkle_root != bitcoin::le_uint_from_checksum256(*verify_info.witness_commitment)) {
-                return "witness_merkle_invalid";
-            }
-        } else if (verify_info.has_witness) {
-            return "witness_merkle_invalid";
-        }
-    }
-    return std::nullopt;
+    const auto& config
+        = xsat::cache::get_singleton<utxo_manage::config_table>(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    return xsat::parsing::verify_transactions(block_data, block_bucket_itr->hash, height, block_size,
+                                              config.num_txs_per_verification, config.num_merkle_layer, verify_info,
+                                              [&](const bitcoin::core::transaction& coinbase) {
+                                                  find_miner(coinbase.outputs, verify_info.miner,
+                                                             verify_info.btc_miners);
+                                              });
 }
 //@private
 template <typename T, typename ITR>
@@ -45,19 +45,6 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         }
     }
 
-    struct out_point {
-        bitcoin::uint256_t tx_id;
-        uint32_t index;
-
-        friend bool operator<(const out_point &a, const out_point &b) {
-            return std::tie(a.tx_id, a.index) < std::tie(b.tx_id, b.index);
-        }
-
-        friend bool operator==(const out_point &a, const out_point &b) {
-            return (a.tx_id == b.tx_id && a.index == b.index);
-        }
-    };
-
     /**
      * ## TABLE `globalid`
      *
@@ -77,7 +64,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
     struct [[eosio::table]] global_id_row {
         uint64_t bucket_id;
     };
-    typedef eosio::singleton<"globalid"_n, global_id_row> global_id_table;
+    typedef xsat::profile::singleton<"globalid"_n, global_id_row> global_id_table;
 
     /**
      * ## STRUCT `verify_info_data`
@@ -244,7 +231,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         uint64_t by_status() const { return status; }
         checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "blockbuckets"_n, block_bucket_row,
         eosio::indexed_by<"bystatus"_n, const_mem_fun<block_bucket_row, uint64_t, &block_bucket_row::by_status>>,
         eosio::indexed_by<"byblockid"_n, const_mem_fun<block_bucket_row, checksum256, &block_bucket_row::by_block_id>>>
@@ -291,7 +278,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         checksum256 by_hash() const { return hash; }
     };
 
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "passedindexs"_n, passed_index_row,
         eosio::indexed_by<"bybucketid"_n, const_mem_fun<passed_index_row, uint64_t, &passed_index_row::by_bucket_id>>,
         eosio::indexed_by<"byhash"_n, const_mem_fun<passed_index_row, checksum256, &passed_index_row::by_hash>>>
@@ -327,7 +314,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         uint64_t primary_key() const { return id; }
         checksum256 by_hash() const { return hash; }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "blockminer"_n, block_miner_row,
         eosio::indexed_by<"byhash"_n, const_mem_fun<block_miner_row, checksum256, &block_miner_row::by_hash>>>
         block_miner_table;
@@ -351,7 +338,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
     struct [[eosio::table]] block_chunk_row {
         std::vector<char> data;
     };
-    typedef eosio::multi_index<"block.chunk"_n, block_chunk_row> block_chunk_table;
+    typedef xsat::profile::multi_index<"block.chunk"_n, block_chunk_row> block_chunk_table;
 
     /**
      * ## STRUCT `verify_block_result`
@@ -600,10 +587,10 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         std::vector<std::tuple<int32_t, int32_t, int32_t, int32_t>> ranges;
         auto last_position = 0;
         auto total_size = 0;
-        auto iter = eosio::internal_use_do_not_use::db_lowerbound_i64(code.value, bucket_id, table.value, 0);
+        auto iter = xsat::profile::db_lowerbound_i64(code.value, bucket_id, table.value, 0);
 
         while (iter >= 0) {
-            auto size = eosio::internal_use_do_not_use::db_get_i64(iter, nullptr, 0);
+            auto size = xsat::profile::db_get_i64(iter, nullptr, 0);
             auto next_position = last_position + size;
             if (start <= last_position && end >= next_position) {
                 ranges.push_back(make_tuple(iter, size, 0, size));
@@ -621,7 +608,7 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
             }
             last_position += size;
             uint64_t ignored;
-            iter = eosio::internal_use_do_not_use::db_next_i64(iter, &ignored);
+            iter = xsat::profile::db_next_i64(iter, &ignored);
         }
         std::vector<char> result;
         result.resize(total_size);
@@ -630,11 +617,11 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
         for (const auto &[iter, size, from, to] : ranges) {
             auto data_size = to - from;
             if (from == 0) {
-                eosio::internal_use_do_not_use::db_get_i64(iter, result.data() + offset, data_size);
+                xsat::profile::db_get_i64(iter, result.data() + offset, data_size);
             } else {
                 std::vector<char> data;
                 data.resize(size);
-                eosio::internal_use_do_not_use::db_get_i64(iter, data.data(), size);
+                xsat::profile::db_get_i64(iter, data.data(), size);
                 std::copy(data.begin() + from, data.begin() + to, result.begin() + offset);
             }
             offset += data_size;
@@ -646,12 +633,14 @@ class [[eosio::contract("blksync.xsat")]] block_sync : public contract {
     // table init
     global_id_table _global_id = global_id_table(_self, _self.value);
 
+#ifdef PROFILE
+    xsat::profile::recorder _profile = {_self};
+#endif
+
     uint64_t next_bucket_id();
 
     void find_miner(std::vector<bitcoin::core::transaction_output> outputs, name &miner, vector<string> &btc_miners);
 
-    optional<string> check_transaction(const bitcoin::core::transaction tx);
-
     template <typename ITR>
     optional<string> check_merkle(const ITR &block_bucket_itr, verify_info_data &verify_info);
 
@@ -1,4 +1,5 @@
 #include <btc.xsat/btc.xsat.hpp>
+#include "../internal/events.hpp"
 
 void btc::create(const name& issuer, const asset& maximum_supply) {
     require_auth(get_self());
@@ -87,8 +88,37 @@ void btc::transfer(const name& from, const name& to, const asset& quantity, cons
     auto from_balance = sub_balance(from, quantity);
     auto to_balance = add_balance(to, quantity, payer);
 
-    btc::transferlog_action transferlog(get_self(), {get_self(), "active"_n});
-    transferlog.send(from, to, quantity, from_balance, to_balance, memo);
+    xsat::events::emit_inline<btc::transferlog_action>(get_self(), from, to, quantity, from_balance, to_balance, memo);
+}
+
+void btc::transfers(const name& from, const vector<recipient>& recipients) {
+    check(!recipients.empty(), "recipients cannot be empty");
+    require_auth(from);
+    auto sym = recipients[0].quantity.symbol.code();
+    stats statstable(get_self(), sym.raw());
+    const auto& st = statstable.get(sym.raw());
+
+    require_recipient(from);
+
+    // credit each recipient, then debit the sum from `from` once
+    asset quantity = {0, st.supply.symbol};
+    for (const auto& item : recipients) {
+        check(from != item.to, "cannot transfer to self");
+        check(is_account(item.to), "to account does not exist");
+        check(item.quantity.is_valid(), "invalid quantity");
+        check(item.quantity.amount > 0, "must transfer positive quantity");
+        check(item.quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+        check(item.memo.size() <= 256, "memo has more than 256 bytes");
+
+        require_recipient(item.to);
+
+        auto payer = has_auth(item.to) ? item.to : from;
+        add_balance(item.to, item.quantity, payer);
+        quantity += item.quantity;
+    }
+    auto from_balance = sub_balance(from, quantity);
+
+    xsat::events::emit_inline<btc::transferslog_action>(get_self(), from, quantity, from_balance, recipients);
 }
 
 asset btc::sub_balance(const name& owner, const asset& value) {
@@ -3,10 +3,12 @@
 #include <eosio/asset.hpp>
 #include <eosio/eosio.hpp>
 
+#include <algorithm>
 #include <string>
 
 using namespace eosio;
 using std::string;
+using std::vector;
 
 class [[eosio::contract("btc.xsat")]] btc : public contract {
    public:
@@ -82,12 +84,39 @@ class [[eosio::contract("btc.xsat")]] btc : public contract {
     [[eosio::action]]
     void close(const name& owner, const symbol& symbol);
 
+    struct recipient {
+        name to;
+        asset quantity;
+        string memo;
+    };
+
+    /**
+     * Allows `from` account to transfer tokens to several accounts in one action.
+     * `from` is debited once with the sum of all quantities and each recipient is credited with its quantity.
+     * Recipients are notified with `transfers`, not `transfer`: contracts, wallets and indexers that only follow
+     * `transfer` do not see these payments.
+     *
+     * @param from - the account to transfer from,
+     * @param recipients - the accounts to be transferred to, each with its quantity and memo.
+     *
+     * @pre Recipients must not be empty,
+     * @pre All quantities must have the same symbol.
+     */
+    [[eosio::action]]
+    void transfers(const name& from, const vector<recipient>& recipients);
+
     [[eosio::action]]
     void transferlog(const name& from, const name& to, const asset& quantity, const asset& from_balance,
                      const asset& to_balance, const string& memo) {
         require_auth(get_self());
     }
 
+    [[eosio::action]]
+    void transferslog(const name& from, const asset& quantity, const asset& from_balance,
+                      const vector<recipient>& recipients) {
+        require_auth(get_self());
+    }
+
     static asset get_supply(const name& token_contract_account, const symbol_code& sym_code) {
         stats statstable(token_contract_account, sym_code.raw());
         return statstable.get(sym_code.raw(), "invalid supply symbol code").supply;
@@ -108,6 +137,36 @@ class [[eosio::contract("btc.xsat")]] btc : public contract {
         return accountstable.get(sym_code.raw(), "no balance with specified symbol").balance;
     }
 
+    /**
+     * Pays `recipients` from `from` with one `transfer` each, so every recipient is notified as for a single payment.
+     * Recipients listed in `batched` opt into `transfers`: accounts the caller controls that handle `transfers`
+     * notifications are paid together with one `transfers`.
+     *
+     * @param token_contract_account - the token contract,
+     * @param from - the account to transfer from, `active` permission of which is used,
+     * @param recipients - the accounts to be transferred to, each with its quantity and memo,
+     * @param batched - the recipients paid with `transfers`.
+     */
+    static void send_payments(const name& token_contract_account, const name& from, const vector<recipient>& recipients,
+                              const vector<name>& batched = {}) {
+        vector<recipient> batch;
+        for (const auto& item : recipients) {
+            if (std::find(batched.begin(), batched.end(), item.to) != batched.end()) {
+                batch.push_back(item);
+            } else {
+                transfer_action transfer(token_contract_account, {from, "active"_n});
+                transfer.send(from, item.to, item.quantity, item.memo);
+            }
+        }
+        if (batch.size() == 1) {
+            transfer_action transfer(token_contract_account, {from, "active"_n});
+            transfer.send(from, batch[0].to, batch[0].quantity, batch[0].memo);
+        } else if (batch.size() > 1) {
+            transfers_action transfers(token_contract_account, {from, "active"_n});
+            transfers.send(from, batch);
+        }
+    }
+
     using create_action = eosio::action_wrapper<"create"_n, &btc::create>;
     using issue_action = eosio::action_wrapper<"issue"_n, &btc::issue>;
     using retire_action = eosio::action_wrapper<"retire"_n, &btc::retire>;
@@ -115,6 +174,8 @@ class [[eosio::contract("btc.xsat")]] btc : public contract {
     using open_action = eosio::action_wrapper<"open"_n, &btc::open>;
     using close_action = eosio::action_wrapper<"close"_n, &btc::close>;
     using transferlog_action = eosio::action_wrapper<"transferlog"_n, &btc::transferlog>;
+    using transfers_action = eosio::action_wrapper<"transfers"_n, &btc::transfers>;
+    using transferslog_action = eosio::action_wrapper<"transferslog"_n, &btc::transferslog>;
 
     struct [[eosio::table]] account {
         asset balance;
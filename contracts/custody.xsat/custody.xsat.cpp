@@ -1,4 +1,5 @@
 #include <custody.xsat/custody.xsat.hpp>
+#include <utxomng.xsat/utxomng.xsat.hpp>
 
 #ifdef DEBUG
 #include <bitcoin/script/address.hpp>
@@ -59,6 +60,10 @@ void custody::delcustody(const checksum160 staker) {
         endorse_manage::creditstake_action creditstake(ENDORSER_MANAGE_CONTRACT, { get_self(), "active"_n });
         creditstake.send(staker_itr->proxy, staker_itr->staker, staker_itr->validator, asset(0, BTC_SYMBOL));
     }
+    auto balance_itr = _balance.find(staker_itr->id);
+    if (balance_itr != _balance.end()) {
+        _balance.erase(balance_itr);
+    }
     staker_idx.erase(staker_itr);
 }
 
@@ -69,9 +74,69 @@ void custody::creditstake(const checksum160& staker, const uint64_t balance) {
     auto staker_id = xsat::utils::compute_id(staker);
     auto staker_idx = _custody.get_index<"bystaker"_n>();
     auto staker_itr = staker_idx.require_find(staker_id, "custody.xsat::creditstake: staker does not exists");
+    save_balance(staker_itr->id, balance, get_irreversible_height(), false);
     handle_staking(staker_itr, balance);
 }
 
+[[eosio::action]]
+void custody::creditstakes(const vector<staker_balance>& balances) {
+    require_auth(get_self());
+    check(balances.size() > 0, "custody.xsat::creditstakes: balances cannot be empty");
+
+    const uint64_t seed_height = get_irreversible_height();
+    auto staker_idx = _custody.get_index<"bystaker"_n>();
+    vector<endorse_manage::credit_stake_row> stakes;
+    stakes.reserve(balances.size());
+    for (const auto& item : balances) {
+        auto staker_itr = staker_idx.find(xsat::utils::compute_id(item.staker));
+        if (staker_itr == staker_idx.end()) continue;
+
+        const bool stake_pending = !collect_staking(staker_idx, staker_itr, item.balance, stakes);
+        save_balance(staker_itr->id, item.balance, seed_height, stake_pending);
+    }
+    send_credit_stakes(stakes);
+}
+
+[[eosio::action]]
+void custody::syncbalances(const uint64_t height, const vector<balance_delta>& deltas) {
+    require_auth(UTXO_MANAGE_CONTRACT);
+
+    vector<endorse_manage::credit_stake_row> stakes;
+    for (const auto& delta : deltas) {
+        auto custody_itr = _custody.find(delta.id);
+        if (custody_itr == _custody.end()) continue;
+
+        // the balance is only derived once `creditstake` or `creditstakes` has seeded it
+        auto balance_itr = _balance.find(delta.id);
+        if (balance_itr == _balance.end()) continue;
+
+        // the seeded balance already includes this block
+        if (height <= balance_itr->seed_height) continue;
+
+        uint64_t balance = balance_itr->balance;
+        uint64_t drift = balance_itr->drift;
+        // spends an output the balance does not hold, the balance is no longer reliable
+        if (delta.value < 0 && balance < static_cast<uint64_t>(-delta.value)) {
+            drift += static_cast<uint64_t>(-delta.value) - balance;
+            balance = 0;
+        } else {
+            balance += delta.value;
+        }
+
+        // the credit stake of a drifted balance is kept until it is seeded again
+        bool stake_pending = false;
+        if (drift == 0) {
+            stake_pending = !collect_staking(_custody, custody_itr, balance, stakes);
+        }
+        _balance.modify(balance_itr, same_payer, [&](auto& row) {
+            row.balance = balance;
+            row.drift = drift;
+            row.stake_pending = stake_pending;
+        });
+    }
+    send_credit_stakes(stakes);
+}
+
 template <typename T>
 uint64_t custody::get_current_staking_value(T& itr) {
     endorse_manage::evm_staker_table _staking(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
@@ -97,6 +162,71 @@ void custody::handle_staking(T& itr, uint64_t balance) {
     });
 }
 
+template <typename T>
+bool custody::can_credit_stake(T& itr) {
+    endorse_manage::credit_proxy_table _proxy(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    auto proxy_idx = _proxy.get_index<"byproxy"_n>();
+    if (proxy_idx.find(xsat::utils::compute_id(itr->proxy)) == proxy_idx.end()) return false;
+
+    endorse_manage::validator_table _validator(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    auto validator_itr = _validator.find(itr->validator.value);
+    return validator_itr != _validator.end() && !validator_itr->disabled_staking;
+}
+
+// stakers whose stake in endrmng.xsat does not change are skipped, a drifted `value` is realigned without a stake.
+// A stake endrmng.xsat would reject is not collected and false is returned, so one staker cannot fail the batch.
+template <typename T, typename C>
+bool custody::collect_staking(T& _table, C& itr, const uint64_t balance, vector<endorse_manage::credit_stake_row>& stakes) {
+    uint64_t current_staking_value = get_current_staking_value(itr);
+    uint64_t new_staking_value = balance >= MAX_STAKING ? MAX_STAKING : 0;
+    bool changed = new_staking_value != current_staking_value;
+    if (!changed && new_staking_value == itr->value) return true;
+    if (changed && !can_credit_stake(itr)) return false;
+
+    if (changed) {
+        stakes.push_back({itr->proxy, itr->staker, itr->validator, asset(new_staking_value, BTC_SYMBOL)});
+    }
+    _table.modify(itr, same_payer, [&](auto& row) {
+        row.value = new_staking_value;
+        if (changed) {
+            row.latest_stake_time = eosio::current_time_point();
+        }
+    });
+    return true;
+}
+
+void custody::send_credit_stakes(const vector<endorse_manage::credit_stake_row>& stakes) {
+    if (stakes.empty()) return;
+
+    endorse_manage::creditstakes_action creditstakes(ENDORSER_MANAGE_CONTRACT, { get_self(), "active"_n });
+    creditstakes.send(stakes);
+}
+
+uint64_t custody::get_irreversible_height() {
+    utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    return _chain_state.get_or_default().irreversible_height;
+}
+
+void custody::save_balance(const uint64_t id, const uint64_t balance, const uint64_t seed_height, const bool stake_pending) {
+    auto balance_itr = _balance.find(id);
+    if (balance_itr == _balance.end()) {
+        _balance.emplace(get_self(), [&](auto& row) {
+            row.id = id;
+            row.balance = balance;
+            row.seed_height = seed_height;
+            row.drift = 0;
+            row.stake_pending = stake_pending;
+        });
+    } else {
+        _balance.modify(balance_itr, same_payer, [&](auto& row) {
+            row.balance = balance;
+            row.seed_height = seed_height;
+            row.drift = 0;
+            row.stake_pending = stake_pending;
+        });
+    }
+}
+
 uint64_t custody::next_custody_id() {
     global_row global = _global.get_or_default();
     global.custody_id++;
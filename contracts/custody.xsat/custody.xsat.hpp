@@ -22,6 +22,93 @@ public:
 
     static const uint64_t MAX_STAKING = 10000000000; // 100 BTC in satoshi
 
+    /**
+     * ## TABLE `custodies`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - the custody id
+     * - `{checksum160} staker` - the staker evm address
+     * - `{checksum160} proxy` - the proxy evm address
+     * - `{name} validator` - the validator account
+     * - `{string} btc_address` - the bitcoin address
+     * - `{vector<uint8_t>} scriptpubkey` - the scriptpubkey
+     * - `{uint64_t} value` - the total utxo value
+     * - `{time_point_sec} latest_stake_time` - the latest stake time
+     *
+     * ### example
+     *
+     * ```
+     * {
+     *   "id": 7,
+     *   "staker": "ee37064f01ec9314278f4984ff4b9b695eb91912",
+     *   "proxy": "0000000000000000000000000000000000000001",
+     *   "validator": "val1.xsat",
+     *   "btc_address": "3LB8ocwXtqgq7sDfiwv3EbDZNEPwKLQcsN",
+     *   "scriptpubkey": "a914cac3a79a829c31b07e6a8450c4e05c4289ab95b887"
+     *   "value": 100000000,
+     *   "latest_stake_time": "2021-09-01T00:00:00"
+     * }
+     * ```
+     *
+     */
+    struct [[eosio::table]] custody_row {
+        uint64_t id;
+        checksum160 staker;
+        checksum160 proxy;
+        name validator;
+        string btc_address;
+        std::vector<uint8_t> scriptpubkey;
+        uint64_t value;
+        time_point_sec latest_stake_time;
+        uint64_t primary_key() const { return id; }
+        checksum256 by_staker() const { return xsat::utils::compute_id(staker); }
+        checksum256 by_scriptpubkey() const { return xsat::utils::hash(scriptpubkey); }
+    };
+    typedef eosio::multi_index<"custodies"_n, custody_row,
+        eosio::indexed_by<"bystaker"_n, const_mem_fun<custody_row, checksum256, &custody_row::by_staker>>,
+        eosio::indexed_by<"scriptpubkey"_n, const_mem_fun<custody_row, checksum256, &custody_row::by_scriptpubkey>>>
+        custody_index;
+
+    /**
+     * ## TABLE `balances`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - the custody id
+     * - `{uint64_t} balance` - the btc balance of the custody address, seeded by `creditstake` and kept up to date by
+     * `utxomng.xsat` while it watches custody addresses
+     * - `{uint64_t} seed_height` - the `utxomng.xsat` irreversible height when the balance was seeded, the seeded
+     * balance already includes the blocks up to this height
+     * - `{uint64_t} drift` - btc spent by the custody address that the balance did not hold, the credit stake is not
+     * updated until the balance is seeded again
+     * - `{bool} stake_pending` - the credit stake of the balance was not applied because `endrmng.xsat` would reject it,
+     * e.g. the validator disabled staking or the proxy was removed, it is retried with the next balance change
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 7,
+     *   "balance": 10000000000,
+     *   "seed_height": 840000,
+     *   "drift": 0,
+     *   "stake_pending": false
+     * }
+     * ```
+     */
+    struct [[eosio::table]] balance_row {
+        uint64_t id;
+        uint64_t balance;
+        uint64_t seed_height;
+        uint64_t drift;
+        bool stake_pending;
+        uint64_t primary_key() const { return id; }
+    };
+    typedef eosio::multi_index<"balances"_n, balance_row> balance_table;
+
     /**
      * ## ACTION `addcustody`
      *
@@ -71,7 +158,7 @@ public:
      *
      * - **authority**: `get_self()`
      *
-     * > Sync staker btc address stake off chain
+     * > Sync staker btc address stake off chain. `balance` seeds the balance at the `utxomng.xsat` irreversible height.
      *
      * ### params
      *
@@ -87,6 +174,100 @@ public:
     [[eosio::action]]
     void creditstake(const checksum160& staker, const uint64_t balance);
 
+    /**
+     * ## STRUCT `staker_balance`
+     *
+     * ### params
+     *
+     * - `{checksum160} staker` - staker evm address
+     * - `{uint64_t} balance` - staker btc balance
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "staker": "1231deb6f5749ef6ce6943a275a1d3e7486f4eae",
+     *   "balance": 10000000000
+     * }
+     * ```
+     */
+    struct staker_balance {
+        checksum160 staker;
+        uint64_t balance;
+    };
+
+    /**
+     * ## ACTION `creditstakes`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Sync the off chain stake of several staker btc addresses with a single `endrmng.xsat::creditstakes` call.
+     * > Unknown stakers and stakers whose stake in `endrmng.xsat` does not change are skipped. Each balance seeds the
+     * > balance at the `utxomng.xsat` irreversible height. A stake `endrmng.xsat` would reject is skipped and flagged
+     * > as `stake_pending`.
+     *
+     * ### params
+     *
+     * - `{vector<staker_balance>} balances` - staker btc balances
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action custody.xsat creditstakes '[[{"staker": "1231deb6f5749ef6ce6943a275a1d3e7486f4eae", "balance": 10000000000}]]' -p custody.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void creditstakes(const vector<staker_balance>& balances);
+
+    /**
+     * ## STRUCT `balance_delta`
+     *
+     * ### params
+     *
+     * - `{uint64_t} id` - the custody id
+     * - `{int64_t} value` - net btc value received (positive) or spent (negative) by the custody address
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 7,
+     *   "value": -100000000
+     * }
+     * ```
+     */
+    struct balance_delta {
+        uint64_t id;
+        int64_t value;
+    };
+
+    /**
+     * ## ACTION `syncbalances`
+     *
+     * - **authority**: `utxomng.xsat`
+     *
+     * > Apply the balance changes of custody addresses seen while migrating the UTXO set, and update the credit stake
+     * > of every staker that crosses `MAX_STAKING`. Custodies without a seeded balance and changes of blocks at or below
+     * > the `seed_height` of a balance are ignored. A spend larger than the balance is recorded as `drift`. A stake
+     * > `endrmng.xsat` would reject is flagged as `stake_pending` instead, so the migration of `utxomng.xsat` never
+     * > fails on it.
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - the height of the migrated block
+     * - `{vector<balance_delta>} deltas` - balance changes of custody addresses
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action custody.xsat syncbalances '[840001, [{"id": 7, "value": -100000000}]]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void syncbalances(const uint64_t height, const vector<balance_delta>& deltas);
+
+    using syncbalances_action = eosio::action_wrapper<"syncbalances"_n, &custody::syncbalances>;
+
 #ifdef DEBUG
     [[eosio::action]]
     void cleartable(const name table_name, const optional<name> scope, const optional<uint64_t> max_rows);
@@ -119,57 +300,9 @@ private:
     typedef singleton<"globals"_n, global_row> global_table;
     global_table _global = global_table(_self, _self.value);
 
-    /**
-     * ## TABLE `custodies`
-     *
-     * ### scope `get_self()`
-     * ### params
-     *
-     * - `{uint64_t} id` - the custody id
-     * - `{checksum160} staker` - the staker evm address
-     * - `{checksum160} proxy` - the proxy evm address
-     * - `{name} validator` - the validator account
-     * - `{string} btc_address` - the bitcoin address
-     * - `{vector<uint8_t>} scriptpubkey` - the scriptpubkey
-     * - `{uint64_t} value` - the total utxo value
-     * - `{time_point_sec} latest_stake_time` - the latest stake time
-     *
-     * ### example
-     *
-     * ```
-     * {
-     *   "id": 7,
-     *   "staker": "ee37064f01ec9314278f4984ff4b9b695eb91912",
-     *   "proxy": "0000000000000000000000000000000000000001",
-     *   "validator": "val1.xsat",
-     *   "btc_address": "3LB8ocwXtqgq7sDfiwv3EbDZNEPwKLQcsN",
-     *   "scriptpubkey": "a914cac3a79a829c31b07e6a8450c4e05c4289ab95b887"
-     *   "value": 100000000,
-     *   "latest_stake_time": "2021-09-01T00:00:00"
-     * }
-     * ```
-     *
-     */
-    struct [[eosio::table]] custody_row {
-        uint64_t id;
-        checksum160 staker;
-        checksum160 proxy;
-        name validator;
-        string btc_address;
-        std::vector<uint8_t> scriptpubkey;
-        uint64_t value;
-        time_point_sec latest_stake_time;
-        uint64_t primary_key() const { return id; }
-        checksum256 by_staker() const { return xsat::utils::compute_id(staker); }
-        checksum256 by_scriptpubkey() const { return xsat::utils::hash(scriptpubkey); }
-    };
-    typedef eosio::multi_index<"custodies"_n, custody_row,
-        eosio::indexed_by<"bystaker"_n, const_mem_fun<custody_row, checksum256, &custody_row::by_staker>>,
-        eosio::indexed_by<"scriptpubkey"_n, const_mem_fun<custody_row, checksum256, &custody_row::by_scriptpubkey>>>
-        custody_index;
-
     // table init
     custody_index _custody = custody_index(_self, _self.value);
+    balance_table _balance = balance_table(_self, _self.value);
 
     template <typename T>
     uint64_t get_current_staking_value(T& itr);
@@ -177,6 +310,18 @@ private:
     template <typename T>
     void handle_staking(T& itr, uint64_t balance);
 
+    template <typename T>
+    bool can_credit_stake(T& itr);
+
+    template <typename T, typename C>
+    bool collect_staking(T& _table, C& itr, const uint64_t balance, vector<endorse_manage::credit_stake_row>& stakes);
+
+    void send_credit_stakes(const vector<endorse_manage::credit_stake_row>& stakes);
+
+    uint64_t get_irreversible_height();
+
+    void save_balance(const uint64_t id, const uint64_t balance, const uint64_t seed_height, const bool stake_pending);
+
     uint64_t next_custody_id();
 
 #ifdef DEBUG
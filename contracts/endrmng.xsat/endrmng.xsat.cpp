@@ -1,6 +1,8 @@
 #include <endrmng.xsat/endrmng.xsat.hpp>
 #include <btc.xsat/btc.xsat.hpp>
+#include <blkendt.xsat/blkendt.xsat.hpp>
 #include "../internal/safemath.hpp"
+#include "../internal/events.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -33,7 +35,8 @@ void endorse_manage::setdonateacc(const string& donation_account, const uint16_t
 void endorse_manage::addwhitelist(const name& type, const name& account) {
     require_auth(get_self());
 
-    check(WHITELIST_TYPES.find(type) != WHITELIST_TYPES.end(), "endrmng.xsat::addwhitelist: type invalid");
+    check(std::find(WHITELIST_TYPES.begin(), WHITELIST_TYPES.end(), type) != WHITELIST_TYPES.end(),
+          "endrmng.xsat::addwhitelist: type invalid");
     check(is_account(account), "endrmng.xsat::addwhitelist: account does not exist");
 
     whitelist_table _whitelist(get_self(), type.value);
@@ -51,7 +54,8 @@ void endorse_manage::delwhitelist(const name& type, const name& account) {
     require_auth(get_self());
 
     // check
-    check(WHITELIST_TYPES.find(type) != WHITELIST_TYPES.end(), "endrmng.xsat::delwhitelist: [type] is invalid");
+    check(std::find(WHITELIST_TYPES.begin(), WHITELIST_TYPES.end(), type) != WHITELIST_TYPES.end(),
+          "endrmng.xsat::delwhitelist: [type] is invalid");
 
     // erase whitelist
     whitelist_table _whitelist(get_self(), type.value);
@@ -152,8 +156,8 @@ void endorse_manage::register_validator(const name& proxy, const name& validator
         row.staking_reward_balance = asset{0, XSAT_SYMBOL};
     });
     // log
-    endorse_manage::validatorlog_action _validatorlog(get_self(), {get_self(), "active"_n});
-    _validatorlog.send(proxy, validator, financial_account, commission_rate);
+    xsat::events::emit<endorse_manage::validatorlog_action>(get_self(), proxy, validator, financial_account,
+                                                            commission_rate);
 }
 
 //@auth validator
@@ -167,6 +171,10 @@ void endorse_manage::config(const name& validator, const optional<uint16_t>& com
           "endrmng.xsat::config: commission_rate must be less than or equal to " + std::to_string(RATE_BASE_10000));
 
     auto validator_itr = _validator.require_find(validator.value, "endrmng.xsat::config: [validators] does not exists");
+    if (commission_rate.has_value()) {
+        // pending rewards are split with the commission rate they were earned under
+        settle_validator_reward(validator_itr);
+    }
     _validator.modify(validator_itr, same_payer, [&](auto& row) {
         if (commission_rate.has_value()) {
             row.commission_rate = *commission_rate;
@@ -187,11 +195,12 @@ void endorse_manage::config(const name& validator, const optional<uint16_t>& com
     });
 
     // log
-    endorse_manage::configlog_action _configlog(get_self(), {get_self(), "active"_n});
     if (validator_itr->reward_recipient == ERC20_CONTRACT) {
-        _configlog.send(validator, validator_itr->commission_rate, validator_itr->memo);
+        xsat::events::emit<endorse_manage::configlog_action>(get_self(), validator, validator_itr->commission_rate,
+                                                             validator_itr->memo);
     } else {
-        _configlog.send(validator, validator_itr->commission_rate, validator_itr->reward_recipient.to_string());
+        xsat::events::emit<endorse_manage::configlog_action>(get_self(), validator, validator_itr->commission_rate,
+                                                             validator_itr->reward_recipient.to_string());
     }
 }
 
@@ -211,8 +220,7 @@ void endorse_manage::setdonate(const name& validator, const uint16_t donate_rate
     });
 
     // log
-    endorse_manage::setdonatelog_action _setdonatelog(get_self(), {get_self(), "active"_n});
-    _setdonatelog.send(validator, donate_rate);
+    xsat::events::emit<endorse_manage::setdonatelog_action>(get_self(), validator, donate_rate);
 }
 
 //@auth get_self()
@@ -227,6 +235,58 @@ void endorse_manage::setstatus(const name& validator, const bool disabled_stakin
     });
 }
 
+//@auth blkendt.xsat
+[[eosio::action]]
+void endorse_manage::setxsatqual(const asset& min_xsat_qualification) {
+    require_auth(BLOCK_ENDORSE_CONTRACT);
+    check(min_xsat_qualification.symbol == XSAT_SYMBOL,
+          "endrmng.xsat::setxsatqual: min_xsat_qualification symbol must be XSAT");
+
+    set_xsat_qualification(min_xsat_qualification);
+}
+
+void endorse_manage::set_xsat_qualification(const asset& min_xsat_qualification) {
+    auto qualified_stat = _qualified_stat.get_or_default();
+    const uint64_t old_amount = qualified_stat.min_xsat_qualification.amount;
+    const uint64_t new_amount = min_xsat_qualification.amount;
+    if (old_amount == new_amount) {
+        return;
+    }
+    qualified_stat.min_xsat_qualification = min_xsat_qualification;
+    _qualified_stat.set(qualified_stat, get_self());
+
+    // Only validators whose XSAT stake lies between the old and new threshold change qualification,
+    // a zero threshold means the xsat scope was empty
+    const uint64_t lower = old_amount == 0 ? new_amount : std::min(old_amount, new_amount);
+    const uint64_t upper = old_amount == 0 ? std::numeric_limits<uint64_t>::max() : std::max(old_amount, new_amount);
+    auto validator_idx = _validator.get_index<"bystakedxsat"_n>();
+    auto validator_itr = validator_idx.lower_bound(lower);
+    while (validator_itr != validator_idx.end() && validator_itr->by_xsat_total_staking() < upper) {
+        update_qualified(*validator_itr);
+        validator_itr++;
+    }
+}
+
+//@auth get_self()
+[[eosio::action]]
+void endorse_manage::syncqualify(const name& validator, uint64_t rows) {
+    require_auth(get_self());
+
+    // the threshold stays 0 until `blkendt.xsat::config` is pushed again, seed it from the deployed config
+    block_endorse::config_table _block_endorse_config(BLOCK_ENDORSE_CONTRACT, BLOCK_ENDORSE_CONTRACT.value);
+    const auto block_endorse_config = _block_endorse_config.get_or_default();
+    if (block_endorse_config.min_xsat_qualification.symbol == XSAT_SYMBOL) {
+        set_xsat_qualification(block_endorse_config.min_xsat_qualification);
+    }
+
+    if (rows == 0) rows = -1;
+    auto validator_itr = _validator.lower_bound(validator.value);
+    while (validator_itr != _validator.end() && rows--) {
+        update_qualified(*validator_itr);
+        validator_itr++;
+    }
+}
+
 //==============================================================  staking btc =========================================================
 
 //@auth staking.xsat
@@ -238,8 +298,8 @@ void endorse_manage::stake(const name& staker, const name& validator, const asse
     std::tie(validator_staking, validator_qualification) = stake_without_auth(staker, validator, quantity, quantity);
 
     // log
-    endorse_manage::stakelog_action _stakelog(get_self(), {get_self(), "active"_n});
-    _stakelog.send(staker, validator, quantity, validator_staking, validator_qualification);
+    xsat::events::emit<endorse_manage::stakelog_action>(get_self(), staker, validator, quantity, validator_staking,
+                                                        validator_qualification);
 }
 
 //@auth staking.xsat
@@ -251,8 +311,8 @@ void endorse_manage::unstake(const name& staker, const name& validator, const as
     std::tie(validator_staking, validator_qualification) = unstake_without_auth(staker, validator, quantity, quantity);
 
     // log
-    endorse_manage::unstakelog_action _unstakelog(get_self(), {get_self(), "active"_n});
-    _unstakelog.send(staker, validator, quantity, validator_staking, validator_qualification);
+    xsat::events::emit<endorse_manage::unstakelog_action>(get_self(), staker, validator, quantity, validator_staking,
+                                                          validator_qualification);
 }
 
 //@auth staker
@@ -269,9 +329,9 @@ void endorse_manage::newstake(const name& staker, const name& old_validator, con
         = stake_without_auth(staker, new_validator, quantity, quantity);
 
     // log
-    endorse_manage::newstakelog_action _newstakelog(get_self(), {get_self(), "active"_n});
-    _newstakelog.send(staker, old_validator, new_validator, quantity, old_validator_staking,
-                      old_validator_qualification, new_validator_staking, new_validator_qualification);
+    xsat::events::emit<endorse_manage::newstakelog_action>(get_self(), staker, old_validator, new_validator, quantity,
+                                                           old_validator_staking, old_validator_qualification,
+                                                           new_validator_staking, new_validator_qualification);
 }
 
 //@auth staker
@@ -286,50 +346,63 @@ void endorse_manage::claim(const name& staker, const name& validator, const uint
     auto native_staker_itr = native_staker_idx.require_find(compute_staking_id(staker, validator),
                                                             "endrmng.xsat::claim: [stakers] does not exists");
 
-    auto validator_itr = _validator.require_find(native_staker_itr->validator.value,
-                                                 "endrmng.xsat::claim: [validators] does not exists");
-    // update reward
-    update_staking_reward(validator_itr->stake_acc_per_share, validator_itr->consensus_acc_per_share,
-                          native_staker_itr->quantity.amount, native_staker_itr->quantity.amount, native_staker_idx,
-                          native_staker_itr);
-
-    auto staking_reward_unclaimed = native_staker_itr->staking_reward_unclaimed;
-    auto consensus_reward_unclaimed = native_staker_itr->consensus_reward_unclaimed;
-    auto claimable = staking_reward_unclaimed + consensus_reward_unclaimed;
+    asset claimable, donated_amount;
+    std::tie(claimable, donated_amount) = claim_staking_reward(native_staker_idx, native_staker_itr, donate_rate);
     check(claimable.amount > 0, "endrmng.xsat::claim: no balance to claim");
 
-    asset donated_amount = claimable * donate_rate / RATE_BASE_10000;
-    asset to_staker = claimable - donated_amount;
+    vector<btc::recipient> recipients;
+    donate(donated_amount, recipients);
 
-    native_staker_idx.modify(native_staker_itr, same_payer, [&](auto& row) {
-        row.total_donated += donated_amount;
-        row.staking_reward_claimed += staking_reward_unclaimed;
-        row.consensus_reward_claimed += consensus_reward_unclaimed;
-        row.staking_reward_unclaimed -= staking_reward_unclaimed;
-        row.consensus_reward_unclaimed -= consensus_reward_unclaimed;
-    });
-
-    _validator.modify(validator_itr, same_payer, [&](auto& row) {
-        row.staking_reward_balance -= staking_reward_unclaimed;
-        row.consensus_reward_balance -= consensus_reward_unclaimed;
-    });
+    asset to_staker = claimable - donated_amount;
+    if (to_staker.amount > 0) {
+        recipients.push_back({staker, to_staker, "claim reward"});
+    }
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
+}
 
-    // transfer donate
-    if (donated_amount.amount > 0) {
-        auto config = _config.get();
-        token_transfer(get_self(), config.donation_account, extended_asset{donated_amount, EXSAT_CONTRACT});
+//@auth staker
+[[eosio::action]]
+void endorse_manage::batchclaim(const name& staker, const vector<name>& validators, const uint16_t donate_rate) {
+    require_auth(staker);
 
-        auto stat = _stat.get_or_default();
-        stat.xsat_total_donated += donated_amount;
-        _stat.set(stat, get_self());
+    check(donate_rate <= RATE_BASE_10000,
+          "endrmng.xsat::batchclaim: donate_rate must be less than or equal to " + std::to_string(RATE_BASE_10000));
+
+    asset claimable = {0, XSAT_SYMBOL};
+    asset donated_amount = {0, XSAT_SYMBOL};
+    asset position_claimable, position_donated_amount;
+    if (validators.empty()) {
+        // all positions of the staker
+        auto native_staker_idx = _native_stake.get_index<"bystaker"_n>();
+        auto native_staker_itr = native_staker_idx.lower_bound(staker.value);
+        for (; native_staker_itr != native_staker_idx.end() && native_staker_itr->staker == staker;
+             native_staker_itr++) {
+            std::tie(position_claimable, position_donated_amount)
+                = claim_staking_reward(native_staker_idx, native_staker_itr, donate_rate);
+            claimable += position_claimable;
+            donated_amount += position_donated_amount;
+        }
+    } else {
+        auto native_staker_idx = _native_stake.get_index<"bystakingid"_n>();
+        for (const auto& validator : validators) {
+            auto native_staker_itr = native_staker_idx.require_find(
+                compute_staking_id(staker, validator), "endrmng.xsat::batchclaim: [stakers] does not exists");
+            std::tie(position_claimable, position_donated_amount)
+                = claim_staking_reward(native_staker_idx, native_staker_itr, donate_rate);
+            claimable += position_claimable;
+            donated_amount += position_donated_amount;
+        }
     }
+    check(claimable.amount > 0, "endrmng.xsat::batchclaim: no balance to claim");
 
+    vector<btc::recipient> recipients;
+    donate(donated_amount, recipients);
+
+    asset to_staker = claimable - donated_amount;
     if (to_staker.amount > 0) {
-        token_transfer(get_self(), native_staker_itr->staker, {to_staker, EXSAT_CONTRACT}, "claim reward");
+        recipients.push_back({staker, to_staker, "claim reward"});
     }
-
-    endorse_manage::claimlog_action _claimlog(get_self(), {get_self(), "active"_n});
-    _claimlog.send(staker, validator, claimable, donated_amount, native_staker_itr->total_donated);
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -347,8 +420,8 @@ void endorse_manage::evmstake(const name& caller, const checksum160& proxy, cons
         = evm_stake_without_auth(proxy, staker, validator, quantity, quantity);
 
     // log
-    endorse_manage::evmstakelog_action _evmstakelog(get_self(), {get_self(), "active"_n});
-    _evmstakelog.send(proxy, staker, validator, quantity, validator_staking, validator_qualification);
+    xsat::events::emit_inline<endorse_manage::evmstakelog_action>(get_self(), proxy, staker, validator, quantity,
+                                                                  validator_staking, validator_qualification);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -367,8 +440,8 @@ void endorse_manage::evmunstake(const name& caller, const checksum160& proxy, co
         = evm_unstake_without_auth(proxy, staker, validator, quantity, quantity);
 
     // log
-    endorse_manage::evmunstlog_action _evmunstlog(get_self(), {get_self(), "active"_n});
-    _evmunstlog.send(proxy, staker, validator, quantity, validator_staking, validator_qualification);
+    xsat::events::emit_inline<endorse_manage::evmunstlog_action>(get_self(), proxy, staker, validator, quantity,
+                                                                 validator_staking, validator_qualification);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -393,9 +466,9 @@ void endorse_manage::evmnewstake(const name& caller, const checksum160& proxy, c
         = evm_stake_without_auth(proxy, staker, new_validator, quantity, quantity);
 
     // log
-    endorse_manage::evmnewstlog_action _evmnewstlog(get_self(), {get_self(), "active"_n});
-    _evmnewstlog.send(proxy, staker, old_validator, new_validator, quantity, old_validator_staking,
-                      old_validator_qualification, new_validator_staking, new_validator_qualification);
+    xsat::events::emit<endorse_manage::evmnewstlog_action>(get_self(), proxy, staker, old_validator, new_validator,
+                                                           quantity, old_validator_staking, old_validator_qualification,
+                                                           new_validator_staking, new_validator_qualification);
 }
 
 // @auth scope is `evmcaller` whitelist account
@@ -426,34 +499,143 @@ void endorse_manage::evm_claim(const name& caller, const checksum160& proxy, con
     auto evm_staker_itr = evm_staker_idx.require_find(compute_staking_id(proxy, staker, validator),
                                                       "endrmng.xsat::evmclaim: [evmstakers] does not exists");
 
+    asset claimable, donated_amount;
+    std::tie(claimable, donated_amount)
+        = claim_staking_reward(evm_staker_idx, evm_staker_itr, is_credit_proxy(proxy), donate_rate);
+    check(claimable.amount > 0, "endrmng.xsat::evmclaim: no balance to claim");
+
+    vector<btc::recipient> recipients;
+    donate(donated_amount, recipients);
+
+    auto to_staker = claimable - donated_amount;
+    if (to_staker.amount > 0) {
+        recipients.push_back({ERC20_CONTRACT, to_staker, "0x" + xsat::utils::sha1_to_hex(evm_staker_itr->staker)});
+    }
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
+}
+
+// @auth scope is `evmcaller` whitelist account
+[[eosio::action]]
+void endorse_manage::evmbtchclaim(const name& caller, const checksum160& proxy, const checksum160& staker,
+                                  const vector<name>& validators, const uint16_t donate_rate) {
+    require_auth(caller);
+
+    check(donate_rate <= RATE_BASE_10000,
+          "endrmng.xsat::evmbtchclaim: donate_rate must be less than or equal to " + std::to_string(RATE_BASE_10000));
+
+    whitelist_table _whitelist(get_self(), "evmcaller"_n.value);
+    _whitelist.require_find(caller.value, "endrmng.xsat::evmbtchclaim: caller is not in the `evmcaller` whitelist");
+
+    const bool is_credit_staking = is_credit_proxy(proxy);
+    asset claimable = {0, XSAT_SYMBOL};
+    asset donated_amount = {0, XSAT_SYMBOL};
+    asset position_claimable, position_donated_amount;
+    if (validators.empty()) {
+        // all positions of the staker through the proxy
+        const auto staker_id = xsat::utils::compute_id(staker);
+        auto evm_staker_idx = _evm_stake.get_index<"bystaker"_n>();
+        auto evm_staker_itr = evm_staker_idx.lower_bound(staker_id);
+        for (; evm_staker_itr != evm_staker_idx.end() && evm_staker_itr->by_staker() == staker_id;
+             evm_staker_itr++) {
+            if (evm_staker_itr->proxy != proxy) {
+                continue;
+            }
+            std::tie(position_claimable, position_donated_amount)
+                = claim_staking_reward(evm_staker_idx, evm_staker_itr, is_credit_staking, donate_rate);
+            claimable += position_claimable;
+            donated_amount += position_donated_amount;
+        }
+    } else {
+        auto evm_staker_idx = _evm_stake.get_index<"bystakingid"_n>();
+        for (const auto& validator : validators) {
+            auto evm_staker_itr
+                = evm_staker_idx.require_find(compute_staking_id(proxy, staker, validator),
+                                              "endrmng.xsat::evmbtchclaim: [evmstakers] does not exists");
+            std::tie(position_claimable, position_donated_amount)
+                = claim_staking_reward(evm_staker_idx, evm_staker_itr, is_credit_staking, donate_rate);
+            claimable += position_claimable;
+            donated_amount += position_donated_amount;
+        }
+    }
+    check(claimable.amount > 0, "endrmng.xsat::evmbtchclaim: no balance to claim");
+
+    vector<btc::recipient> recipients;
+    donate(donated_amount, recipients);
+
+    auto to_staker = claimable - donated_amount;
+    if (to_staker.amount > 0) {
+        recipients.push_back({ERC20_CONTRACT, to_staker, "0x" + xsat::utils::sha1_to_hex(staker)});
+    }
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
+}
+
+template <typename T, typename C>
+std::pair<asset, asset> endorse_manage::claim_staking_reward(T& _stake, C& native_staker_itr,
+                                                             const uint16_t donate_rate) {
+    auto validator_itr = _validator.require_find(native_staker_itr->validator.value,
+                                                 "endrmng.xsat::claim: [validators] does not exists");
+    // update reward
+    settle_validator_reward(validator_itr);
+    update_staking_reward(validator_itr->stake_acc_per_share, validator_itr->consensus_acc_per_share,
+                          native_staker_itr->quantity.amount, native_staker_itr->quantity.amount, _stake,
+                          native_staker_itr);
+
+    auto staking_reward_unclaimed = native_staker_itr->staking_reward_unclaimed;
+    auto consensus_reward_unclaimed = native_staker_itr->consensus_reward_unclaimed;
+    auto claimable = staking_reward_unclaimed + consensus_reward_unclaimed;
+    asset donated_amount = claimable * donate_rate / RATE_BASE_10000;
+    if (claimable.amount == 0) {
+        return {claimable, donated_amount};
+    }
+
+    _stake.modify(native_staker_itr, same_payer, [&](auto& row) {
+        row.total_donated += donated_amount;
+        row.staking_reward_claimed += staking_reward_unclaimed;
+        row.consensus_reward_claimed += consensus_reward_unclaimed;
+        row.staking_reward_unclaimed -= staking_reward_unclaimed;
+        row.consensus_reward_unclaimed -= consensus_reward_unclaimed;
+    });
+
+    _validator.modify(validator_itr, same_payer, [&](auto& row) {
+        row.staking_reward_balance -= staking_reward_unclaimed;
+        row.consensus_reward_balance -= consensus_reward_unclaimed;
+    });
+
+    xsat::events::emit_inline<endorse_manage::claimlog_action>(get_self(), native_staker_itr->staker,
+                                                               native_staker_itr->validator, claimable, donated_amount,
+                                                               native_staker_itr->total_donated);
+    return {claimable, donated_amount};
+}
+
+template <typename T, typename C>
+std::pair<asset, asset> endorse_manage::claim_staking_reward(T& _stake, C& evm_staker_itr,
+                                                             const bool is_credit_staking,
+                                                             const uint16_t donate_rate) {
     auto validator_itr = _validator.require_find(evm_staker_itr->validator.value,
                                                  "endrmng.xsat::evmclaim: [validators] does not exists");
+    settle_validator_reward(validator_itr);
     update_staking_reward(validator_itr->stake_acc_per_share, validator_itr->consensus_acc_per_share,
-                          evm_staker_itr->quantity.amount, evm_staker_itr->quantity.amount, evm_staker_idx,
-                          evm_staker_itr);
+                          evm_staker_itr->quantity.amount, evm_staker_itr->quantity.amount, _stake, evm_staker_itr);
 
     auto staking_reward_unclaimed = evm_staker_itr->staking_reward_unclaimed;
     auto consensus_reward_unclaimed = evm_staker_itr->consensus_reward_unclaimed;
     auto claimable = staking_reward_unclaimed + consensus_reward_unclaimed;
-    check(claimable.amount > 0, "endrmng.xsat::evmclaim: no balance to claim");
-
-    auto config = _config.get();
-
     asset validator_donated_amount = {0, XSAT_SYMBOL};
     asset staker_donated_amount = {0, XSAT_SYMBOL};
-    auto credit_proxy_idx = _credit_proxy.get_index<"byproxy"_n>();
-    auto credit_proxy_itr = credit_proxy_idx.find(xsat::utils::compute_id(proxy));
-    bool is_credit_staking = credit_proxy_itr != credit_proxy_idx.end();
+    if (claimable.amount == 0) {
+        return {claimable, staker_donated_amount};
+    }
 
     // Use validator's donate_rate for credit staking, otherwise use input donate_rate
     if (is_credit_staking) {
+        auto config = _config.get();
         auto donate_rate = std::max(config.min_donate_rate.value_or(uint16_t(0)), validator_itr->donate_rate);
         validator_donated_amount = claimable * donate_rate / RATE_BASE_10000;
     } else {
         staker_donated_amount = claimable * donate_rate / RATE_BASE_10000;
     }
 
-    evm_staker_idx.modify(evm_staker_itr, same_payer, [&](auto& row) {
+    _stake.modify(evm_staker_itr, same_payer, [&](auto& row) {
         row.total_donated += staker_donated_amount;
         row.staking_reward_claimed += staking_reward_unclaimed;
         row.consensus_reward_claimed += consensus_reward_unclaimed;
@@ -467,27 +649,39 @@ void endorse_manage::evm_claim(const name& caller, const checksum160& proxy, con
         row.consensus_reward_balance -= consensus_reward_unclaimed;
     });
 
-    auto donated_amount = staker_donated_amount + validator_donated_amount;
-    // transfer donate
-    if (donated_amount.amount > 0) {
-        token_transfer(get_self(), config.donation_account, extended_asset{donated_amount, EXSAT_CONTRACT});
+    // log
+    xsat::events::emit_inline<endorse_manage::evmclaimlog_action>(
+        get_self(), evm_staker_itr->proxy, evm_staker_itr->staker, evm_staker_itr->validator, claimable,
+        staker_donated_amount, validator_donated_amount, evm_staker_itr->total_donated, validator_itr->total_donated);
+    return {claimable, staker_donated_amount + validator_donated_amount};
+}
 
-        auto stat = _stat.get_or_default();
-        stat.xsat_total_donated += donated_amount;
-        _stat.set(stat, get_self());
-    }
+bool endorse_manage::is_credit_proxy(const checksum160& proxy) {
+    auto credit_proxy_idx = _credit_proxy.get_index<"byproxy"_n>();
+    return credit_proxy_idx.find(xsat::utils::compute_id(proxy)) != credit_proxy_idx.end();
+}
 
-    // transfer reward
-    auto to_staker = claimable - donated_amount;
-    if (to_staker.amount > 0) {
-        token_transfer(get_self(), ERC20_CONTRACT, {to_staker, EXSAT_CONTRACT},
-                       "0x" + xsat::utils::sha1_to_hex(evm_staker_itr->staker));
+void endorse_manage::donate(const asset& donated_amount) {
+    vector<btc::recipient> recipients;
+    donate(donated_amount, recipients);
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
+}
+
+void endorse_manage::donate(const asset& donated_amount, vector<btc::recipient>& recipients) {
+    if (donated_amount.amount == 0) {
+        return;
+    }
+    // an EVM donation account is paid through the ERC20 bridge, like `token_transfer`
+    auto config = _config.get();
+    if (config.donation_account.size() <= 12) {
+        recipients.push_back({name(config.donation_account), donated_amount, ""});
+    } else {
+        recipients.push_back({ERC20_CONTRACT, donated_amount, config.donation_account});
     }
 
-    // log
-    endorse_manage::evmclaimlog_action _evmclaimlog(get_self(), {get_self(), "active"_n});
-    _evmclaimlog.send(proxy, staker, validator, claimable, staker_donated_amount, validator_donated_amount,
-                      evm_staker_itr->total_donated, validator_itr->total_donated);
+    auto stat = _stat.get_or_default();
+    stat.xsat_total_donated += donated_amount;
+    _stat.set(stat, get_self());
 }
 
 //@auth validator
@@ -501,6 +695,7 @@ void endorse_manage::vdrclaim(const name& validator) {
     } else {
         require_auth(validator_itr->reward_recipient);
     }
+    settle_validator_reward(validator_itr);
 
     auto staking_reward_unclaimed = validator_itr->staking_reward_unclaimed;
     auto consensus_reward_unclaimed = validator_itr->consensus_reward_unclaimed;
@@ -523,13 +718,7 @@ void endorse_manage::vdrclaim(const name& validator) {
     });
 
     // transfer donate
-    if (donated_amount.amount > 0) {
-        token_transfer(get_self(), config.donation_account, extended_asset{donated_amount, EXSAT_CONTRACT});
-
-        auto stat = _stat.get_or_default();
-        stat.xsat_total_donated += donated_amount;
-        _stat.set(stat, get_self());
-    }
+    donate(donated_amount);
 
     // transfer reward
     if (to_validator.amount > 0) {
@@ -541,8 +730,8 @@ void endorse_manage::vdrclaim(const name& validator) {
     string reward_recipient = validator_itr->reward_recipient == ERC20_CONTRACT
                                   ? validator_itr->memo
                                   : validator_itr->reward_recipient.to_string();
-    endorse_manage::vdrclaimlog_action _vdrclaimlog(get_self(), {get_self(), "active"_n});
-    _vdrclaimlog.send(validator, reward_recipient, claimable, donated_amount, validator_itr->total_donated);
+    xsat::events::emit<endorse_manage::vdrclaimlog_action>(get_self(), validator, reward_recipient, claimable,
+                                                           donated_amount, validator_itr->total_donated);
 }
 
 std::pair<asset, asset> endorse_manage::evm_stake_without_auth(const checksum160& proxy, const checksum160& staker,
@@ -659,11 +848,14 @@ void endorse_manage::staking_change(validator_table::const_iterator& validator_i
     auto pre_amount_for_staker = stake_itr->quantity;
     auto now_amount_for_staker = stake_itr->quantity + quantity;
 
+    // rewards accrued so far belong to the current stake
+    settle_validator_reward(validator_itr);
     _validator.modify(validator_itr, same_payer, [&](auto& row) {
         row.quantity = now_amount_for_validator;
         row.qualification += qualification;
         row.latest_staking_time = current_time_point();
     });
+    update_qualified(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.total_staking += quantity;
@@ -673,10 +865,83 @@ void endorse_manage::staking_change(validator_table::const_iterator& validator_i
                           pre_amount_for_staker.amount, now_amount_for_staker.amount, _stake, stake_itr);
 }
 
-void endorse_manage::update_validator_reward(const uint64_t height, const name& validator,
+void endorse_manage::update_qualified(const validator_row& validator) {
+    auto qualified_stat = _qualified_stat.get_or_default();
+    const bool btc_qualified = validator.qualification.amount >= MIN_BTC_STAKE_FOR_VALIDATOR;
+    const bool xsat_qualified = qualified_stat.min_xsat_qualification.amount > 0 && validator.quantity.amount > 0
+                                && validator.xsat_quantity >= qualified_stat.min_xsat_qualification;
+    update_qualified(BTC_QUALIFIED_SCOPE, validator, btc_qualified, qualified_stat.num_btc_validators,
+                     qualified_stat.btc_qualified_staking);
+    update_qualified(XSAT_QUALIFIED_SCOPE, validator, xsat_qualified, qualified_stat.num_xsat_validators,
+                     qualified_stat.xsat_qualified_staking);
+    _qualified_stat.set(qualified_stat, get_self());
+}
+
+void endorse_manage::update_qualified(const name& scope, const validator_row& validator, const bool qualified,
+                                      uint32_t& num_validators, asset& qualified_staking) {
+    const bool is_xsat = scope == XSAT_QUALIFIED_SCOPE;
+    qualified_validator_table _qualified(get_self(), scope.value);
+    auto qualified_itr = _qualified.find(validator.owner.value);
+    if (qualified_itr == _qualified.end()) {
+        if (!qualified) {
+            return;
+        }
+        _qualified.emplace(get_self(), [&](auto& row) {
+            row.validator = validator.owner;
+            row.quantity = validator.quantity;
+            row.xsat_quantity = validator.xsat_quantity;
+        });
+        num_validators++;
+    } else {
+        qualified_staking -= is_xsat ? qualified_itr->xsat_quantity : qualified_itr->quantity;
+        if (!qualified) {
+            _qualified.erase(qualified_itr);
+            num_validators--;
+            return;
+        }
+        if (qualified_itr->quantity != validator.quantity || qualified_itr->xsat_quantity != validator.xsat_quantity) {
+            _qualified.modify(qualified_itr, same_payer, [&](auto& row) {
+                row.quantity = validator.quantity;
+                row.xsat_quantity = validator.xsat_quantity;
+            });
+        }
+    }
+    qualified_staking += is_xsat ? validator.xsat_quantity : validator.quantity;
+}
+
+void endorse_manage::accrue_validator_reward(const uint64_t height, const name& validator,
                                              const uint64_t staking_rewards, const uint64_t consensus_rewards) {
-    auto validator_itr = _validator.require_find(validator.value, "endrmng.xsat: [validators] does not exists");
-    check(validator_itr->latest_reward_block < height, "endrmng.xsat: the block height has been rewarded");
+    auto pending_itr = _pending_reward.find(validator.value);
+    if (pending_itr == _pending_reward.end()) {
+        auto validator_itr = _validator.require_find(validator.value, "endrmng.xsat: [validators] does not exists");
+        check(validator_itr->latest_reward_block < height, "endrmng.xsat: the block height has been rewarded");
+        _pending_reward.emplace(get_self(), [&](auto& row) {
+            row.validator = validator;
+            row.staking_rewards = {static_cast<int64_t>(staking_rewards), XSAT_SYMBOL};
+            row.consensus_rewards = {static_cast<int64_t>(consensus_rewards), XSAT_SYMBOL};
+            row.latest_reward_block = height;
+            row.latest_reward_time = current_time_point();
+        });
+        return;
+    }
+
+    check(pending_itr->latest_reward_block < height, "endrmng.xsat: the block height has been rewarded");
+    _pending_reward.modify(pending_itr, same_payer, [&](auto& row) {
+        row.staking_rewards.amount += staking_rewards;
+        row.consensus_rewards.amount += consensus_rewards;
+        row.latest_reward_block = height;
+        row.latest_reward_time = current_time_point();
+    });
+}
+
+void endorse_manage::settle_validator_reward(const validator_table::const_iterator& validator_itr) {
+    auto pending_itr = _pending_reward.find(validator_itr->owner.value);
+    if (pending_itr == _pending_reward.end() || pending_itr->latest_reward_block == validator_itr->latest_reward_block) {
+        return;
+    }
+
+    const uint64_t staking_rewards = pending_itr->staking_rewards.amount;
+    const uint64_t consensus_rewards = pending_itr->consensus_rewards.amount;
     uint128_t incr_stake_acc_per_share = 0;
     uint128_t incr_consensus_acc_per_share = 0;
     uint64_t validator_staking_rewards = staking_rewards;
@@ -705,8 +970,13 @@ void endorse_manage::update_validator_reward(const uint64_t height, const name&
         row.staking_reward_balance.amount += staking_rewards;
         row.total_consensus_reward.amount += consensus_rewards;
         row.consensus_reward_balance.amount += consensus_rewards;
-        row.latest_reward_block = height;
-        row.latest_reward_time = current_time_point();
+        row.latest_reward_block = pending_itr->latest_reward_block;
+        row.latest_reward_time = pending_itr->latest_reward_time;
+    });
+
+    _pending_reward.modify(pending_itr, same_payer, [&](auto& row) {
+        row.staking_rewards.amount = 0;
+        row.consensus_rewards.amount = 0;
     });
 }
 
@@ -744,8 +1014,7 @@ void endorse_manage::stakexsat(const name& staker, const name& validator, const
     auto validator_staking = stake_xsat_without_auth(staker, validator, quantity);
 
     // log
-    endorse_manage::stakexsatlog_action _stakexsatlog(get_self(), {get_self(), "active"_n});
-    _stakexsatlog.send(staker, validator, quantity, validator_staking);
+    xsat::events::emit<endorse_manage::stakexsatlog_action>(get_self(), staker, validator, quantity, validator_staking);
 }
 
 //@auth xsatstk.xsat
@@ -755,8 +1024,7 @@ void endorse_manage::unstakexsat(const name& staker, const name& validator, cons
     auto validator_staking = unstake_xsat_without_auth(staker, validator, quantity);
 
     // log
-    endorse_manage::unstkxsatlog_action _unstkxsatlog(get_self(), {get_self(), "active"_n});
-    _unstkxsatlog.send(staker, validator, quantity, validator_staking);
+    xsat::events::emit<endorse_manage::unstkxsatlog_action>(get_self(), staker, validator, quantity, validator_staking);
 }
 
 //@auth staker
@@ -769,8 +1037,8 @@ void endorse_manage::restakexsat(const name& staker, const name& old_validator,
     auto new_validator_staking = stake_xsat_without_auth(staker, new_validator, quantity);
 
     // log
-    endorse_manage::restkxsatlog_action _restkxsatlog(get_self(), {get_self(), "active"_n});
-    _restkxsatlog.send(staker, old_validator, new_validator, quantity, old_validator_staking, new_validator_staking);
+    xsat::events::emit<endorse_manage::restkxsatlog_action>(get_self(), staker, old_validator, new_validator, quantity,
+                                                            old_validator_staking, new_validator_staking);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -787,8 +1055,8 @@ void endorse_manage::evmstakexsat(const name& caller, const checksum160& proxy,
     auto validator_staking = evm_stake_xsat_without_auth(proxy, staker, validator, quantity);
 
     // log
-    endorse_manage::estkxsatlog_action _estkxsatlog(get_self(), {get_self(), "active"_n});
-    _estkxsatlog.send(proxy, staker, validator, quantity, validator_staking);
+    xsat::events::emit<endorse_manage::estkxsatlog_action>(get_self(), proxy, staker, validator, quantity,
+                                                           validator_staking);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -805,8 +1073,8 @@ void endorse_manage::evmunstkxsat(const name& caller, const checksum160& proxy,
     auto validator_staking = evm_unstake_xsat_without_auth(proxy, staker, validator, quantity);
 
     // log
-    endorse_manage::eustkxsatlog_action _eustkxsatlog(get_self(), {get_self(), "active"_n});
-    _eustkxsatlog.send(proxy, staker, validator, quantity, validator_staking);
+    xsat::events::emit<endorse_manage::eustkxsatlog_action>(get_self(), proxy, staker, validator, quantity,
+                                                            validator_staking);
 }
 
 // @auth scope is `evmcaller` evmproxies account
@@ -825,9 +1093,8 @@ void endorse_manage::evmrestkxsat(const name& caller, const checksum160& proxy,
     auto new_validator_staking = evm_stake_xsat_without_auth(proxy, staker, new_validator, quantity);
 
     // log
-    endorse_manage::erstkxsatlog_action _erstkxsatlog(get_self(), {get_self(), "active"_n});
-    _erstkxsatlog.send(proxy, staker, old_validator, new_validator, quantity, old_validator_staking,
-                       new_validator_staking);
+    xsat::events::emit<endorse_manage::erstkxsatlog_action>(get_self(), proxy, staker, old_validator, new_validator,
+                                                            quantity, old_validator_staking, new_validator_staking);
 }
 
 asset endorse_manage::evm_stake_xsat_without_auth(const checksum160& proxy, const checksum160& staker,
@@ -870,6 +1137,7 @@ asset endorse_manage::evm_stake_xsat_without_auth(const checksum160& proxy, cons
         row.xsat_quantity += quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_qualified(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking += quantity;
@@ -899,6 +1167,7 @@ asset endorse_manage::evm_unstake_xsat_without_auth(const checksum160& proxy, co
         row.xsat_quantity -= quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_qualified(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking -= quantity;
@@ -943,6 +1212,7 @@ asset endorse_manage::stake_xsat_without_auth(const name& staker, const name& va
         row.xsat_quantity += quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_qualified(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking += quantity;
@@ -972,6 +1242,7 @@ asset endorse_manage::unstake_xsat_without_auth(const name& staker, const name&
         row.xsat_quantity -= quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_qualified(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking -= quantity;
@@ -1014,6 +1285,22 @@ void endorse_manage::creditstake(const checksum160& proxy, const checksum160& st
                                  const asset& quantity) {
     require_auth(CUSTODY_CONTRACT);
 
+    credit_stake(proxy, staker, validator, quantity);
+}
+
+// @auth custody.xsat
+[[eosio::action]]
+void endorse_manage::creditstakes(const vector<credit_stake_row>& stakes) {
+    require_auth(CUSTODY_CONTRACT);
+    check(stakes.size() > 0, "endrmng.xsat::creditstakes: stakes are empty");
+
+    for (const auto& stake : stakes) {
+        credit_stake(stake.proxy, stake.staker, stake.validator, stake.quantity);
+    }
+}
+
+void endorse_manage::credit_stake(const checksum160& proxy, const checksum160& staker, const name& validator,
+                                  const asset& quantity) {
     auto credit_proxy_idx = _credit_proxy.get_index<"byproxy"_n>();
     auto credit_proxy_itr = credit_proxy_idx.require_find(xsat::utils::compute_id(proxy),
                                                           "endrmng.xsat::creditstake: [creditproxy] does not exist");
@@ -1043,8 +1330,8 @@ void endorse_manage::creditstake(const checksum160& proxy, const checksum160& st
             = evm_stake_without_auth(proxy, staker, validator, new_quantity, qualification);
 
         // log
-        endorse_manage::evmstakelog_action _evmstakelog(get_self(), {get_self(), "active"_n});
-        _evmstakelog.send(proxy, staker, validator, quantity, validator_staking, validator_qualification);
+        xsat::events::emit_inline<endorse_manage::evmstakelog_action>(get_self(), proxy, staker, validator, quantity,
+                                                                      validator_staking, validator_qualification);
     } else if (old_quantity > quantity) {
         asset qualification
             = quantity.amount == 0 ? asset{MIN_BTC_STAKE_FOR_VALIDATOR, BTC_SYMBOL} : asset{0, BTC_SYMBOL};
@@ -1055,8 +1342,8 @@ void endorse_manage::creditstake(const checksum160& proxy, const checksum160& st
             = evm_unstake_without_auth(proxy, staker, validator, new_quantity, qualification);
 
         // log
-        endorse_manage::evmunstlog_action _evmunstlog(get_self(), {get_self(), "active"_n});
-        _evmunstlog.send(proxy, staker, validator, quantity, validator_staking, validator_qualification);
+        xsat::events::emit_inline<endorse_manage::evmunstlog_action>(get_self(), proxy, staker, validator, quantity,
+                                                                     validator_staking, validator_qualification);
     }
 }
 
@@ -1067,12 +1354,19 @@ void endorse_manage::distribute(const uint64_t height, const vector<reward_detai
     check(rewards.size() > 0, "endrmng.xsat::distribute: rewards are empty");
     for (const auto reward : rewards) {
         if (reward.staking_rewards.amount > 0 || reward.consensus_rewards.amount > 0) {
-            update_validator_reward(height, reward.validator, reward.staking_rewards.amount,
+            accrue_validator_reward(height, reward.validator, reward.staking_rewards.amount,
                                     reward.consensus_rewards.amount);
         }
     }
 }
 
+[[eosio::action]]
+void endorse_manage::settle(const name& validator) {
+    auto validator_itr
+        = _validator.require_find(validator.value, "endrmng.xsat::settle: [validators] does not exists");
+    settle_validator_reward(validator_itr);
+}
+
 [[eosio::on_notify("*::transfer")]]
 void endorse_manage::on_transfer(const name& from, const name& to, const asset& quantity, const string& memo) {
     // ignore transfers
@@ -5,6 +5,7 @@
 #include <eosio/singleton.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/binary_extension.hpp>
+#include <btc.xsat/btc.xsat.hpp>
 #include "../internal/defines.hpp"
 #include "../internal/utils.hpp"
 
@@ -16,7 +17,9 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     using contract::contract;
 
     // CONSTANTS
-    const std::set<name> WHITELIST_TYPES = {"proxyreg"_n, "evmcaller"_n};
+    static constexpr std::array<name, 2> WHITELIST_TYPES = {"proxyreg"_n, "evmcaller"_n};
+    static constexpr name BTC_QUALIFIED_SCOPE = "btc"_n;
+    static constexpr name XSAT_QUALIFIED_SCOPE = "xsat"_n;
 
     /**
      * ## TABLE `globalid`
@@ -404,6 +407,108 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     };
     typedef eosio::singleton<"stat"_n, stat_row> stat_table;
 
+    /**
+     * ## TABLE `qualified`
+     *
+     * ### scope `btc` or `xsat`
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{asset} quantity` - the amount of BTC staked by the validator
+     * - `{asset} xsat_quantity` - the amount of XSAT tokens staked by the validator
+     *
+     * `btc` lists the validators whose qualification is at least 100 BTC, `xsat` lists the validators with a BTC stake
+     * whose XSAT stake is at least `qualstat.min_xsat_qualification`. Both are kept up to date on every stake change.
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator": "alice",
+     *   "quantity": "102.10000000 BTC",
+     *   "xsat_quantity": "21000.00000000 XSAT"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] qualified_validator_row {
+        name validator;
+        asset quantity;
+        asset xsat_quantity;
+        uint64_t primary_key() const { return validator.value; }
+    };
+    typedef eosio::multi_index<"qualified"_n, qualified_validator_row> qualified_validator_table;
+
+    /**
+     * ## TABLE `qualstat`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{asset} min_xsat_qualification` - the XSAT stake threshold of the `xsat` scope, synchronized from `blkendt.xsat`
+     * - `{uint32_t} num_btc_validators` - the number of validators in the `btc` scope
+     * - `{asset} btc_qualified_staking` - the total BTC staked by validators in the `btc` scope
+     * - `{uint32_t} num_xsat_validators` - the number of validators in the `xsat` scope
+     * - `{asset} xsat_qualified_staking` - the total XSAT staked by validators in the `xsat` scope
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "min_xsat_qualification": "21000.00000000 XSAT",
+     *   "num_btc_validators": 3,
+     *   "btc_qualified_staking": "600.00000000 BTC",
+     *   "num_xsat_validators": 1,
+     *   "xsat_qualified_staking": "21000.00000000 XSAT"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] qualified_stat_row {
+        asset min_xsat_qualification = {0, XSAT_SYMBOL};
+        uint32_t num_btc_validators = 0;
+        asset btc_qualified_staking = {0, BTC_SYMBOL};
+        uint32_t num_xsat_validators = 0;
+        asset xsat_qualified_staking = {0, XSAT_SYMBOL};
+    };
+    typedef eosio::singleton<"qualstat"_n, qualified_stat_row> qualified_stat_table;
+
+    /**
+     * ## TABLE `pendingrwds`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{asset} staking_rewards` - staking rewards distributed since the validator was last settled
+     * - `{asset} consensus_rewards` - consensus rewards distributed since the validator was last settled
+     * - `{uint64_t} latest_reward_block` - latest reward block
+     * - `{time_point_sec} latest_reward_time` - latest reward time
+     *
+     * `distribute` only accumulates into this row. The commission split and the `stake_acc_per_share` /
+     * `consensus_acc_per_share` update of `validators` are applied when the validator or one of its stakers next acts,
+     * or when `settle` is called.
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator": "alice",
+     *   "staking_rewards": "22.50000000 XSAT",
+     *   "consensus_rewards": "2.50000000 XSAT",
+     *   "latest_reward_block": 840001,
+     *   "latest_reward_time": "2024-07-13T14:29:32"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] pending_reward_row {
+        name validator;
+        asset staking_rewards;
+        asset consensus_rewards;
+        uint64_t latest_reward_block;
+        time_point_sec latest_reward_time;
+        uint64_t primary_key() const { return validator.value; }
+    };
+    typedef eosio::multi_index<"pendingrwds"_n, pending_reward_row> pending_reward_table;
+
     /**
      * ## ACTION `setdonateacc`
      *
@@ -569,6 +674,51 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     [[eosio::action]]
     void setstatus(const name& validator, const bool disabled_staking);
 
+    /**
+     * ## ACTION `setxsatqual`
+     *
+     * - **authority**: `blkendt.xsat`
+     *
+     * > Set the XSAT stake threshold of the `xsat` qualified validators, only validators between the old and new threshold are re-evaluated
+     *
+     * ### params
+     *
+     * - `{asset} min_xsat_qualification` - the minimum pledge amount of xsat to become a validator
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat setxsatqual '["21000.00000000 XSAT"]' -p blkendt.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void setxsatqual(const asset& min_xsat_qualification);
+
+    /**
+     * ## ACTION `syncqualify`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Rebuild the qualified validators of up to `rows` validators starting from `validator`
+     *
+     * Every call first seeds `qualstat.min_xsat_qualification` from the `blkendt.xsat` config when they differ, so the
+     * `xsat` scope is filled without pushing `blkendt.xsat::config` again. Upgrade order: deploy `endrmng.xsat`, then
+     * page `syncqualify` from `""` until every validator is synchronized.
+     *
+     * ### params
+     *
+     * - `{name} validator` - the first validator account to synchronize
+     * - `{uint64_t} rows` - the maximum number of validators to synchronize, 0 means no limit
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat syncqualify '["", 100]' -p endrmng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void syncqualify(const name& validator, uint64_t rows);
+
     /**
      * ## ACTION `regvalidator`
      *
@@ -748,6 +898,28 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     [[eosio::action]]
     void claim(const name& staker, const name& validator, const uint16_t donate_rate);
 
+    /**
+     * ## ACTION `batchclaim`
+     *
+     * - **authority**: `staker`
+     *
+     * > Claim the staking rewards of several validators with a single transfer
+     *
+     * ### params
+     *
+     * - `{name} staker` - staker account
+     * - `{vector<name>} validators` - validator accounts, empty to claim every position of the staker
+     * - `{uint16_t} donate_rate` - the donation rate, represented as a percentage, ex: 500 means 5.00%
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat batchclaim '["alice", ["alice", "bob"], 100]' -p alice
+     * ```
+     */
+    [[eosio::action]]
+    void batchclaim(const name& staker, const vector<name>& validators, const uint16_t donate_rate);
+
     /**
      * ## ACTION `evmstake`
      *
@@ -872,6 +1044,31 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     void evmclaim2(const name& caller, const checksum160& proxy, const checksum160& staker, const name& validator,
                    const uint16_t donate_rate);
 
+    /**
+     * ## ACTION `evmbtchclaim`
+     *
+     * - **authority**: `caller`
+     *
+     * > Claim the staking rewards of several validators through evm with a single transfer
+     *
+     * ### params
+     *
+     * - `{name} caller` - caller account
+     * - `{checksum160} proxy` - evm proxy account
+     * - `{checksum160} staker` - evm staker account
+     * - `{vector<name>} validators` - validator accounts, empty to claim every position of the staker through `proxy`
+     * - `{uint16_t} donate_rate` - the donation rate, represented as a percentage, ex: 500 means 5.00%
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat evmbtchclaim '["evmutil.xsat", "bb776ae86d5996908af46482f24be8ccde2d4c41", "e4d68a77714d9d388d8233bee18d578559950cf5", ["alice", "bob"], 100]' -p evmutil.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void evmbtchclaim(const name& caller, const checksum160& proxy, const checksum160& staker,
+                      const vector<name>& validators, const uint16_t donate_rate);
+
     /**
      * ## ACTION `vdrclaim`
      *
@@ -1058,6 +1255,54 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     [[eosio::action]] [[eosio::action]]
     void creditstake(const checksum160& proxy, const checksum160& staker, const name& validator, const asset& quantity);
 
+    /**
+     * ## STRUCT `credit_stake_row`
+     *
+     * ### params
+     *
+     * - `{checksum160} proxy` - evm proxy account
+     * - `{checksum160} staker` - evm staker account
+     * - `{name} validator` - validator account
+     * - `{asset} quantity` - staking amount
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "proxy": "bb776ae86d5996908af46482f24be8ccde2d4c41",
+     *   "staker": "e4d68a77714d9d388d8233bee18d578559950cf5",
+     *   "validator": "alice",
+     *   "quantity": "1.00000000 BTC"
+     * }
+     * ```
+     */
+    struct credit_stake_row {
+        checksum160 proxy;
+        checksum160 staker;
+        name validator;
+        asset quantity;
+    };
+
+    /**
+     * ## ACTION `creditstakes`
+     *
+     * - **authority**: `custody.xsat`
+     *
+     * > Batch version of `creditstake`, applies every credit stake in a single action
+     *
+     * ### params
+     *
+     * - `{vector<credit_stake_row>} stakes` - credit stakes to apply
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat creditstakes '[[{"proxy": "bb776ae86d5996908af46482f24be8ccde2d4c41", "staker": "e4d68a77714d9d388d8233bee18d578559950cf5", "validator": "alice", "quantity": "1.00000000 BTC"}]]' -p custody.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void creditstakes(const vector<credit_stake_row>& stakes);
+
     /**
      * ## STRUCT `reward_details_row`
      *
@@ -1104,6 +1349,26 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     [[eosio::action]]
     void distribute(const uint64_t height, const vector<reward_details_row> rewards);
 
+    /**
+     * ## ACTION `settle`
+     *
+     * - **authority**: `anyone`
+     *
+     * > Apply the pending rewards of a validator to `validators`
+     *
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat settle '["alice"]' -p alice
+     * ```
+     */
+    [[eosio::action]]
+    void settle(const name& validator);
+
     [[eosio::on_notify("*::transfer")]]
     void on_transfer(const name& from, const name& to, const asset& quantity, const string& memo);
 
@@ -1230,6 +1495,8 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     using evm_unstake_action = eosio::action_wrapper<"evmunstake"_n, &endorse_manage::evmunstake>;
     using evm_newstake_action = eosio::action_wrapper<"evmnewstake"_n, &endorse_manage::evmnewstake>;
     using creditstake_action = eosio::action_wrapper<"creditstake"_n, &endorse_manage::creditstake>;
+    using creditstakes_action = eosio::action_wrapper<"creditstakes"_n, &endorse_manage::creditstakes>;
+    using setxsatqual_action = eosio::action_wrapper<"setxsatqual"_n, &endorse_manage::setxsatqual>;
 
     using stakexsat_action = eosio::action_wrapper<"stakexsat"_n, &endorse_manage::stakexsat>;
     using unstakexsat_action = eosio::action_wrapper<"unstakexsat"_n, &endorse_manage::unstakexsat>;
@@ -1280,6 +1547,8 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     native_staker_table _native_stake = native_staker_table(_self, _self.value);
     credit_proxy_table _credit_proxy = credit_proxy_table(_self, _self.value);
     stat_table _stat = stat_table(_self, _self.value);
+    qualified_stat_table _qualified_stat = qualified_stat_table(_self, _self.value);
+    pending_reward_table _pending_reward = pending_reward_table(_self, _self.value);
     config_table _config = config_table(_self, _self.value);
 
     uint64_t next_staking_id();
@@ -1291,6 +1560,19 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     void evm_claim(const name& caller, const checksum160& proxy, const checksum160& staker, const name& validator,
                    const uint16_t donate_rate);
 
+    template <typename T, typename C>
+    std::pair<asset, asset> claim_staking_reward(T& _stake, C& native_staker_itr, const uint16_t donate_rate);
+
+    template <typename T, typename C>
+    std::pair<asset, asset> claim_staking_reward(T& _stake, C& evm_staker_itr, const bool is_credit_staking,
+                                                 const uint16_t donate_rate);
+
+    bool is_credit_proxy(const checksum160& proxy);
+
+    void donate(const asset& donated_amount);
+
+    void donate(const asset& donated_amount, vector<btc::recipient>& recipients);
+
     asset evm_stake_xsat_without_auth(const checksum160& proxy, const checksum160& staker, const name& validator,
                                       const asset& quantity);
     asset evm_unstake_xsat_without_auth(const checksum160& proxy, const checksum160& staker, const name& validator,
@@ -1310,6 +1592,9 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     std::pair<asset, asset> unstake_without_auth(const name& staker, const name& validator, const asset& quantity,
                                                  const asset& qualification);
 
+    void credit_stake(const checksum160& proxy, const checksum160& staker, const name& validator,
+                      const asset& quantity);
+
     template <typename T, typename C>
     void staking_change(validator_table::const_iterator& validator_itr, T& _stake, C& stake_itr, const asset& quantity,
                         const asset& qualification);
@@ -1318,9 +1603,18 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     void update_staking_reward(const uint128_t stake_acc_per_share, const uint128_t consensus_acc_per_share,
                                const uint64_t pre_stake, const uint64_t now_stake, T& _stake, C& stake_itr);
 
-    void update_validator_reward(const uint64_t height, const name& validator, const uint64_t staking_reward,
+    void set_xsat_qualification(const asset& min_xsat_qualification);
+
+    void update_qualified(const validator_row& validator);
+
+    void update_qualified(const name& scope, const validator_row& validator, const bool qualified,
+                          uint32_t& num_validators, asset& qualified_staking);
+
+    void accrue_validator_reward(const uint64_t height, const name& validator, const uint64_t staking_reward,
                                  const uint64_t consensus_reward);
 
+    void settle_validator_reward(const validator_table::const_iterator& validator_itr);
+
     void register_validator(const name& proxy, const name& validator, const string& financial_account,
                             const uint16_t commission_rate);
 
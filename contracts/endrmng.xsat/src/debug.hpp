@@ -14,11 +14,18 @@ void endorse_manage::cleartable(const name table_name, const optional<name> scop
 
     endorse_manage::whitelist_table _whitelist(get_self(), value);
     evm_proxy_table _evm_proxy = evm_proxy_table(get_self(), value);
+    qualified_validator_table _qualified = qualified_validator_table(get_self(), value);
 
     if (table_name == "globalid"_n)
         _global_id.remove();
     else if (table_name == "stat"_n)
         _stat.remove();
+    else if (table_name == "qualstat"_n)
+        _qualified_stat.remove();
+    else if (table_name == "qualified"_n)
+        clear_table(_qualified, rows_to_clear);
+    else if (table_name == "pendingrwds"_n)
+        clear_table(_pending_reward, rows_to_clear);
     else if (table_name == "validators"_n)
         clear_table(_validator, rows_to_clear);
     else if (table_name == "stakers"_n)
@@ -1,4 +1,5 @@
 #include <exsat.xsat/exsat.xsat.hpp>
+#include "../internal/events.hpp"
 
 void exsat::create(const name& issuer, const asset& maximum_supply) {
     require_auth(get_self());
@@ -87,8 +88,38 @@ void exsat::transfer(const name& from, const name& to, const asset& quantity, co
     auto from_balance = sub_balance(from, quantity);
     auto to_balance = add_balance(to, quantity, payer);
 
-    exsat::transferlog_action transferlog(get_self(), {get_self(), "active"_n});
-    transferlog.send(from, to, quantity, from_balance, to_balance, memo);
+    xsat::events::emit_inline<exsat::transferlog_action>(get_self(), from, to, quantity, from_balance, to_balance,
+                                                         memo);
+}
+
+void exsat::transfers(const name& from, const vector<recipient>& recipients) {
+    check(!recipients.empty(), "recipients cannot be empty");
+    require_auth(from);
+    auto sym = recipients[0].quantity.symbol.code();
+    stats statstable(get_self(), sym.raw());
+    const auto& st = statstable.get(sym.raw());
+
+    require_recipient(from);
+
+    // credit each recipient, then debit the sum from `from` once
+    asset quantity = {0, st.supply.symbol};
+    for (const auto& item : recipients) {
+        check(from != item.to, "cannot transfer to self");
+        check(is_account(item.to), "to account does not exist");
+        check(item.quantity.is_valid(), "invalid quantity");
+        check(item.quantity.amount > 0, "must transfer positive quantity");
+        check(item.quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+        check(item.memo.size() <= 256, "memo has more than 256 bytes");
+
+        require_recipient(item.to);
+
+        auto payer = has_auth(item.to) ? item.to : from;
+        add_balance(item.to, item.quantity, payer);
+        quantity += item.quantity;
+    }
+    auto from_balance = sub_balance(from, quantity);
+
+    xsat::events::emit_inline<exsat::transferslog_action>(get_self(), from, quantity, from_balance, recipients);
 }
 
 asset exsat::sub_balance(const name& owner, const asset& value) {
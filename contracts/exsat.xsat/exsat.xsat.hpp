@@ -5,6 +5,7 @@
 
 using namespace eosio;
 using std::string;
+using std::vector;
 
 class [[eosio::contract("exsat.xsat")]] exsat : public contract {
    public:
@@ -92,12 +93,39 @@ class [[eosio::contract("exsat.xsat")]] exsat : public contract {
     [[eosio::action]]
     void close(const name& owner, const symbol& symbol);
 
+    struct recipient {
+        name to;
+        asset quantity;
+        string memo;
+    };
+
+    /**
+     * Allows `from` account to transfer tokens to several accounts in one action.
+     * `from` is debited once with the sum of all quantities and each recipient is credited with its quantity.
+     * Recipients are notified with `transfers`, not `transfer`: contracts, wallets and indexers that only follow
+     * `transfer` do not see these payments.
+     *
+     * @param from - the account to transfer from,
+     * @param recipients - the accounts to be transferred to, each with its quantity and memo.
+     *
+     * @pre Recipients must not be empty,
+     * @pre All quantities must have the same symbol.
+     */
+    [[eosio::action]]
+    void transfers(const name& from, const vector<recipient>& recipients);
+
     [[eosio::action]]
     void transferlog(const name& from, const name& to, const asset& quantity, const asset& from_balance,
                      const asset& to_balance, const string& memo) {
         require_auth(get_self());
     }
 
+    [[eosio::action]]
+    void transferslog(const name& from, const asset& quantity, const asset& from_balance,
+                      const vector<recipient>& recipients) {
+        require_auth(get_self());
+    }
+
     /**
      * Get supply method.
      *
@@ -135,6 +163,8 @@ class [[eosio::contract("exsat.xsat")]] exsat : public contract {
     using open_action = eosio::action_wrapper<"open"_n, &exsat::open>;
     using close_action = eosio::action_wrapper<"close"_n, &exsat::close>;
     using transferlog_action = eosio::action_wrapper<"transferlog"_n, &exsat::transferlog>;
+    using transfers_action = eosio::action_wrapper<"transfers"_n, &exsat::transfers>;
+    using transferslog_action = eosio::action_wrapper<"transferslog"_n, &exsat::transferslog>;
 
     struct [[eosio::table]] account {
         asset balance;
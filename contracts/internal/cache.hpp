@@ -0,0 +1,150 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+#include <eosio/multi_index.hpp>
+#include <eosio/singleton.hpp>
+#include <map>
+#include <optional>
+#include <tuple>
+#include "profile.hpp"
+
+using namespace eosio;
+using namespace std;
+
+// Read-through cache for rows that are read several times within one action.
+//
+// Contract memory is reset before every action, so the rows kept in static storage live exactly as long as the action
+// that read them. Writes made through `emplace`, `modify`, `erase` and `set_singleton` update the cached row. A row
+// written directly through its table must be dropped with `invalidate` before it is read through the cache again.
+namespace xsat::cache {
+
+    template <typename Table>
+    struct table_traits;
+
+    template <name::raw TableName, typename T, typename... Indices>
+    struct table_traits<eosio::multi_index<TableName, T, Indices...>> {
+        using value_type = T;
+    };
+
+    template <name::raw SingletonName, typename T>
+    struct table_traits<eosio::singleton<SingletonName, T>> {
+        using value_type = T;
+    };
+
+#ifdef PROFILE
+    template <name::raw TableName, typename T, typename... Indices>
+    struct table_traits<xsat::profile::multi_index<TableName, T, Indices...>> {
+        using value_type = T;
+    };
+
+    template <name::raw SingletonName, typename T>
+    struct table_traits<xsat::profile::singleton<SingletonName, T>> {
+        using value_type = T;
+    };
+#endif
+
+    template <typename Table>
+    using value_type = typename table_traits<Table>::value_type;
+
+    // code, scope, primary key
+    using row_key = std::tuple<uint64_t, uint64_t, uint64_t>;
+
+    // singleton rows are cached under primary key 0
+    static constexpr uint64_t SINGLETON_KEY = 0;
+
+    // rows read or written so far by the current action, `nullopt` when the row does not exist
+    template <typename Table>
+    static std::map<row_key, std::optional<value_type<Table>>>& rows() {
+        static std::map<row_key, std::optional<value_type<Table>>> cached;
+        return cached;
+    }
+
+    template <typename Table>
+    static const std::optional<value_type<Table>>& find(const name& code, const uint64_t scope,
+                                                        const uint64_t primary_key) {
+        auto& cached = rows<Table>();
+        const row_key key = {code.value, scope, primary_key};
+        auto itr = cached.find(key);
+        if (itr == cached.end()) {
+            Table table(code, scope);
+            auto row_itr = table.find(primary_key);
+            std::optional<value_type<Table>> row;
+            if (row_itr != table.end()) {
+                row = *row_itr;
+            }
+            itr = cached.emplace(key, std::move(row)).first;
+        }
+        return itr->second;
+    }
+
+    template <typename Table>
+    static const value_type<Table>& get(const name& code, const uint64_t scope, const uint64_t primary_key,
+                                        const char* error_msg = "unable to find key") {
+        const auto& row = find<Table>(code, scope, primary_key);
+        check(row.has_value(), error_msg);
+        return *row;
+    }
+
+    template <typename Singleton>
+    static const std::optional<value_type<Singleton>>& find_singleton(const name& code, const uint64_t scope) {
+        auto& cached = rows<Singleton>();
+        const row_key key = {code.value, scope, SINGLETON_KEY};
+        auto itr = cached.find(key);
+        if (itr == cached.end()) {
+            Singleton table(code, scope);
+            std::optional<value_type<Singleton>> row;
+            if (table.exists()) {
+                row = table.get();
+            }
+            itr = cached.emplace(key, std::move(row)).first;
+        }
+        return itr->second;
+    }
+
+    template <typename Singleton>
+    static const value_type<Singleton>& get_singleton(const name& code, const uint64_t scope) {
+        const auto& row = find_singleton<Singleton>(code, scope);
+        check(row.has_value(), "singleton does not exist");
+        return *row;
+    }
+
+    template <typename Singleton>
+    static value_type<Singleton> get_singleton_or_default(const name& code, const uint64_t scope,
+                                                          const value_type<Singleton>& def = value_type<Singleton>()) {
+        const auto& row = find_singleton<Singleton>(code, scope);
+        return row.has_value() ? *row : def;
+    }
+
+    // write-through
+    template <typename Singleton>
+    static void set_singleton(const name& code, const uint64_t scope, const value_type<Singleton>& value,
+                              const name& payer) {
+        Singleton table(code, scope);
+        table.set(value, payer);
+        rows<Singleton>()[{code.value, scope, SINGLETON_KEY}] = value;
+    }
+
+    template <typename Table, typename Lambda>
+    static typename Table::const_iterator emplace(Table& table, const name& payer, Lambda&& updater) {
+        auto itr = table.emplace(payer, std::forward<Lambda>(updater));
+        rows<Table>()[{table.get_code().value, table.get_scope(), itr->primary_key()}] = *itr;
+        return itr;
+    }
+
+    template <typename Table, typename Lambda>
+    static void modify(Table& table, const typename Table::const_iterator& itr, const name& payer, Lambda&& updater) {
+        table.modify(itr, payer, std::forward<Lambda>(updater));
+        rows<Table>()[{table.get_code().value, table.get_scope(), itr->primary_key()}] = *itr;
+    }
+
+    template <typename Table>
+    static typename Table::const_iterator erase(Table& table, const typename Table::const_iterator& itr) {
+        rows<Table>()[{table.get_code().value, table.get_scope(), itr->primary_key()}] = std::nullopt;
+        return table.erase(itr);
+    }
+
+    template <typename Table>
+    static void invalidate(const name& code, const uint64_t scope, const uint64_t primary_key) {
+        rows<Table>().erase({code.value, scope, primary_key});
+    }
+}  // namespace xsat::cache
@@ -7,42 +7,42 @@
 
 using namespace eosio;
 
-// CHAIN PARAMS
+// CHAIN PARAMS (evaluated at compile time, including the pow limit)
 #if defined(TESTNET)
-static const bitcoin::core::Params CHAIN_PARAMS
+static constexpr bitcoin::core::Params CHAIN_PARAMS
     = {.BIP34_height = 227931,
        .BIP65_height = 388381,   // 000000000000000004c2b624ed5d7756c508d90fd0da2c7c679febfa6c4735f0
        .BIP66_height = 363725,   // 00000000000000000379eaa19dce8c9b722d46ae6a57c2f1a988119488b50931
        .CSV_height = 419328,     // 000000000000000004a1b34462cb8aeebd5799177f7a29cf28f2d1961716b5b5
        .Segwit_height = 481824,  // 0000000000000000001c8018d9cb3b742ef25114f27563e3fc4a1902167f9893
-       .pow_limit = "0x00000000ffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+       .pow_limit = ~intx::uint256{0} >> 32,  // 0x00000000ffffffffffffffffffffffffffffffffffffffffffffffffffffffff
        .pow_target_timespan = 14 * 24 * 60 * 60,
        .pow_target_spacing = 10 * 60,
        .pow_allow_min_difficulty_blocks = true,
        .enforce_BIP94 = false,
        .bech32_hrp = "tb",
        .base58Prefixes = {
-           std::vector<unsigned char>(1, 111),  // PUBKEY_ADDRESS
-           std::vector<unsigned char>(1, 196),  // SCRIPT_ADDRESS
+           std::array<unsigned char, 1>{111},  // PUBKEY_ADDRESS
+           std::array<unsigned char, 1>{196},  // SCRIPT_ADDRESS
        }};
 
 static constexpr uint64_t START_HEIGHT = 2903240;
 #else
-static const bitcoin::core::Params CHAIN_PARAMS
+static constexpr bitcoin::core::Params CHAIN_PARAMS
     = {.BIP34_height = 21111,
        .BIP65_height = 581885,   // 00000000007f6655f22f98e72ed80d8b06dc761d5da09df0fa1dc4be4f861eb6
        .BIP66_height = 330776,   // 000000002104c8c45e99a8853285a3b592602a3ccde2b832481da85e9e4ba182
        .CSV_height = 770112,     // 00000000025e930139bac5c6c31a403776da130831ab85be56578f3fa75369bb
        .Segwit_height = 834624,  // 00000000002b980fcd729daaa248fd9316a5200e9b367f4ff2c42453e84201ca
-       .pow_limit = "0x00000000ffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+       .pow_limit = ~intx::uint256{0} >> 32,  // 0x00000000ffffffffffffffffffffffffffffffffffffffffffffffffffffffff
        .pow_target_timespan = 14 * 24 * 60 * 60,
        .pow_target_spacing = 10 * 60,
        .pow_allow_min_difficulty_blocks = false,
        .enforce_BIP94 = false,
        .bech32_hrp = "bc",
        .base58Prefixes = {
-           std::vector<unsigned char>(1, 0),  // PUBKEY_ADDRESS
-           std::vector<unsigned char>(1, 5),  // SCRIPT_ADDRESS
+           std::array<unsigned char, 1>{0},  // PUBKEY_ADDRESS
+           std::array<unsigned char, 1>{5},  // SCRIPT_ADDRESS
        }};
 static constexpr uint64_t START_HEIGHT = 839999;
 #endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+#include <vector>
+#include "profile.hpp"
+
+using namespace eosio;
+using namespace std;
+
+// Log events are returned as the action return value instead of being sent as inline log actions.
+//
+// The return value of an action is a packed `vector<event>`: `tag` is the name of the log action and `data` is
+// its packed params, so indexers decode `data` with the log action's ABI struct.
+//
+// Every log type has one channel, chosen at the call site and never by the size of the payload:
+// - `emit` returns the event. Only logs of bounded size that an action emits at most once use it, so the return
+//   value always fits `MAX_RETURN_VALUE_SIZE`.
+// - `emit_inline` always sends the inline log action. It is used by logs of unbounded size (`transferlog` with its
+//   memo, `transferslog`, `endtrwdlog`, `settlelog`) and by logs emitted once per item of a batch (`claimlog`,
+//   `evmclaimlog`, `evmstakelog`, `evmunstlog` of endrmng.xsat).
+//
+// Build with `-DLEGACY_LOG` to send every log as its inline log action.
+namespace xsat::events {
+
+    // chain default of `max_action_return_value_size`
+    static constexpr uint32_t MAX_RETURN_VALUE_SIZE = 256;
+
+    struct event {
+        name tag;
+        vector<char> data;
+
+        EOSLIB_SERIALIZE(event, (tag)(data))
+    };
+
+    // events emitted so far by the current action
+    static vector<event>& emitted() {
+        static vector<event> events;
+        return events;
+    }
+
+    template <typename Action, typename... Args>
+    static void emit_inline(const name& self, Args&&... args) {
+        xsat::profile::send<Action>(self, {self, "active"_n}, std::forward<Args>(args)...);
+    }
+
+    template <typename Action, typename... Args>
+    static void emit(const name& self, Args&&... args) {
+#ifdef LEGACY_LOG
+        emit_inline<Action>(self, std::forward<Args>(args)...);
+#else
+        auto log = Action(self, {self, "active"_n}).to_action(std::forward<Args>(args)...);
+        auto& events = emitted();
+        events.push_back({log.name, log.data});
+        auto packed = pack(events);
+        check(packed.size() <= MAX_RETURN_VALUE_SIZE,
+              "xsat::events::emit: " + log.name.to_string() + " does not fit the action return value");
+        set_action_return_value(packed.data(), packed.size());
+#endif
+    }
+}  // namespace xsat::events
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <bitcoin/core/block_header.hpp>
+#include <bitcoin/core/transaction.hpp>
+#include <cmath>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "defines.hpp"
+#include "utils.hpp"
+
+using namespace eosio;
+using namespace std;
+
+// Block verification, parsing and UTXO migration hot paths of blksync.xsat and utxomng.xsat.
+//
+// The helpers only touch the block data and the rows, tables and indices handed to them, so tests/bench/replay.cpp runs
+// the same code natively against in-memory tables. Reading chunks, configs and the actions that call these stay in the
+// contracts.
+namespace xsat::parsing {
+
+    // context-free checks of a transaction, see `CheckTransaction` of Bitcoin Core
+    static optional<string> check_transaction(const bitcoin::core::transaction& tx) {
+        if (tx.inputs.empty()) {
+            return "bad-txns-vin-empty";
+        }
+
+        if (tx.outputs.empty()) {
+            return "bad-txns-vout-empty";
+        }
+
+        uint64_t value_out = 0;
+        for (const auto& output : tx.outputs) {
+            if (output.value > BTC_SUPPLY) {
+                return "bad-txns-vout-toolarge";
+            }
+            value_out += output.value;
+            if (value_out > BTC_SUPPLY) {
+                return "bad-txns-txouttotal-toolarge";
+            }
+        }
+        auto is_coinbase = tx.is_coinbase();
+        std::set<std::pair<bitcoin::uint256_t, uint32_t>> vin_out_points;
+        for (const auto& input : tx.inputs) {
+            if (!vin_out_points.emplace(input.previous_output_hash, input.previous_output_index).second) {
+                return "bad-txns-inputs-duplicate";
+            }
+            if (is_coinbase) {
+                auto script_size = tx.inputs[0].script_sig.data.size();
+                if (script_size < 2 || script_size > 100) {
+                    return "bad-cb-length";
+                }
+            } else {
+                if (input.previous_output_hash == bitcoin::uint256_t(0)) {
+                    return "bad-txns-prevout-null";
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Verifies the next `num_txs_per_verification` transactions of a block and records the progress in `verify_info`
+     * (a `block_sync::verify_info_data`).
+     *
+     * `block_data` holds the block from `verify_info.processed_position` to its end. The first step also checks the
+     * header against `hash`, and `on_coinbase` is called with the coinbase transaction. The relay merkle root of a
+     * short last step is raised to `num_merkle_layer` so every step is a leaf of the same tree; the block merkle roots
+     * are checked once all transactions are processed.
+     */
+    template <typename VerifyInfo, typename OnCoinbase>
+    static optional<string> verify_transactions(const std::vector<char>& block_data, const checksum256& hash,
+                                                const uint64_t height, const uint64_t block_size,
+                                                const uint16_t num_txs_per_verification,
+                                                const uint8_t num_merkle_layer, VerifyInfo& verify_info,
+                                                OnCoinbase&& on_coinbase) {
+        eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+
+        // verify header
+        if (verify_info.processed_position == 0) {
+            bitcoin::core::block_header block_header;
+            block_stream >> block_header;
+
+            auto block_hash = bitcoin::be_checksum256_from_uint(block_header.hash());
+
+            if (block_hash != hash) {
+                return "hash_mismatch";
+            }
+
+            if (block_header.version_are_invalid(height, CHAIN_PARAMS)) {
+                return "bad-version";
+            }
+
+            if (!block_header.target_is_valid()) {
+                return "invalid_target";
+            }
+
+            verify_info.num_transactions = bitcoin::varint::decode(block_stream);
+            // check transactions size
+            if (verify_info.num_transactions == 0) {
+                return "tx_size_limits";
+            }
+
+            verify_info.previous_block_hash = bitcoin::be_checksum256_from_uint(block_header.previous_block_hash);
+            verify_info.work = bitcoin::be_checksum256_from_uint(block_header.work());
+            verify_info.header_merkle = bitcoin::le_checksum256_from_uint(block_header.merkle);
+            verify_info.timestamp = block_header.timestamp;
+            verify_info.bits = block_header.bits;
+        }
+
+        // deserialization transaction
+        auto pending_transactions = verify_info.num_transactions - verify_info.processed_transactions;
+        uint64_t rows = num_txs_per_verification;
+        if (rows > pending_transactions) {
+            rows = pending_transactions;
+        }
+        std::vector<bitcoin::core::transaction> transactions;
+        transactions.reserve(rows);
+        for (auto i = 0; i < rows; i++) {
+            // Coinbase needs to obtain witness data
+            bool allow_witness = verify_info.processed_position == 0 && i == 0;
+            bitcoin::core::transaction transaction(&block_data, allow_witness);
+            block_stream >> transaction;
+
+            auto err_msg = check_transaction(transaction);
+            if (err_msg.has_value()) {
+                return err_msg;
+            }
+
+            transactions.emplace_back(std::move(transaction));
+        }
+
+        if (!verify_info.has_witness) {
+            verify_info.has_witness = std::any_of(transactions.cbegin(), transactions.cend(), [](const auto& trx) {
+                return trx.witness.size() > 0;
+            });
+        }
+
+        // check witness ?
+        if (verify_info.processed_position == 0 && transactions.front().inputs.size() > 0) {
+            if (!transactions.front().is_coinbase()) {
+                return "coinbase_missing";
+            }
+            const auto& cbtrx = transactions.front();
+            verify_info.witness_reserve_value = cbtrx.get_witness_reserve_value();
+            if (cbtrx.witness.size() > 0 && !verify_info.witness_reserve_value.has_value()) {
+                return "bad-witness-nonce-size";
+            }
+
+            verify_info.witness_commitment = cbtrx.get_witness_commitment();
+
+            on_coinbase(cbtrx);
+        }
+
+        auto need_witness_check
+            = verify_info.witness_reserve_value.has_value() && verify_info.witness_commitment.has_value();
+
+        // obtain relay merkle
+        bool mutated;
+        bitcoin::uint256_t header_merkle = bitcoin::core::generate_header_merkle(transactions, &mutated);
+        if (mutated) {
+            return "bad_txns_duplicate";
+        }
+
+        bitcoin::uint256_t witness_merkle;
+        if (need_witness_check) {
+            witness_merkle = bitcoin::core::generate_witness_merkle(transactions, /*mutated=*/nullptr);
+        }
+
+        // calculate to the same layer
+        if (verify_info.num_transactions > num_txs_per_verification && rows != num_txs_per_verification) {
+            uint8_t current_layer = static_cast<uint8_t>(std::ceil(std::log2(rows)));
+            for (; current_layer < num_merkle_layer; current_layer++) {
+                header_merkle = bitcoin::dhash_nodes(header_merkle, header_merkle);
+                if (need_witness_check) {
+                    witness_merkle = bitcoin::dhash_nodes(witness_merkle, witness_merkle);
+                }
+            }
+        }
+
+        // save sub merkle
+        verify_info.relay_header_merkle.emplace_back(bitcoin::le_checksum256_from_uint(header_merkle));
+        if (need_witness_check) {
+            verify_info.relay_witness_merkle.emplace_back(bitcoin::le_checksum256_from_uint(witness_merkle));
+        }
+
+        // save processed position
+        verify_info.processed_transactions += rows;
+        verify_info.processed_position += block_stream.tellp();
+
+        // check data size
+        if (verify_info.num_transactions == verify_info.processed_transactions
+            && verify_info.processed_position < block_size) {
+            return "data_exceeds";
+        }
+
+        if (verify_info.processed_position == block_size
+            && verify_info.num_transactions > verify_info.processed_transactions) {
+            return "missing_block_data";
+        }
+
+        // verify merkle
+        if (verify_info.num_transactions == verify_info.processed_transactions
+            && verify_info.processed_position == block_size) {
+            // verify header merkle
+            auto header_merkle_root = bitcoin::generate_merkle_root(verify_info.relay_header_merkle);
+            if (header_merkle_root != bitcoin::le_uint_from_checksum256(verify_info.header_merkle)) {
+                return "merkle_invalid";
+            }
+
+            // verify witness merkle
+            if (need_witness_check) {
+                auto witness_merkle_root = bitcoin::core::generate_witness_merkle(verify_info.relay_witness_merkle,
+                                                                                  *verify_info.witness_reserve_value);
+                if (witness_merkle_root != bitcoin::le_uint_from_checksum256(*verify_info.witness_commitment)) {
+                    return "witness_merkle_invalid";
+                }
+            } else if (verify_info.has_witness) {
+                return "witness_merkle_invalid";
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Parses up to `process_row` inputs and outputs of a block and records the progress in `parsing_progress` (a
+     * `utxo_manage::parsing_progress_row`), `0` parses the rest of the block.
+     *
+     * `block_data` holds the block from the end of its header plus `parsing_progress.parsed_position`. Every input of a
+     * non-coinbase transaction and every spendable output is handed to
+     * `save(txid, index, scriptpubkey, value, type)`, inputs as the outpoint they spend with an empty script.
+     */
+    template <typename ParsingProgress, typename Save>
+    static void parse_transactions(const std::vector<char>& block_data, ParsingProgress& parsing_progress,
+                                   uint64_t process_row, Save&& save) {
+        eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+
+        // init num_transactions
+        if (parsing_progress.parsed_position == 0) {
+            parsing_progress.num_transactions = bitcoin::varint::decode(block_stream);
+        }
+
+        if (process_row == 0)
+            process_row = -1;
+
+        uint64_t parsed_position = 0;
+        const std::vector<uint8_t> script_data = {};
+        auto pending_transactions = parsing_progress.num_transactions - parsing_progress.parsed_transactions;
+        while (pending_transactions-- && process_row) {
+            bitcoin::core::transaction transaction(&block_data);
+            block_stream >> transaction;
+            auto txid = transaction.txid();
+
+            // save vin
+            for (; parsing_progress.parsed_vin < transaction.inputs.size() && process_row;
+                 parsing_progress.parsed_vin++, process_row--) {
+                const auto& vin = transaction.inputs[parsing_progress.parsed_vin];
+                if (transaction.is_coinbase())
+                    continue;
+
+                save(bitcoin::be_checksum256_from_uint(vin.previous_output_hash), vin.previous_output_index,
+                     script_data, 0, "vin"_n);
+                parsing_progress.num_utxos++;
+            }
+
+            // save vout
+            for (; parsing_progress.parsed_vout < transaction.outputs.size() && process_row;
+                 parsing_progress.parsed_vout++, process_row--) {
+                const auto& vout = transaction.outputs[parsing_progress.parsed_vout];
+
+                if (xsat::utils::is_unspendable_legacy(vout.script.data))
+                    continue;
+                save(txid, parsing_progress.parsed_vout, vout.script.data, vout.value, "vout"_n);
+                parsing_progress.num_utxos++;
+            }
+
+            // next transaction
+            if (parsing_progress.parsed_vin == transaction.inputs.size()
+                && parsing_progress.parsed_vout == transaction.outputs.size()) {
+                parsed_position = block_stream.tellp();
+                parsing_progress.parsed_vin = 0;
+                parsing_progress.parsed_vout = 0;
+                parsing_progress.parsed_transactions++;
+            }
+        }
+        parsing_progress.parsed_position += parsed_position;
+    }
+
+    // ids of the utxo tables start at 1
+    template <typename Table>
+    static uint64_t next_utxo_id(Table& table) {
+        auto id = table.available_primary_key();
+        if (id == 0) {
+            id = 1;
+        }
+        return id;
+    }
+
+    // adds an output to the `pendingutxos` of the block at `height`
+    template <typename Table>
+    static void save_pending_utxo(Table& _pending_utxo, const name& payer, const uint64_t height,
+                                  const checksum256& hash, const checksum256& txid, const uint32_t index,
+                                  const std::vector<uint8_t>& script_data, const uint64_t value, const name& type) {
+        auto id = next_utxo_id(_pending_utxo);
+        _pending_utxo.emplace(payer, [&](auto& row) {
+            row.id = id;
+            row.height = height;
+            row.hash = hash;
+            row.txid = txid;
+            row.index = index;
+            row.scriptpubkey = script_data;
+            row.value = value;
+            row.type = type;
+        });
+    }
+
+    // adds an output to the `utxos` set
+    template <typename Table>
+    static auto save_utxo(Table& _utxo, const name& payer, const checksum256& txid, const uint32_t index,
+                          const std::vector<uint8_t>& script_data, const uint64_t value) {
+        auto id = next_utxo_id(_utxo);
+        auto utxo_itr = _utxo.emplace(payer, [&](auto& row) {
+            row.id = id;
+            row.txid = txid;
+            row.index = index;
+            row.scriptpubkey = script_data;
+            row.value = value;
+        });
+        return *utxo_itr;
+    }
+
+    // removes an output from the `utxos` set through its `byutxoid` index, `nullopt` if it is not in the set
+    template <typename Index>
+    static auto remove_utxo(Index& utxo_idx, const checksum256& prev_txid, const uint32_t prev_index)
+        -> optional<std::decay_t<decltype(*utxo_idx.begin())>> {
+        auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(prev_txid, prev_index));
+        if (utxo_itr == utxo_idx.end()) {
+            return std::nullopt;
+        }
+        auto found_utxo = *utxo_itr;
+        utxo_idx.erase(utxo_itr);
+        return found_utxo;
+    }
+}  // namespace xsat::parsing
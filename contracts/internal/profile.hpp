@@ -0,0 +1,339 @@
+#pragma once
+
+// Operation counters for `-DPROFILE` builds.
+//
+// Contracts read and write their tables through `xsat::profile::multi_index` and `xsat::profile::singleton`, send
+// inline actions with `xsat::profile::send`, hash with `xsat::profile::sha256` and access raw rows with the
+// `xsat::profile::db_*_i64` functions. In other builds these are the eosio types and functions themselves. In
+// `-DPROFILE` builds they count the operations of the current action:
+//
+// - every lookup is one read (`find`, `require_find`, `get`, `lower_bound`, `upper_bound`, `begin`,
+//   `available_primary_key` and the raw reads), iterator moves are not counted
+// - an emplace or erase writes the row and one entry per secondary index, a modify writes the row and the entries of
+//   the secondary keys it changes
+// - a singleton `set` or `remove` reads the row and writes it
+//
+// `external/bitcoin` counts its sha256 digests and transaction deserializations in `bitcoin::profile`, which is added
+// to the counters when they are saved. A contract holding a `recorder` member writes the counters to its `profile`
+// table when the action returns, so tests can assert operation budgets that do not depend on timing.
+
+#include <eosio/action.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/multi_index.hpp>
+#include <eosio/singleton.hpp>
+
+#ifdef PROFILE
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <bitcoin/utility/crypto.hpp>
+#endif
+
+using namespace eosio;
+
+namespace xsat::profile {
+
+#ifdef PROFILE
+    /**
+     * ## TABLE `profile`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} db_reads` - table lookups and raw row reads
+     * - `{uint64_t} db_writes` - rows and secondary index entries emplaced, modified, erased or stored
+     * - `{uint64_t} sha256` - sha256 digests computed
+     * - `{uint64_t} inline_sends` - inline actions sent
+     * - `{uint64_t} deserializations` - bitcoin transactions deserialized
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "db_reads": 6,
+     *   "db_writes": 3,
+     *   "sha256": 1,
+     *   "inline_sends": 1,
+     *   "deserializations": 0
+     * }
+     * ```
+     */
+    struct [[eosio::table]] profile_row {
+        uint64_t db_reads = 0;
+        uint64_t db_writes = 0;
+        uint64_t sha256 = 0;
+        uint64_t inline_sends = 0;
+        uint64_t deserializations = 0;
+    };
+    typedef eosio::singleton<"profile"_n, profile_row> profile_table;
+
+    // counters of the current action, contract memory is reset before every action
+    static profile_row& counters() {
+        static profile_row current;
+        return current;
+    }
+
+    // saves the counters of the action when the contract is destroyed after dispatch
+    struct recorder {
+        name self;
+
+        ~recorder() {
+            auto row = counters();
+            row.sha256 += bitcoin::profile::sha256;
+            row.deserializations += bitcoin::profile::deserializations;
+            profile_table(self, self.value).set(row, self);
+        }
+    };
+
+#define PROFILE_COUNT(counter, n) (xsat::profile::counters().counter += (n))
+
+    template <name::raw TableName, typename T, typename... Indices>
+    class multi_index : public eosio::multi_index<TableName, T, Indices...> {
+        using base = eosio::multi_index<TableName, T, Indices...>;
+
+        template <typename Index>
+        using key_type = std::decay_t<decltype(typename Index::secondary_extractor_type{}(std::declval<const T&>()))>;
+
+        using keys_type = std::tuple<key_type<Indices>...>;
+
+        // secondary keys of `row`, the digests of key extractors are not part of the action's work
+        static keys_type secondary_keys(const T& row) {
+            const auto sha256 = counters().sha256;
+            keys_type keys = {typename Indices::secondary_extractor_type{}(row)...};
+            counters().sha256 = sha256;
+            return keys;
+        }
+
+        template <size_t... I>
+        static uint64_t num_changed(const keys_type& before, const keys_type& after, std::index_sequence<I...>) {
+            return (0 + ... + (std::get<I>(before) == std::get<I>(after) ? 0 : 1));
+        }
+
+       public:
+        using typename base::const_iterator;
+
+        // secondary index counting its lookups, writes go through the counting table
+        template <typename Index>
+        class index : public Index {
+            multi_index* _table;
+
+           public:
+            index(const Index& idx, multi_index* table) : Index(idx), _table(table) {}
+
+            auto begin() const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::begin();
+            }
+
+            template <typename Key>
+            auto find(const Key& key) const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::find(key);
+            }
+
+            template <typename Key>
+            auto require_find(const Key& key, const char* error_msg = "unable to find secondary key") const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::require_find(key, error_msg);
+            }
+
+            template <typename Key>
+            const T& get(const Key& key, const char* error_msg = "unable to find secondary key") const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::get(key, error_msg);
+            }
+
+            template <typename Key>
+            auto lower_bound(const Key& key) const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::lower_bound(key);
+            }
+
+            template <typename Key>
+            auto upper_bound(const Key& key) const {
+                PROFILE_COUNT(db_reads, 1);
+                return Index::upper_bound(key);
+            }
+
+            template <typename Lambda>
+            void modify(const typename Index::const_iterator& itr, const name& payer, Lambda&& updater) {
+                _table->modify(*itr, payer, std::forward<Lambda>(updater));
+            }
+
+            typename Index::const_iterator erase(typename Index::const_iterator itr) {
+                const auto& row = *itr;
+                ++itr;
+                _table->erase(row);
+                return itr;
+            }
+        };
+
+        using base::base;
+
+        const_iterator begin() const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::begin();
+        }
+
+        const_iterator find(const uint64_t primary) const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::find(primary);
+        }
+
+        const_iterator require_find(const uint64_t primary, const char* error_msg = "unable to find key") const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::require_find(primary, error_msg);
+        }
+
+        const T& get(const uint64_t primary, const char* error_msg = "unable to find key") const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::get(primary, error_msg);
+        }
+
+        const_iterator lower_bound(const uint64_t primary) const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::lower_bound(primary);
+        }
+
+        const_iterator upper_bound(const uint64_t primary) const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::upper_bound(primary);
+        }
+
+        uint64_t available_primary_key() const {
+            PROFILE_COUNT(db_reads, 1);
+            return base::available_primary_key();
+        }
+
+        template <name::raw IndexName>
+        auto get_index() {
+            auto idx = base::template get_index<IndexName>();
+            return index<decltype(idx)>(idx, this);
+        }
+
+        template <typename Lambda>
+        const_iterator emplace(const name& payer, Lambda&& constructor) {
+            PROFILE_COUNT(db_writes, 1 + sizeof...(Indices));
+            return base::emplace(payer, std::forward<Lambda>(constructor));
+        }
+
+        template <typename Lambda>
+        void modify(const const_iterator& itr, const name& payer, Lambda&& updater) {
+            modify(*itr, payer, std::forward<Lambda>(updater));
+        }
+
+        template <typename Lambda>
+        void modify(const T& obj, const name& payer, Lambda&& updater) {
+            const auto before = secondary_keys(obj);
+            base::modify(obj, payer, std::forward<Lambda>(updater));
+            const auto changed = num_changed(before, secondary_keys(obj), std::index_sequence_for<Indices...>{});
+            PROFILE_COUNT(db_writes, 1 + changed);
+        }
+
+        const_iterator erase(const_iterator itr) {
+            PROFILE_COUNT(db_writes, 1 + sizeof...(Indices));
+            return base::erase(itr);
+        }
+
+        void erase(const T& obj) {
+            PROFILE_COUNT(db_writes, 1 + sizeof...(Indices));
+            base::erase(obj);
+        }
+    };
+
+    template <name::raw SingletonName, typename T>
+    class singleton : public eosio::singleton<SingletonName, T> {
+        using base = eosio::singleton<SingletonName, T>;
+
+       public:
+        using base::base;
+
+        bool exists() {
+            PROFILE_COUNT(db_reads, 1);
+            return base::exists();
+        }
+
+        T get() {
+            PROFILE_COUNT(db_reads, 1);
+            return base::get();
+        }
+
+        T get_or_default(const T& def = T()) {
+            PROFILE_COUNT(db_reads, 1);
+            return base::get_or_default(def);
+        }
+
+        void set(const T& value, const name& bill_to_account) {
+            PROFILE_COUNT(db_reads, 1);
+            PROFILE_COUNT(db_writes, 1);
+            base::set(value, bill_to_account);
+        }
+
+        void remove() {
+            PROFILE_COUNT(db_reads, 1);
+            PROFILE_COUNT(db_writes, 1);
+            base::remove();
+        }
+    };
+#else
+#define PROFILE_COUNT(counter, n) ((void)0)
+
+    template <name::raw TableName, typename T, typename... Indices>
+    using multi_index = eosio::multi_index<TableName, T, Indices...>;
+
+    template <name::raw SingletonName, typename T>
+    using singleton = eosio::singleton<SingletonName, T>;
+#endif
+
+    template <typename Action, typename... Args>
+    inline void send(const name& code, const permission_level& auth, Args&&... args) {
+        PROFILE_COUNT(inline_sends, 1);
+        Action(code, auth).send(std::forward<Args>(args)...);
+    }
+
+    inline checksum256 sha256(const char* data, const uint32_t length) {
+        PROFILE_COUNT(sha256, 1);
+        return eosio::sha256(data, length);
+    }
+
+    // raw rows, e.g. the `block.chunk` data of blksync.xsat
+    inline int32_t db_find_i64(const uint64_t code, const uint64_t scope, const uint64_t table, const uint64_t id) {
+        PROFILE_COUNT(db_reads, 1);
+        return eosio::internal_use_do_not_use::db_find_i64(code, scope, table, id);
+    }
+
+    inline int32_t db_lowerbound_i64(const uint64_t code, const uint64_t scope, const uint64_t table,
+                                     const uint64_t id) {
+        PROFILE_COUNT(db_reads, 1);
+        return eosio::internal_use_do_not_use::db_lowerbound_i64(code, scope, table, id);
+    }
+
+    inline int32_t db_next_i64(const int32_t iterator, uint64_t* primary) {
+        PROFILE_COUNT(db_reads, 1);
+        return eosio::internal_use_do_not_use::db_next_i64(iterator, primary);
+    }
+
+    inline int32_t db_get_i64(const int32_t iterator, const void* data, const uint32_t length) {
+        PROFILE_COUNT(db_reads, 1);
+        return eosio::internal_use_do_not_use::db_get_i64(iterator, data, length);
+    }
+
+    inline int32_t db_store_i64(const uint64_t scope, const uint64_t table, const uint64_t payer, const uint64_t id,
+                                const void* data, const uint32_t length) {
+        PROFILE_COUNT(db_writes, 1);
+        return eosio::internal_use_do_not_use::db_store_i64(scope, table, payer, id, data, length);
+    }
+
+    inline void db_update_i64(const int32_t iterator, const uint64_t payer, const void* data, const uint32_t length) {
+        PROFILE_COUNT(db_writes, 1);
+        eosio::internal_use_do_not_use::db_update_i64(iterator, payer, data, length);
+    }
+
+    inline void db_remove_i64(const int32_t iterator) {
+        PROFILE_COUNT(db_writes, 1);
+        eosio::internal_use_do_not_use::db_remove_i64(iterator);
+    }
+
+#undef PROFILE_COUNT
+}  // namespace xsat::profile
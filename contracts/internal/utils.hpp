@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include "defines.hpp"
+#include "profile.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -25,28 +26,70 @@ namespace xsat::utils {
     }
 
     static checksum256 compute_block_id(const uint64_t height, const checksum256& hash) {
-        vector<char> result;
-        result.resize(40);
+        array<char, 40> result;
         datastream<char*> ds(result.data(), result.size());
         ds << height;
         ds << hash;
-        return sha256((char*)result.data(), result.size());
+        return xsat::profile::sha256((char*)result.data(), result.size());
     }
 
     static checksum256 compute_utxo_id(const checksum256 &tx_id, const uint32_t index) {
-        std::vector<char> result;
-        result.resize(36);
+        std::array<char, 36> result;
         eosio::datastream<char *> ds(result.data(), result.size());
         ds << tx_id;
         ds << index;
-        return eosio::sha256((char *)result.data(), result.size());
+        return xsat::profile::sha256((char *)result.data(), result.size());
     }
 
-    static checksum256 hash(const string& data) { return sha256(data.c_str(), data.size()); }
+    // element of the UTXO set commitment
+    static checksum256 compute_utxo_hash(const checksum256& txid, const uint32_t index, const uint64_t value,
+                                         const vector<uint8_t>& scriptpubkey) {
+        vector<char> result;
+        result.resize(44 + pack_size(scriptpubkey));
+        datastream<char*> ds(result.data(), result.size());
+        ds << txid;
+        ds << index;
+        ds << value;
+        ds << scriptpubkey;
+        return xsat::profile::sha256(result.data(), result.size());
+    }
+
+    static checksum256 mmr_merge(const checksum256& left, const checksum256& right) {
+        array<char, 64> result;
+        datastream<char*> ds(result.data(), result.size());
+        ds << left;
+        ds << right;
+        return xsat::profile::sha256(result.data(), result.size());
+    }
+
+    // appends a leaf to a Merkle Mountain Range whose peaks are ordered from the highest to the lowest
+    static void mmr_append(vector<checksum256>& peaks, uint64_t num_leaves, checksum256 node) {
+        while (num_leaves & 1) {
+            node = mmr_merge(peaks.back(), node);
+            peaks.pop_back();
+            num_leaves >>= 1;
+        }
+        peaks.push_back(node);
+    }
+
+    // bags the peaks from the lowest to the highest
+    static checksum256 mmr_root(const vector<checksum256>& peaks) {
+        if (peaks.empty()) return checksum256();
+
+        auto root = peaks.back();
+        for (auto i = peaks.size() - 1; i > 0; i--) {
+            root = mmr_merge(peaks[i - 1], root);
+        }
+        return root;
+    }
+
+    static checksum256 hash(const string& data) { return xsat::profile::sha256(data.c_str(), data.size()); }
 
     static checksum160 hash_ripemd160(const string& data) { return ripemd160(data.c_str(), data.size()); }
 
-    static checksum256 hash(const vector<uint8_t>& data) { return sha256((char*)data.data(), data.size()); }
+    static checksum256 hash(const vector<uint8_t>& data) {
+        return xsat::profile::sha256((char*)data.data(), data.size());
+    }
 
     static name parse_name(const string& str) {
         if (str.length() == 0 || str.length() > 13) return {};
@@ -221,7 +264,7 @@ namespace xsat::utils {
         char buf[size];
         uint32_t read = read_transaction(buf, size);
         check(size == read, "read_transaction failed");
-        return sha256(buf, read);
+        return xsat::profile::sha256(buf, read);
     }
 
     static string to_hex(const char* d, uint32_t s) {
@@ -3,6 +3,7 @@
 #include <btc.xsat/btc.xsat.hpp>
 #include <bitcoin/script/address.hpp>
 #include "../internal/defines.hpp"
+#include "../internal/events.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -65,12 +66,13 @@ void pool::updateheight(const name& synchronizer, const uint64_t latest_produced
     save_miners(synchronizer, miners);
 
     // log
-    pool::poollog_action _poollog(get_self(), {get_self(), "active"_n});
 
     if (synchronizer_itr->reward_recipient == ERC20_CONTRACT) {
-        _poollog.send(synchronizer, latest_produced_block_height, synchronizer_itr->memo);
+        xsat::events::emit<pool::poollog_action>(get_self(), synchronizer, latest_produced_block_height,
+                                                 synchronizer_itr->memo);
     } else {
-        _poollog.send(synchronizer, latest_produced_block_height, synchronizer_itr->reward_recipient.to_string());
+        xsat::events::emit<pool::poollog_action>(get_self(), synchronizer, latest_produced_block_height,
+                                                 synchronizer_itr->reward_recipient.to_string());
     }
 }
 
@@ -129,8 +131,7 @@ void pool::initpool(const name& synchronizer, const uint64_t latest_produced_blo
     save_miners(synchronizer, miners);
 
     // log
-    pool::poollog_action _poollog(get_self(), {get_self(), "active"_n});
-    _poollog.send(synchronizer, latest_produced_block_height, financial_account);
+    xsat::events::emit<pool::poollog_action>(get_self(), synchronizer, latest_produced_block_height, financial_account);
 }
 
 //@auth get_self()
@@ -153,8 +154,7 @@ void pool::delpool(const name& synchronizer) {
     }
 
     // log
-    pool::delpoollog_action _delpoollog(get_self(), {get_self(), "active"_n});
-    _delpoollog.send(synchronizer);
+    xsat::events::emit<pool::delpoollog_action>(get_self(), synchronizer);
 }
 
 //@auth get_self()
@@ -206,12 +206,14 @@ void pool::setfinacct(const name& synchronizer, const string& financial_account)
     });
 
     // log
-    pool::poollog_action _poollog(get_self(), {get_self(), "active"_n});
     if (synchronizer_itr->reward_recipient == ERC20_CONTRACT) {
-        _poollog.send(synchronizer, synchronizer_itr->latest_produced_block_height, synchronizer_itr->memo);
+        xsat::events::emit<pool::poollog_action>(get_self(), synchronizer,
+                                                 synchronizer_itr->latest_produced_block_height,
+                                                 synchronizer_itr->memo);
     } else {
-        _poollog.send(synchronizer, synchronizer_itr->latest_produced_block_height,
-                      synchronizer_itr->reward_recipient.to_string());
+        xsat::events::emit<pool::poollog_action>(get_self(), synchronizer,
+                                                 synchronizer_itr->latest_produced_block_height,
+                                                 synchronizer_itr->reward_recipient.to_string());
     }
 }
 
@@ -230,8 +232,7 @@ void pool::setdonate(const name& synchronizer, const uint16_t donate_rate) {
     });
 
     // log
-    pool::setdonatelog_action _setdonatelog(get_self(), {get_self(), "active"_n});
-    _setdonatelog.send(synchronizer, donate_rate);
+    xsat::events::emit<pool::setdonatelog_action>(get_self(), synchronizer, donate_rate);
 }
 
 //@auth synchronizer->reward_recipient or evmutil.xsat
@@ -262,28 +263,33 @@ void pool::claim(const name& synchronizer) {
         row.total_donated += donated_amount;
     });
 
-    // transfer donate
+    // donate
+    vector<btc::recipient> recipients;
     if (donated_amount.amount > 0) {
-        token_transfer(get_self(), config.donation_account, extended_asset{donated_amount, EXSAT_CONTRACT});
+        if (config.donation_account.size() <= 12) {
+            recipients.push_back({name(config.donation_account), donated_amount, ""});
+        } else {
+            recipients.push_back({ERC20_CONTRACT, donated_amount, config.donation_account});
+        }
 
         auto stat = _stat.get_or_default();
         stat.xsat_total_donated += donated_amount;
         _stat.set(stat, get_self());
     }
 
-    // transfer reward
+    // reward
     if (to_synchronizer.amount > 0) {
-        token_transfer(get_self(), synchronizer_itr->reward_recipient, extended_asset{to_synchronizer, EXSAT_CONTRACT},
-                       synchronizer_itr->memo);
+        recipients.push_back({synchronizer_itr->reward_recipient, to_synchronizer, synchronizer_itr->memo});
     }
+    btc::send_payments(EXSAT_CONTRACT, get_self(), recipients);
 
     // log
 
     string reward_recipient = synchronizer_itr->reward_recipient == ERC20_CONTRACT
                                   ? synchronizer_itr->memo
                                   : synchronizer_itr->reward_recipient.to_string();
-    pool::claimlog_action _claimlog(get_self(), {get_self(), "active"_n});
-    _claimlog.send(synchronizer, reward_recipient, claimable, donated_amount, synchronizer_itr->total_donated);
+    xsat::events::emit<pool::claimlog_action>(get_self(), synchronizer, reward_recipient, claimable, donated_amount,
+                                              synchronizer_itr->total_donated);
 }
 
 //@auth synchronizer
@@ -346,19 +352,3 @@ void pool::save_miners(const name& synchronizer, const vector<string>& miners) {
         }
     }
 }
-
-void pool::token_transfer(const name& from, const string& to, const extended_asset& value) {
-    btc::transfer_action transfer(value.contract, {from, "active"_n});
-
-    bool is_eos_account = to.size() <= 12;
-    if (is_eos_account) {
-        transfer.send(from, name(to), value.quantity, "");
-    } else {
-        transfer.send(from, ERC20_CONTRACT, value.quantity, to);
-    }
-}
-
-void pool::token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo) {
-    btc::transfer_action transfer(value.contract, {from, "active"_n});
-    transfer.send(from, to, value.quantity, memo);
-}
@@ -5,6 +5,7 @@
 #include <eosio/singleton.hpp>
 #include <eosio/binary_extension.hpp>
 #include <eosio/asset.hpp>
+#include <btc.xsat/btc.xsat.hpp>
 #include "../internal/utils.hpp"
 
 using namespace eosio;
@@ -411,10 +412,6 @@ class [[eosio::contract("poolreg.xsat")]] pool : public contract {
 
     void save_miners(const name& synchronizer, const vector<string>& miners);
 
-    void token_transfer(const name& from, const string& to, const extended_asset& value);
-
-    void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
-
 #ifdef DEBUG
     template <typename T>
     void clear_table(T& table, uint64_t rows_to_clear);
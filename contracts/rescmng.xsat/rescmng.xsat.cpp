@@ -4,6 +4,7 @@
 #include <rescmng.xsat/rescmng.xsat.hpp>
 
 #include "../internal/utils.hpp"
+#include "../internal/events.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -55,7 +56,7 @@ resource_management::CheckResult resource_management::checkclient(const name& cl
         });
     }
 
-    // log
+    // log, sent inline because the return value of `checkclient` is the check result
     resource_management::checklog_action _checklog(get_self(), {get_self(), "active"_n});
     _checklog.send(client, type, success, result);
 
@@ -118,8 +119,7 @@ void resource_management::pay(const uint64_t height, const checksum256& hash, co
     }
 
     // log
-    resource_management::paylog_action _paylog(get_self(), {get_self(), "active"_n});
-    _paylog.send(height, hash, owner, type, fee_amount);
+    xsat::events::emit<resource_management::paylog_action>(get_self(), height, hash, owner, type, fee_amount);
 }
 
 //@auth owner
@@ -143,8 +143,7 @@ void resource_management::withdraw(const name& owner, const asset& quantity) {
     token_transfer(get_self(), owner, {quantity, BTC_CONTRACT}, "withdraw");
 
     // log
-    resource_management::withdrawlog_action _withdrawlog(get_self(), {get_self(), "active"_n});
-    _withdrawlog.send(owner, quantity, balance);
+    xsat::events::emit<resource_management::withdrawlog_action>(get_self(), owner, quantity, balance);
 }
 
 [[eosio::on_notify("*::transfer")]]
@@ -173,8 +172,7 @@ void resource_management::do_deposit(const name& from, const name& contract, con
     }
 
     // log
-    resource_management::depositlog_action _depositlog(get_self(), {get_self(), "active"_n});
-    _depositlog.send(from, quantity, account_itr->balance);
+    xsat::events::emit<resource_management::depositlog_action>(get_self(), from, quantity, account_itr->balance);
 }
 
 asset resource_management::get_fee(const fee_type type, const uint64_t quantity) {
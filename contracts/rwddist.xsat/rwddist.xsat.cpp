@@ -2,6 +2,7 @@
 #include <exsat.xsat/exsat.xsat.hpp>
 #include <blkendt.xsat/blkendt.xsat.hpp>
 #include <utxomng.xsat/utxomng.xsat.hpp>
+#include "../internal/events.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -53,23 +54,33 @@ void reward_distribution::distribute(const uint64_t height) {
     block_endorse::endorsement_table _endorsement(BLOCK_ENDORSE_CONTRACT, height);
     auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
     auto endorsement_itr = endorsement_idx.find(hash);
-    auto num_reached_consensus = endorsement_itr->num_reached_consensus();
-    auto num_validators = endorsement_itr->num_validators();
+    auto num_validators = endorsement_itr->num_validators;
 
+    // The validators that reached consensus are listed first, they share the consensus rewards
     uint64_t endorsed_staking = 0;
     uint64_t reached_consensus_staking = 0;
     vector<validator_info> provider_validators;
-    provider_validators.reserve(endorsement_itr->provider_validators.size());
-    for (size_t i = 0; i < endorsement_itr->provider_validators.size(); ++i) {
-        const auto validator = endorsement_itr->provider_validators[i];
-        provider_validators.emplace_back(validator_info{
-            .account = validator.account, .staking = validator.staking, .created_at = validator.created_at});
-
+    vector<validator_info> late_provider_validators;
+    provider_validators.reserve(endorsement_itr->num_endorsed());
+    block_endorse::validator_member_table _validator_member(BLOCK_ENDORSE_CONTRACT,
+                                                            endorsement_itr->validator_set_id);
+    auto validator_member_idx = _validator_member.get_index<"byindex"_n>();
+    for (auto member_itr = validator_member_idx.begin(); member_itr != validator_member_idx.end(); member_itr++) {
+        if (!endorsement_itr->is_endorsed(member_itr->index)) {
+            continue;
+        }
+        const validator_info validator{
+            .account = member_itr->account, .staking = member_itr->staking, .created_at = endorsement_itr->created_at};
         endorsed_staking += validator.staking;
-        if (i < num_reached_consensus) {
+        if (endorsement_itr->is_consensus_provider(member_itr->index)) {
             reached_consensus_staking += validator.staking;
+            provider_validators.push_back(validator);
+        } else {
+            late_provider_validators.push_back(validator);
         }
     }
+    provider_validators.insert(provider_validators.end(), late_provider_validators.begin(),
+                               late_provider_validators.end());
 
     reward_log_itr = _reward_log.emplace(get_self(), [&](auto& row) {
         row.height = height;
@@ -91,7 +102,37 @@ void reward_distribution::distribute(const uint64_t height) {
     reward_balance.synchronizer_rewards_unclaimed = reward_log_itr->synchronizer_rewards;
     reward_balance.consensus_rewards_unclaimed = reward_log_itr->consensus_rewards;
     reward_balance.staking_rewards_unclaimed = reward_log_itr->staking_rewards;
+
+    auto config = _config.get_or_default();
+    bool fully_assigned = true;
+    if (config.num_blocks_per_settlement > 0) {
+        // The first `num_validators_per_distribution` validators are allocated at once, utxomng.xsat allocates the
+        // rest through `endtreward`, validators are paid when the accumulated rewards are settled
+        utxo_manage::config_table _utxo_manage_config(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        const uint32_t num_provider_validators = reward_log_itr->provider_validators.size();
+        const uint32_t to_index = std::min<uint32_t>(
+            num_provider_validators, _utxo_manage_config.get_or_default().num_validators_per_distribution);
+        accumulate_rewards(height, allocate_rewards(*reward_log_itr, 0, to_index, reward_balance));
+        fully_assigned = to_index == num_provider_validators;
+        if (fully_assigned) {
+            send_synchronizer_rewards(*reward_log_itr);
+            reward_balance.synchronizer_rewards_unclaimed.amount = 0;
+        }
+
+        _reward_log.modify(reward_log_itr, same_payer, [&](auto& row) {
+            row.num_validators_assigned = to_index;
+            row.latest_exec_time = current_time_point();
+#ifndef UNITTEST
+            row.tx_id = xsat::utils::get_trx_id();
+#endif
+        });
+    }
     _reward_balance.set(reward_balance, get_self());
+
+    // Also flushes what is left over after switching back to settling every block
+    if (fully_assigned) {
+        settle_due_rewards(config);
+    }
 }
 
 [[eosio::action]]
@@ -107,15 +148,73 @@ void reward_distribution::endtreward(const uint64_t height, uint32_t from_index,
     check(to_index > from_index && to_index <= reward_log_itr->provider_validators.size(),
           "rwddist.xsat::endtreward: invalid to_index");
 
-    auto num_reached_consensus = xsat::utils::num_reached_consensus(reward_log_itr->num_validators);
+    auto reward_balance = _reward_balance.get_or_default();
+    auto reward_details = allocate_rewards(*reward_log_itr, from_index, to_index, reward_balance);
+
+    // The block started accumulating in `distribute`, keep accumulating the remaining validators
+    const auto accumulation = _accumulation.get_or_default();
+    const bool accumulating = accumulation.num_blocks > 0 && accumulation.latest_height == height;
+    if (accumulating) {
+        accumulate_rewards(height, reward_details);
+    } else {
+        asset total_rewards = {0, reward_log_itr->staking_rewards.symbol};
+        for (const auto& reward : reward_details) {
+            total_rewards.amount += reward.staking_rewards.amount + reward.consensus_rewards.amount;
+        }
+
+        // transfer to endrmng.xsat
+        token_transfer(get_self(), ENDORSER_MANAGE_CONTRACT, {total_rewards, EXSAT_CONTRACT}, "consensus rewards");
+
+        // distribute
+        endorse_manage::distribute_action _distribute(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _distribute.send(height, reward_details);
+
+        // log
+        xsat::events::emit_inline<reward_distribution::endtrwdlog_action>(get_self(), height, reward_log_itr->hash,
+                                                                          reward_details);
+    }
+
+    const bool fully_assigned = to_index == reward_log_itr->provider_validators.size();
+    if (fully_assigned) {
+        send_synchronizer_rewards(*reward_log_itr);
+        reward_balance.synchronizer_rewards_unclaimed.amount = 0;
+    }
+
+    _reward_balance.set(reward_balance, get_self());
+
+    _reward_log.modify(reward_log_itr, same_payer, [&](auto& row) {
+        row.num_validators_assigned = to_index;
+        row.latest_exec_time = current_time_point();
+#ifndef UNITTEST
+        row.tx_id = xsat::utils::get_trx_id();
+#endif
+    });
+
+    if (accumulating && fully_assigned) {
+        settle_due_rewards(_config.get_or_default());
+    }
+}
+
+//@auth get_self()
+[[eosio::action]]
+void reward_distribution::config(const uint16_t num_blocks_per_settlement) {
+    require_auth(get_self());
+
+    auto config = _config.get_or_default();
+    config.num_blocks_per_settlement = num_blocks_per_settlement;
+    _config.set(config, get_self());
+}
+
+vector<endorse_manage::reward_details_row> reward_distribution::allocate_rewards(const reward_log_row& reward_log,
+                                                                                 uint32_t from_index,
+                                                                                 const uint32_t to_index,
+                                                                                 reward_balance_row& reward_balance) {
+    auto num_reached_consensus = xsat::utils::num_reached_consensus(reward_log.num_validators);
 
     vector<endorse_manage::reward_details_row> reward_details;
     reward_details.reserve(to_index - from_index);
-
-    auto reward_balance = _reward_balance.get_or_default();
-    asset total_rewards = {0, reward_log_itr->staking_rewards.symbol};
     for (; from_index < to_index; from_index++) {
-        auto validator = reward_log_itr->provider_validators[from_index];
+        auto validator = reward_log.provider_validators[from_index];
         // endorse / consensus staking
         auto endorse_staking = validator.staking;
         auto consensus_staking = num_reached_consensus > from_index ? validator.staking : 0;
@@ -125,11 +224,11 @@ void reward_distribution::endtreward(const uint64_t height, uint32_t from_index,
         int64_t consensus_reward_amount = 0;
 
         // The last one to distribute the remaining rewards
-        if (from_index != reward_log_itr->provider_validators.size() - 1) {
-            staking_reward_amount = uint128_t(reward_log_itr->staking_rewards.amount) * endorse_staking
-                                    / reward_log_itr->endorsed_staking;
-            consensus_reward_amount = uint128_t(reward_log_itr->consensus_rewards.amount) * consensus_staking
-                                      / reward_log_itr->reached_consensus_staking;
+        if (from_index != reward_log.provider_validators.size() - 1) {
+            staking_reward_amount
+                = uint128_t(reward_log.staking_rewards.amount) * endorse_staking / reward_log.endorsed_staking;
+            consensus_reward_amount = uint128_t(reward_log.consensus_rewards.amount) * consensus_staking
+                                      / reward_log.reached_consensus_staking;
         } else {
             staking_reward_amount = reward_balance.staking_rewards_unclaimed.amount;
             consensus_reward_amount = reward_balance.consensus_rewards_unclaimed.amount;
@@ -137,49 +236,98 @@ void reward_distribution::endtreward(const uint64_t height, uint32_t from_index,
 
         reward_details.emplace_back(endorse_manage::reward_details_row{
             .validator = validator.account,
-            .staking_rewards = {staking_reward_amount, reward_log_itr->staking_rewards.symbol},
-            .consensus_rewards = {consensus_reward_amount, reward_log_itr->consensus_rewards.symbol}});
-
-        total_rewards.amount += staking_reward_amount + consensus_reward_amount;
+            .staking_rewards = {staking_reward_amount, reward_log.staking_rewards.symbol},
+            .consensus_rewards = {consensus_reward_amount, reward_log.consensus_rewards.symbol}});
 
         reward_balance.staking_rewards_unclaimed.amount -= staking_reward_amount;
         reward_balance.consensus_rewards_unclaimed.amount -= consensus_reward_amount;
     }
+    return reward_details;
+}
 
-    // transfer to endrmng.xsat
-    token_transfer(get_self(), ENDORSER_MANAGE_CONTRACT, {total_rewards, EXSAT_CONTRACT}, "consensus rewards");
+void reward_distribution::accumulate_rewards(const uint64_t height,
+                                             const vector<endorse_manage::reward_details_row>& reward_details) {
+    auto accumulation = _accumulation.get_or_default();
+    if (accumulation.num_blocks == 0) {
+        accumulation.start_height = height;
+    }
+    // a block allocated over several actions is counted once
+    if (accumulation.num_blocks == 0 || accumulation.latest_height != height) {
+        accumulation.latest_height = height;
+        accumulation.num_blocks++;
+    }
 
-    // distribute
-    endorse_manage::distribute_action _distribute(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
-    _distribute.send(height, reward_details);
+    for (const auto& reward : reward_details) {
+        if (reward.staking_rewards.amount == 0 && reward.consensus_rewards.amount == 0) {
+            continue;
+        }
+        accumulation.staking_rewards += reward.staking_rewards;
+        accumulation.consensus_rewards += reward.consensus_rewards;
+
+        auto accumulated_reward_itr = _accumulated_reward.find(reward.validator.value);
+        if (accumulated_reward_itr == _accumulated_reward.end()) {
+            _accumulated_reward.emplace(get_self(), [&](auto& row) {
+                row.validator = reward.validator;
+                row.staking_rewards = reward.staking_rewards;
+                row.consensus_rewards = reward.consensus_rewards;
+            });
+        } else {
+            _accumulated_reward.modify(accumulated_reward_itr, same_payer, [&](auto& row) {
+                row.staking_rewards += reward.staking_rewards;
+                row.consensus_rewards += reward.consensus_rewards;
+            });
+        }
+    }
+    _accumulation.set(accumulation, get_self());
+}
 
-    // log
-    reward_distribution::endtrwdlog_action _endtrwdlog(get_self(), {get_self(), "active"_n});
-    _endtrwdlog.send(height, reward_log_itr->hash, reward_details);
+void reward_distribution::settle_due_rewards(const config_row& config) {
+    auto accumulation = _accumulation.get_or_default();
+    if (accumulation.num_blocks > 0
+        && (config.num_blocks_per_settlement == 0 || accumulation.num_blocks >= config.num_blocks_per_settlement)) {
+        settle_rewards();
+    }
+}
 
-    if (to_index == reward_log_itr->provider_validators.size()) {
-        // transfer to poolreg.xsat
-        token_transfer(get_self(), POOL_REGISTER_CONTRACT, {reward_log_itr->synchronizer_rewards, EXSAT_CONTRACT},
-                       reward_log_itr->parser.to_string() + "," + std::to_string(height));
+void reward_distribution::settle_rewards() {
+    auto accumulation = _accumulation.get();
 
-        // log
-        reward_distribution::rewardlog_action _rewardlog(get_self(), {get_self(), "active"_n});
-        _rewardlog.send(height, reward_log_itr->hash, reward_log_itr->synchronizer, reward_log_itr->miner,
-                        reward_log_itr->parser, reward_log_itr->synchronizer_rewards, reward_log_itr->staking_rewards,
-                        reward_log_itr->consensus_rewards);
+    vector<endorse_manage::reward_details_row> reward_details;
+    auto accumulated_reward_itr = _accumulated_reward.begin();
+    while (accumulated_reward_itr != _accumulated_reward.end()) {
+        reward_details.emplace_back(endorse_manage::reward_details_row{
+            .validator = accumulated_reward_itr->validator,
+            .staking_rewards = accumulated_reward_itr->staking_rewards,
+            .consensus_rewards = accumulated_reward_itr->consensus_rewards});
+        accumulated_reward_itr = _accumulated_reward.erase(accumulated_reward_itr);
+    }
 
-        reward_balance.synchronizer_rewards_unclaimed.amount = 0;
+    auto total_rewards = accumulation.staking_rewards + accumulation.consensus_rewards;
+    if (total_rewards.amount > 0) {
+        // transfer to endrmng.xsat
+        token_transfer(get_self(), ENDORSER_MANAGE_CONTRACT, {total_rewards, EXSAT_CONTRACT}, "consensus rewards");
+
+        // distribute
+        endorse_manage::distribute_action _distribute(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _distribute.send(accumulation.latest_height, reward_details);
+
+        // log
+        xsat::events::emit_inline<reward_distribution::settlelog_action>(get_self(), accumulation.start_height,
+                                                                         accumulation.latest_height, reward_details);
     }
+    _accumulation.remove();
+}
 
-    _reward_balance.set(reward_balance, get_self());
+void reward_distribution::send_synchronizer_rewards(const reward_log_row& reward_log) {
+    // transfer to poolreg.xsat
+    token_transfer(get_self(), POOL_REGISTER_CONTRACT, {reward_log.synchronizer_rewards, EXSAT_CONTRACT},
+                   reward_log.parser.to_string() + "," + std::to_string(reward_log.height));
 
-    _reward_log.modify(reward_log_itr, same_payer, [&](auto& row) {
-        row.num_validators_assigned = to_index;
-        row.latest_exec_time = current_time_point();
-#ifndef UNITTEST
-        row.tx_id = xsat::utils::get_trx_id();
-#endif
-    });
+    // log
+    xsat::events::emit<reward_distribution::rewardlog_action>(get_self(), reward_log.height, reward_log.hash,
+                                                              reward_log.synchronizer, reward_log.miner,
+                                                              reward_log.parser, reward_log.synchronizer_rewards,
+                                                              reward_log.staking_rewards, reward_log.consensus_rewards);
 }
 
 void reward_distribution::token_transfer(const name& from, const name& to, const extended_asset& value,
@@ -145,6 +145,111 @@ class [[eosio::contract("rwddist.xsat")]] reward_distribution : public contract
     };
     typedef eosio::singleton<"rewardbal"_n, reward_balance_row> reward_balance_table;
 
+    /**
+     * ## TABLE `config`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint16_t} num_blocks_per_settlement` - the number of blocks whose validator rewards are accumulated before
+     * they are settled to `endrmng.xsat`, 0 settles every block through `endtreward`. Blocks with more validators than
+     * `utxomng.xsat`'s `num_validators_per_distribution` are still allocated in batches, `endtreward` accumulates
+     * the rest
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "num_blocks_per_settlement": 144
+     * }
+     * ```
+     */
+    struct [[eosio::table]] config_row {
+        uint16_t num_blocks_per_settlement = 0;
+    };
+    typedef eosio::singleton<"config"_n, config_row> config_table;
+
+    /**
+     * ## TABLE `accstat`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} start_height` - the first block accumulated since the last settlement
+     * - `{uint64_t} latest_height` - the latest block accumulated since the last settlement
+     * - `{uint16_t} num_blocks` - the number of blocks accumulated since the last settlement
+     * - `{asset} staking_rewards` - the accumulated staking rewards
+     * - `{asset} consensus_rewards` - the accumulated consensus rewards
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "start_height": 840000,
+     *   "latest_height": 840001,
+     *   "num_blocks": 2,
+     *   "staking_rewards": "80.00000000 XSAT",
+     *   "consensus_rewards": "10.00000000 XSAT"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] accumulation_row {
+        uint64_t start_height = 0;
+        uint64_t latest_height = 0;
+        uint16_t num_blocks = 0;
+        asset staking_rewards = {0, XSAT_SYMBOL};
+        asset consensus_rewards = {0, XSAT_SYMBOL};
+    };
+    typedef eosio::singleton<"accstat"_n, accumulation_row> accumulation_table;
+
+    /**
+     * ## TABLE `accrewards`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{asset} staking_rewards` - the staking rewards accumulated since the last settlement
+     * - `{asset} consensus_rewards` - the consensus rewards accumulated since the last settlement
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator": "alice",
+     *   "staking_rewards": "39.60000000 XSAT",
+     *   "consensus_rewards": "4.95000000 XSAT"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] accumulated_reward_row {
+        name validator;
+        asset staking_rewards;
+        asset consensus_rewards;
+        uint64_t primary_key() const { return validator.value; }
+    };
+    typedef eosio::multi_index<"accrewards"_n, accumulated_reward_row> accumulated_reward_table;
+
+    /**
+     * ## ACTION `config`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Set the number of blocks whose validator rewards are accumulated before they are settled.
+     *
+     * ### params
+     *
+     * - `{uint16_t} num_blocks_per_settlement` - 0 settles every block through `endtreward`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action rwddist.xsat config '[144]' -p rwddist.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void config(const uint16_t num_blocks_per_settlement);
+
     /**
      * ## ACTION `distribute`
      *
@@ -206,15 +311,37 @@ class [[eosio::contract("rwddist.xsat")]] reward_distribution : public contract
         require_auth(get_self());
     }
 
+    [[eosio::action]]
+    void settlelog(const uint64_t start_height, const uint64_t end_height,
+                   const vector<endorse_manage::reward_details_row>& reward_details) {
+        require_auth(get_self());
+    }
+
     using distribute_action = eosio::action_wrapper<"distribute"_n, &reward_distribution::distribute>;
     using endtreward_action = eosio::action_wrapper<"endtreward"_n, &reward_distribution::endtreward>;
     using rewardlog_action = eosio::action_wrapper<"rewardlog"_n, &reward_distribution::rewardlog>;
     using endtrwdlog_action = eosio::action_wrapper<"endtrwdlog"_n, &reward_distribution::endtrwdlog>;
+    using settlelog_action = eosio::action_wrapper<"settlelog"_n, &reward_distribution::settlelog>;
 
    private:
     // init table
     reward_log_table _reward_log = reward_log_table(_self, _self.value);
     reward_balance_table _reward_balance = reward_balance_table(_self, _self.value);
+    config_table _config = config_table(_self, _self.value);
+    accumulation_table _accumulation = accumulation_table(_self, _self.value);
+    accumulated_reward_table _accumulated_reward = accumulated_reward_table(_self, _self.value);
+
+    vector<endorse_manage::reward_details_row> allocate_rewards(const reward_log_row& reward_log, uint32_t from_index,
+                                                                const uint32_t to_index,
+                                                                reward_balance_row& reward_balance);
+
+    void accumulate_rewards(const uint64_t height, const vector<endorse_manage::reward_details_row>& reward_details);
+
+    void settle_due_rewards(const config_row& config);
+
+    void settle_rewards();
+
+    void send_synchronizer_rewards(const reward_log_row& reward_log);
 
     void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
 
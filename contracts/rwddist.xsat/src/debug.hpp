@@ -20,6 +20,12 @@ void reward_distribution::cleartable(const name table_name, const optional<name>
         clear_table(_reward_log, rows_to_clear);
     else if (table_name == "rewardbal"_n)
         _reward_balance.remove();
+    else if (table_name == "config"_n)
+        _config.remove();
+    else if (table_name == "accstat"_n)
+        _accumulation.remove();
+    else if (table_name == "accrewards"_n)
+        clear_table(_accumulated_reward, rows_to_clear);
     else
         check(false, "rwddist.xsat::cleartable: [table_name] unknown table to clear");
 }
@@ -15,6 +15,7 @@ void stake::cleartable(const name table_name, const optional<name> scope, const
     // tables
     stake::release_table _release(get_self(), value);
     stake::staking_table _staking(get_self(), value);
+    stake::withdrawable_table _withdrawable(get_self(), value);
 
     if (table_name == "globalid"_n)
         _global_id.remove();
@@ -24,6 +25,8 @@ void stake::cleartable(const name table_name, const optional<name> scope, const
         clear_table(_staking, rows_to_clear);
     else if (table_name == "releases"_n)
         clear_table(_release, rows_to_clear);
+    else if (table_name == "withdrawable"_n)
+        clear_table(_withdrawable, rows_to_clear);
     else
         check(false, "staking.xsat::cleartable: [table_name] unknown table to clear");
 }
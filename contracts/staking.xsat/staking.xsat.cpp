@@ -55,18 +55,17 @@ void stake::setstatus(const uint64_t id, const bool disabled_staking) {
 void stake::withdraw(const name& staker) {
     require_auth(staker);
 
-    time_point_sec now_time = current_time_point();
-    auto _release = release_table(get_self(), staker.value);
-    auto release_idx = _release.get_index<"byexpire"_n>();
-    auto release_itr = release_idx.lower_bound(0);
-    auto end_release_itr = release_idx.upper_bound(now_time.sec_since_epoch());
+    collect_expired_releases(staker);
 
-    check(release_itr != end_release_itr, "staking.xsat::withdraw: there is no expired token that can be withdrawn");
+    auto _withdrawable = withdrawable_table(get_self(), staker.value);
+    auto withdrawable_itr = _withdrawable.begin();
+    check(withdrawable_itr != _withdrawable.end(),
+          "staking.xsat::withdraw: there is no expired token that can be withdrawn");
 
-    auto max_row = 100;
-    while (release_itr != end_release_itr && max_row--) {
-        token_transfer(get_self(), staker, release_itr->quantity, "release");
-        release_itr = release_idx.erase(release_itr);
+    // one transfer per token
+    while (withdrawable_itr != _withdrawable.end()) {
+        token_transfer(get_self(), staker, withdrawable_itr->quantity, "release");
+        withdrawable_itr = _withdrawable.erase(withdrawable_itr);
     }
 }
 
@@ -85,6 +84,9 @@ void stake::release(const uint64_t staking_id, const name& staker, const name& v
         row.quantity.quantity -= quantity;
     });
 
+    // move releases that have already expired out of the way
+    collect_expired_releases(staker);
+
     // save release
     auto _release = release_table(get_self(), staker.value);
     auto id = next_release_id();
@@ -144,6 +146,35 @@ void stake::token_transfer(const name& from, const name& to, const extended_asse
     transfer.send(from, to, value.quantity, memo);
 }
 
+void stake::collect_expired_releases(const name& staker) {
+    time_point_sec now_time = current_time_point();
+    auto _release = release_table(get_self(), staker.value);
+    auto release_idx = _release.get_index<"byexpire"_n>();
+    auto release_itr = release_idx.lower_bound(0);
+    auto end_release_itr = release_idx.upper_bound(now_time.sec_since_epoch());
+    if (release_itr == end_release_itr) return;
+
+    auto _withdrawable = withdrawable_table(get_self(), staker.value);
+    auto withdrawable_idx = _withdrawable.get_index<"bytoken"_n>();
+    auto max_row = 100;
+    while (release_itr != end_release_itr && max_row--) {
+        auto token_id = xsat::utils::compute_id(release_itr->quantity.get_extended_symbol());
+        auto withdrawable_itr = withdrawable_idx.find(token_id);
+        if (withdrawable_itr == withdrawable_idx.end()) {
+            auto id = _withdrawable.available_primary_key();
+            _withdrawable.emplace(get_self(), [&](auto& row) {
+                row.id = id;
+                row.quantity = release_itr->quantity;
+            });
+        } else {
+            withdrawable_idx.modify(withdrawable_itr, same_payer, [&](auto& row) {
+                row.quantity += release_itr->quantity;
+            });
+        }
+        release_itr = release_idx.erase(release_itr);
+    }
+}
+
 uint64_t stake::next_release_id() {
     global_id_row global_id = _global_id.get_or_default();
     global_id.release_id++;
@@ -131,6 +131,38 @@ class [[eosio::contract("staking.xsat")]] stake : public contract {
         eosio::indexed_by<"byexpire"_n, const_mem_fun<release_row, uint64_t, &release_row::by_expiration_time>>>
         release_table;
 
+    /**
+     * ## TABLE `withdrawable`
+     *
+     * ### scope `staker`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{extended_asset} quantity` - expired release quantity waiting to be withdrawn
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 0,
+     *   "quantity": {
+     *       "quantity": "1.00000000 BTC",
+     *       "contract": "btc.xsat"
+     *   }
+     * }
+     * ```
+     */
+    struct [[eosio::table]] withdrawable_row {
+        uint64_t id;
+        extended_asset quantity;
+        uint64_t primary_key() const { return id; }
+        uint128_t by_token() const { return xsat::utils::compute_id(quantity.get_extended_symbol()); }
+    };
+    typedef eosio::multi_index<
+        "withdrawable"_n, withdrawable_row,
+        indexed_by<"bytoken"_n, const_mem_fun<withdrawable_row, uint128_t, &withdrawable_row::by_token>>>
+        withdrawable_table;
+
     /**
      * ## ACTION `addtoken`
      *
@@ -220,7 +252,7 @@ class [[eosio::contract("staking.xsat")]] stake : public contract {
      *
      * - **authority**: `staker`
      *
-     * > Withdraw expired staking tokens.
+     * > Withdraw expired staking tokens, sending a single transfer per token.
      *
      * ### params
      *
@@ -249,6 +281,7 @@ class [[eosio::contract("staking.xsat")]] stake : public contract {
     token_table _token = token_table(_self, _self.value);
 
     uint64_t next_release_id();
+    void collect_expired_releases(const name& staker);
     uint64_t next_staking_id();
     asset get_balance(const name& owner, const extended_symbol& token);
     void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
@@ -20,10 +20,26 @@ void utxo_manage::cleartable(const name table_name, const optional<uint64_t> sco
         clear_table(_spent_utxo, rows_to_clear);
     else if (table_name == "blocks"_n)
         clear_table(_block, rows_to_clear);
+    else if (table_name == "headers"_n)
+        clear_table(_header, rows_to_clear);
+    else if (table_name == "hdrepochs"_n)
+        clear_table(_header_epoch, rows_to_clear);
+    else if (table_name == "hdrarchive"_n)
+        _header_archive.remove();
+    else if (table_name == "watchconfig"_n)
+        _watch_config.remove();
+    else if (table_name == "utxocommit"_n)
+        _utxo_commit.remove();
+    else if (table_name == "utxocommits"_n)
+        clear_table(_utxo_checkpoint, rows_to_clear);
     else if (table_name == "block.extra"_n)
         clear_table(_block_extra, rows_to_clear);
     else if (table_name == "consensusblk"_n)
         clear_table(_consensus_block, rows_to_clear);
+    else if (table_name == "forktree"_n)
+        clear_table(_fork_tree, rows_to_clear);
+    else if (table_name == "chaintips"_n)
+        clear_table(_chain_tip, rows_to_clear);
     else if (table_name == "chainstate"_n)
         _chain_state.remove();
     else if (table_name == "config"_n)
@@ -66,6 +82,18 @@ void utxo_manage::setirrhash(const checksum256& irreversible_hash) {
     _chain_state.set(chain_state, get_self());
 }
 
+// points `migrating_height` at a block, so rwddist.xsat can distribute its rewards without migrating it
+[[eosio::action]]
+void utxo_manage::setmigrating(const uint64_t height, const checksum256& hash, const name& parser) {
+    require_auth(get_self());
+    auto chain_state = _chain_state.get();
+    chain_state.migrating_height = height;
+    chain_state.migrating_hash = hash;
+    chain_state.synchronizer = parser;
+    chain_state.parser = parser;
+    _chain_state.set(chain_state, get_self());
+}
+
 [[eosio::action]]
 bool utxo_manage::unspendable(const uint64_t height, const vector<uint8_t>& script) {
     require_auth(get_self());
@@ -135,6 +163,7 @@ void utxo_manage::addtestblock(const uint64_t height, const checksum256& hash, c
             row.nonce = nonce;
         });
     }
+    save_header(height, hash, previous_block_hash, cumulative_work, timestamp, bits);
 }
 
 [[eosio::action]]
@@ -147,7 +176,7 @@ void utxo_manage::addconsesblk(const uint64_t bucket_id, const uint64_t height,
 
     auto consensus_block_itr = _consensus_block.find(height);
     if (consensus_block_itr == _consensus_block.end()) {
-        _consensus_block.emplace(get_self(), [&](auto& row) {
+        consensus_block_itr = _consensus_block.emplace(get_self(), [&](auto& row) {
             row.height = height;
             row.hash = hash;
             row.version = version;
@@ -162,6 +191,7 @@ void utxo_manage::addconsesblk(const uint64_t bucket_id, const uint64_t height,
             row.synchronizer = synchronizer;
             row.created_at = created_at;
         });
+        update_chain_tips(*consensus_block_itr);
     } else {
         _consensus_block.modify(consensus_block_itr, same_payer, [&](auto& row) {
             row.height = height;
@@ -179,4 +209,11 @@ void utxo_manage::addconsesblk(const uint64_t bucket_id, const uint64_t height,
             row.created_at = created_at;
         });
     }
+}
+
+[[eosio::action]]
+utxo_manage::consensus_block_row utxo_manage::nextirrblk(const uint64_t irreversible_height,
+                                                         const checksum256& irreversible_hash) {
+    require_auth(get_self());
+    return find_next_irreversible_block(irreversible_height, irreversible_hash);
 }
\ No newline at end of file
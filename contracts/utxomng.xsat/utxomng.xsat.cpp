@@ -4,9 +4,11 @@
 #include <rwddist.xsat/rwddist.xsat.hpp>
 #include <rescmng.xsat/rescmng.xsat.hpp>
 #include <poolreg.xsat/poolreg.xsat.hpp>
+#include <custody.xsat/custody.xsat.hpp>
 #include <bitcoin/core/block_header.hpp>
 #include <bitcoin/core/transaction.hpp>
 #include <bitcoin/script/address.hpp>
+#include "../internal/parsing.hpp"
 
 #ifdef DEBUG
 #include "./src/debug.hpp"
@@ -55,12 +57,23 @@ void utxo_manage::config(const uint16_t parse_timeout_seconds, const uint16_t nu
     _config.set(config, get_self());
 }
 
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::setwatch(const bool custody_enabled) {
+    require_auth(get_self());
+
+    auto watch_config = _watch_config.get_or_default();
+    watch_config.custody_enabled = custody_enabled;
+    _watch_config.set(watch_config, get_self());
+}
+
 //@auth get_self()
 [[eosio::action]]
 void utxo_manage::addutxo(const uint64_t id, const checksum256& txid, const uint32_t index,
                           const vector<uint8_t>& scriptpubkey, const uint64_t value) {
     require_auth(get_self());
 
+    auto utxo_commit = _utxo_commit.get_or_default();
     auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
     auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(txid, index));
     if (utxo_itr == utxo_idx.end()) {
@@ -75,11 +88,48 @@ void utxo_manage::addutxo(const uint64_t id, const checksum256& txid, const uint
         chain_state.num_utxos += 1;
         _chain_state.set(chain_state, get_self());
     } else {
+        update_utxo_set_hash(utxo_commit.utxo_set_hash, txid, index, utxo_itr->scriptpubkey, utxo_itr->value, true);
         utxo_idx.modify(utxo_itr, same_payer, [&](auto& row) {
             row.scriptpubkey = scriptpubkey;
             row.value = value;
         });
     }
+    update_utxo_set_hash(utxo_commit.utxo_set_hash, txid, index, scriptpubkey, value, false);
+    _utxo_commit.set(utxo_commit, get_self());
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::addutxos(const checksum256& utxo_set_hash, const std::vector<char>& utxos) {
+    require_auth(get_self());
+    check(!utxos.empty(), "utxomng.xsat::addutxos: utxos cannot be empty");
+
+    auto utxo_commit = _utxo_commit.get_or_default();
+    auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
+    uint64_t num_utxos = 0;
+    eosio::datastream<const char*> ds(utxos.data(), utxos.size());
+    while (ds.remaining()) {
+        checksum256 txid;
+        uint32_t index;
+        uint64_t value;
+        std::vector<uint8_t> scriptpubkey;
+        ds >> txid >> index >> value >> scriptpubkey;
+        check(utxo_idx.find(xsat::utils::compute_utxo_id(txid, index)) == utxo_idx.end(),
+              "utxomng.xsat::addutxos: [utxos] already exists");
+
+        save_utxo(txid, index, scriptpubkey, value);
+        update_utxo_set_hash(utxo_commit.utxo_set_hash, txid, index, scriptpubkey, value, false);
+        num_utxos++;
+    }
+
+    // pages must be applied in order and intact to reach the declared rolling hash
+    check(utxo_commit.utxo_set_hash == utxo_set_hash,
+          "utxomng.xsat::addutxos: utxo_set_hash does not match the declared rolling hash");
+    _utxo_commit.set(utxo_commit, get_self());
+
+    auto chain_state = _chain_state.get_or_default();
+    chain_state.num_utxos += num_utxos;
+    _chain_state.set(chain_state, get_self());
 }
 
 //@auth get_self()
@@ -88,6 +138,9 @@ void utxo_manage::delutxo(const uint64_t id) {
     require_auth(get_self());
 
     auto& utxo = _utxo.get(id, "utxomng.xsat::delutxo: [utxos] does not exist");
+    auto utxo_commit = _utxo_commit.get_or_default();
+    update_utxo_set_hash(utxo_commit.utxo_set_hash, utxo.txid, utxo.index, utxo.scriptpubkey, utxo.value, true);
+    _utxo_commit.set(utxo_commit, get_self());
     _utxo.erase(utxo);
 
     auto chain_state = _chain_state.get_or_default();
@@ -129,6 +182,7 @@ void utxo_manage::addblock(const uint64_t height, const checksum256& hash, const
             row.nonce = nonce;
         });
     }
+    save_header(height, hash, previous_block_hash, cumulative_work, timestamp, bits);
 }
 
 //@auth get_self()
@@ -139,6 +193,117 @@ void utxo_manage::delblock(const uint64_t height) {
 
     auto block_itr = _block.require_find(height, "utxomng.xsat::delblock: [blocks] does not exist");
     _block.erase(block_itr);
+
+    auto header_itr = _header.find(height);
+    if (header_itr != _header.end()) {
+        xsat::cache::erase(_header, header_itr);
+    }
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::syncheaders(const uint64_t start_height, uint64_t rows) {
+    require_auth(get_self());
+
+    if (rows == 0)
+        rows = -1;
+
+    // irreversible blocks
+    auto block_itr = _block.lower_bound(start_height);
+    while (block_itr != _block.end() && rows) {
+        if (_header.find(block_itr->height) == _header.end()) {
+            save_header(block_itr->height, block_itr->hash, block_itr->previous_block_hash,
+                        block_itr->cumulative_work, block_itr->timestamp, block_itr->bits);
+        }
+        block_itr++;
+        rows--;
+    }
+
+    // consensus blocks, children inserted before their parent are relinked by `update_chain_tips`
+    auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
+    auto consensus_block_itr = consensus_block_idx.lower_bound(start_height);
+    while (consensus_block_itr != consensus_block_idx.end() && rows) {
+        if (_fork_tree.find(consensus_block_itr->bucket_id) == _fork_tree.end()) {
+            update_chain_tips(*consensus_block_itr);
+        }
+        consensus_block_itr++;
+        rows--;
+    }
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::addheaders(const uint64_t start_height, const checksum256& cumulative_work,
+                             const std::vector<char>& headers) {
+    require_auth(get_self());
+
+    check(!headers.empty() && headers.size() % BLOCK_HEADER_SIZE == 0,
+          "utxomng.xsat::addheaders: headers must be a multiple of 80 bytes");
+    const uint64_t num_headers = headers.size() / BLOCK_HEADER_SIZE;
+    check(start_height + num_headers - 1 <= START_HEIGHT,
+          "utxomng.xsat::addheaders: height must be less than or equal to 839999");
+
+    const auto epoch_size = CHAIN_PARAMS.difficulty_adjustment_interval();
+    auto header_archive = _header_archive.get_or_default();
+    if (header_archive.num_headers == 0) {
+        check(start_height % epoch_size == 0,
+              "utxomng.xsat::addheaders: the archive must start at the first block of an epoch");
+        header_archive.start_height = start_height;
+        header_archive.cumulative_work = cumulative_work;
+    } else {
+        check(start_height == header_archive.start_height + header_archive.num_headers,
+              "utxomng.xsat::addheaders: start_height must follow the last archived header");
+        check(cumulative_work == header_archive.cumulative_work,
+              "utxomng.xsat::addheaders: cumulative_work does not match the last archived header");
+    }
+
+    auto work = bitcoin::be_uint_from_checksum256(header_archive.cumulative_work);
+    uint64_t offset = 0;
+    while (offset < headers.size()) {
+        // headers are appended to the epoch row in one write per epoch
+        const uint64_t height = start_height + offset / BLOCK_HEADER_SIZE;
+        const uint64_t epoch = height / epoch_size;
+        const uint64_t size
+            = std::min((epoch + 1) * epoch_size - height, (headers.size() - offset) / BLOCK_HEADER_SIZE)
+              * BLOCK_HEADER_SIZE;
+        const auto epoch_cumulative_work = work;
+
+        eosio::datastream<const char*> ds(headers.data() + offset, size);
+        while (ds.remaining()) {
+            bitcoin::core::block_header block_header;
+            ds >> block_header;
+            const auto hash = block_header.hash();
+            check(hash <= block_header.target(), "utxomng.xsat::addheaders: header hash does not meet the target");
+
+            const auto block_hash = bitcoin::be_checksum256_from_uint(hash);
+            if (header_archive.num_headers > 0) {
+                check(bitcoin::be_checksum256_from_uint(block_header.previous_block_hash) == header_archive.last_hash,
+                      "utxomng.xsat::addheaders: header does not link to the last archived header");
+            }
+            work += block_header.work();
+            xsat::utils::mmr_append(header_archive.peaks, header_archive.num_headers, block_hash);
+            header_archive.last_hash = block_hash;
+            header_archive.num_headers++;
+        }
+
+        auto header_epoch_itr = _header_epoch.find(epoch);
+        if (header_epoch_itr == _header_epoch.end()) {
+            xsat::cache::emplace(_header_epoch, get_self(), [&](auto& row) {
+                row.epoch = epoch;
+                row.cumulative_work = bitcoin::be_checksum256_from_uint(epoch_cumulative_work);
+                row.headers.assign(headers.begin() + offset, headers.begin() + offset + size);
+            });
+        } else {
+            xsat::cache::modify(_header_epoch, header_epoch_itr, same_payer, [&](auto& row) {
+                row.headers.insert(row.headers.end(), headers.begin() + offset, headers.begin() + offset + size);
+            });
+        }
+        offset += size;
+    }
+
+    header_archive.cumulative_work = bitcoin::be_checksum256_from_uint(work);
+    header_archive.mmr_root = xsat::utils::mmr_root(header_archive.peaks);
+    _header_archive.set(header_archive, get_self());
 }
 
 //@auth get_self()
@@ -169,8 +334,6 @@ void utxo_manage::delblockdata(uint64_t rows, const uint64_t nonce) {
     if (rows == 0)
         rows = -1;
 
-    block_sync::delchunks_action _delchunks(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
-
     auto config = _config.get();
     auto chain_state = _chain_state.get();
     auto last_height = chain_state.irreversible_height - config.num_retain_data_blocks;
@@ -178,7 +341,8 @@ void utxo_manage::delblockdata(uint64_t rows, const uint64_t nonce) {
     auto block_extra_end = _block_extra.upper_bound(last_height);
 
     while (block_extra_itr != block_extra_end && rows--) {
-        _delchunks.send(block_extra_itr->bucket_id);
+        xsat::profile::send<block_sync::delchunks_action>(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n},
+                                                          block_extra_itr->bucket_id);
         block_extra_itr = _block_extra.erase(block_extra_itr);
     }
 }
@@ -222,8 +386,9 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
         auto block_bucket_itr = _block_bucket.require_find(passed_index_itr->bucket_id,
                                                            "utxomng.xsat::consensus: block bucket does not exists");
         // update height and btc miners
-        pool::updateheight_action _updateheight(POOL_REGISTER_CONTRACT, {get_self(), "active"_n});
-        _updateheight.send(passed_index_itr->miner, height, block_bucket_itr->verify_info->btc_miners);
+        xsat::profile::send<pool::updateheight_action>(POOL_REGISTER_CONTRACT, {get_self(), "active"_n},
+                                                       passed_index_itr->miner, height,
+                                                       block_bucket_itr->verify_info->btc_miners);
     }
 
     // get header
@@ -233,7 +398,7 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
     bitcoin::core::block_header block_header;
     block_stream >> block_header;
 
-    _consensus_block.emplace(get_self(), [&](auto& row) {
+    auto consensus_block_itr = _consensus_block.emplace(get_self(), [&](auto& row) {
         row.height = height;
         row.hash = hash;
         row.version = block_header.version;
@@ -249,6 +414,9 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
         row.created_at = current_time_point();
     });
 
+    // update fork tree and chain tips
+    update_chain_tips(*consensus_block_itr);
+
     auto chain_state = _chain_state.get_or_default();
     // Set latest block height
     if (chain_state.head_height < height) {
@@ -256,16 +424,9 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
     }
 
     // Set the latest parsable block height
+    // Forks reaching consensus at the parsing height are deferred until they become the best chain
     auto config = _config.get();
-    if (chain_state.parsing_height == height) {
-        chain_state.parsing_height = height;
-        chain_state.parsing_progress_of[hash]
-            = {.bucket_id = passed_index_itr->bucket_id,
-               .parser = passed_index_itr->synchronizer,
-               .parse_expiration_time = current_time_point() + eosio::seconds(config.parse_timeout_seconds)};
-    } else {
-        find_set_next_parsable_block(chain_state, config.parse_timeout_seconds);
-    }
+    find_set_next_parsable_block(chain_state, config.parse_timeout_seconds);
 
     // Set the block height of the latest migration
     find_set_next_irreversible_block(chain_state);
@@ -273,8 +434,8 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
     _chain_state.set(chain_state, get_self());
 
     // consensus
-    block_sync::consensus_action block_sync_consensus(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
-    block_sync_consensus.send(height, passed_index_itr->synchronizer, passed_index_itr->bucket_id);
+    xsat::profile::send<block_sync::consensus_action>(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n}, height,
+                                                      passed_index_itr->synchronizer, passed_index_itr->bucket_id);
 }
 
 //@auth
@@ -299,8 +460,8 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
     check(hash != ZERO_HASH, "4003:utxomng.xsat::processblock: you are not a parser of the current block");
 
     // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, synchronizer, PARSE, 1);
+    xsat::profile::send<resource_management::pay_action>(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n}, height,
+                                                         hash, synchronizer, PARSE, 1);
 
     auto config = _config.get();
     auto& parsing_progress = chain_state.parsing_progress_of[hash];
@@ -323,8 +484,9 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
             chain_state.status = migrating;
 
             // issue reward
-            reward_distribution::distribute_action _distribute(REWARD_DISTRIBUTION_CONTRACT, {get_self(), "active"_n});
-            _distribute.send(chain_state.migrating_height);
+            xsat::profile::send<reward_distribution::distribute_action>(REWARD_DISTRIBUTION_CONTRACT,
+                                                                        {get_self(), "active"_n},
+                                                                        chain_state.migrating_height);
         } else {
             chain_state.status = parsing;
         }
@@ -348,22 +510,12 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
         chain_state.num_validators_assigned = to_index;
 
         // distribute rewards to validators in batches
-        reward_distribution::endtreward_action _endtreward(REWARD_DISTRIBUTION_CONTRACT, {get_self(), "active"_n});
-        _endtreward.send(chain_state.migrating_height, from_index, to_index);
+        xsat::profile::send<reward_distribution::endtreward_action>(REWARD_DISTRIBUTION_CONTRACT,
+                                                                    {get_self(), "active"_n},
+                                                                    chain_state.migrating_height, from_index, to_index);
 
         if (chain_state.num_provider_validators == chain_state.num_validators_assigned) {
-            chain_state.irreversible_height = chain_state.migrating_height;
-            chain_state.irreversible_hash = chain_state.migrating_hash;
-            chain_state.migrating_height = 0;
-            chain_state.migrating_hash = ZERO_HASH;
-            chain_state.migrating_num_utxos = 0;
-            chain_state.migrated_num_utxos = 0;
-            chain_state.num_provider_validators = 0;
-            chain_state.num_validators_assigned = 0;
-            chain_state.synchronizer = {};
-            chain_state.miner = {};
-            chain_state.parser = {};
-            chain_state.status = parsing;
+            finish_migration(chain_state);
         }
     } else if (chain_state.status == parsing) {
         parsing_transactions(height, hash, &parsing_progress, process_row);
@@ -409,58 +561,12 @@ void utxo_manage::parsing_transactions(const uint64_t height, const checksum256&
     auto block_data = block_sync::read_bucket(BLOCK_SYNC_CONTRACT, parsing_progress->bucket_id, BLOCK_CHUNK,
                                               BLOCK_HEADER_SIZE + parsing_progress->parsed_position,
                                               std::numeric_limits<uint64_t>::max());
-    eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
-
-    // init num_transactions
-    if (parsing_progress->parsed_position == 0) {
-        parsing_progress->num_transactions = bitcoin::varint::decode(block_stream);
-    }
-
-    if (process_row == 0)
-        process_row = -1;
-
-    uint64_t parsed_position = 0;
-    std::vector<uint8_t> script_data = {};
-    auto pending_transactions = parsing_progress->num_transactions - parsing_progress->parsed_transactions;
-    while (pending_transactions-- && process_row) {
-        bitcoin::core::transaction transaction(&block_data);
-        block_stream >> transaction;
-        auto txid = bitcoin::be_checksum256_from_uint(transaction.merkle_hash());
-
-        // save vin
-        for (; parsing_progress->parsed_vin < transaction.inputs.size() && process_row;
-             parsing_progress->parsed_vin++, process_row--) {
-            auto vin = transaction.inputs[parsing_progress->parsed_vin];
-            if (transaction.is_coinbase())
-                continue;
-
-            save_pending_utxo(height, hash, bitcoin::be_checksum256_from_uint(vin.previous_output_hash),
-                              vin.previous_output_index, script_data, 0, "vin"_n);
-            parsing_progress->num_utxos++;
-        }
-
-        // save vout
-        for (; parsing_progress->parsed_vout < transaction.outputs.size() && process_row;
-             parsing_progress->parsed_vout++, process_row--) {
-            auto vout = transaction.outputs[parsing_progress->parsed_vout];
-
-            if (xsat::utils::is_unspendable_legacy(vout.script.data))
-                continue;
-            save_pending_utxo(height, hash, txid, parsing_progress->parsed_vout, vout.script.data, vout.value,
-                              "vout"_n);
-            parsing_progress->num_utxos++;
-        }
-
-        // next transaction
-        if (parsing_progress->parsed_vin == transaction.inputs.size()
-            && parsing_progress->parsed_vout == transaction.outputs.size()) {
-            parsed_position = block_stream.tellp();
-            parsing_progress->parsed_vin = 0;
-            parsing_progress->parsed_vout = 0;
-            parsing_progress->parsed_transactions++;
-        }
-    }
-    parsing_progress->parsed_position += parsed_position;
+    xsat::parsing::parse_transactions(block_data, *parsing_progress, process_row,
+                                      [&](const checksum256& txid, const uint32_t index,
+                                          const std::vector<uint8_t>& script_data, const uint64_t value,
+                                          const name& type) {
+                                          save_pending_utxo(height, hash, txid, index, script_data, value, type);
+                                      });
 }
 
 void utxo_manage::migrate(utxo_manage::chain_state_row& chain_state, uint64_t process_row) {
@@ -472,19 +578,41 @@ void utxo_manage::migrate(utxo_manage::chain_state_row& chain_state, uint64_t pr
     auto start_itr = pending_utxo_idx.lower_bound(block_id);
     auto end_itr = pending_utxo_idx.upper_bound(block_id);
 
+    auto utxo_commit = _utxo_commit.get_or_default();
     auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
+
+    // custody watchlist
+    const bool watch_custody_enabled = _watch_config.get_or_default().custody_enabled;
+    custody::custody_index _custody(CUSTODY_CONTRACT, CUSTODY_CONTRACT.value);
+    auto custody_idx = _custody.get_index<"scriptpubkey"_n>();
+    map<uint64_t, int64_t> custody_deltas;
+
     while (start_itr != end_itr && process_row--) {
         if (start_itr->type == "vin"_n) {
             auto prev_utxo = remove_utxo(utxo_idx, start_itr->txid, start_itr->index);
             if (prev_utxo.has_value()) {
                 chain_state.num_utxos -= 1;
+                update_utxo_set_hash(utxo_commit.utxo_set_hash, prev_utxo->txid, prev_utxo->index,
+                                     prev_utxo->scriptpubkey, prev_utxo->value, true);
 
                 // migrate to utxo  table
                 save_spent_utxo(start_itr->height, *prev_utxo);
+
+                if (watch_custody_enabled) {
+                    watch_custody(custody_idx, custody_deltas, prev_utxo->scriptpubkey,
+                                  -static_cast<int64_t>(prev_utxo->value));
+                }
             }
         } else {
             save_utxo(start_itr->txid, start_itr->index, start_itr->scriptpubkey, start_itr->value);
             chain_state.num_utxos += 1;
+            update_utxo_set_hash(utxo_commit.utxo_set_hash, start_itr->txid, start_itr->index,
+                                 start_itr->scriptpubkey, start_itr->value, false);
+
+            if (watch_custody_enabled) {
+                watch_custody(custody_idx, custody_deltas, start_itr->scriptpubkey,
+                              static_cast<int64_t>(start_itr->value));
+            }
         }
 
         // erase pending utxo
@@ -492,6 +620,28 @@ void utxo_manage::migrate(utxo_manage::chain_state_row& chain_state, uint64_t pr
 
         chain_state.migrated_num_utxos++;
     }
+    _utxo_commit.set(utxo_commit, get_self());
+
+    // report the balance changes of custody addresses in a single action
+    if (!custody_deltas.empty()) {
+        vector<custody::balance_delta> deltas;
+        deltas.reserve(custody_deltas.size());
+        for (const auto& [id, value] : custody_deltas) {
+            deltas.push_back({id, value});
+        }
+        xsat::profile::send<custody::syncbalances_action>(CUSTODY_CONTRACT, {get_self(), "active"_n},
+                                                          chain_state.migrating_height, deltas);
+    }
+
+    // checkpoint the UTXO set commitment of the irreversible block
+    if (chain_state.migrating_num_utxos == chain_state.migrated_num_utxos) {
+        _utxo_checkpoint.emplace(get_self(), [&](auto& row) {
+            row.height = chain_state.migrating_height;
+            row.hash = chain_state.migrating_hash;
+            row.utxo_set_hash = utxo_commit.utxo_set_hash;
+            row.num_utxos = chain_state.num_utxos;
+        });
+    }
 }
 
 void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const uint16_t retained_spent_utxo_blocks,
@@ -519,20 +669,25 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
         return;
     }
 
-    block_sync::delchunks_action _delchunks(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
-
     // erase endorsement
-    block_endorse::erase_action _erase(BLOCK_ENDORSE_CONTRACT, {get_self(), "active"_n});
-    _erase.send(chain_state.migrating_height);
+    xsat::profile::send<block_endorse::erase_action>(BLOCK_ENDORSE_CONTRACT, {get_self(), "active"_n},
+                                                     chain_state.migrating_height);
 
     // erase old block chunks
     auto del_height = chain_state.migrating_height - num_retain_data_blocks;
     auto block_extra_itr = _block_extra.find(del_height);
     if (block_extra_itr != _block_extra.end()) {
-        _delchunks.send(block_extra_itr->bucket_id);
+        xsat::profile::send<block_sync::delchunks_action>(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n},
+                                                          block_extra_itr->bucket_id);
         _block_extra.erase(block_extra_itr);
     }
 
+    // erase old UTXO set checkpoint
+    auto utxo_checkpoint_itr = _utxo_checkpoint.find(del_height);
+    if (utxo_checkpoint_itr != _utxo_checkpoint.end()) {
+        _utxo_checkpoint.erase(utxo_checkpoint_itr);
+    }
+
     // erase consensus block
     consensus_block_row consensus_block;
     auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
@@ -542,10 +697,12 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
         // Without deleting the data of the current latest irreversible block, config.num_retain_data_blocks block
         // data needs to be retained.
         if (consensus_block_itr->hash != chain_state.migrating_hash) {
-            _delchunks.send(consensus_block_itr->bucket_id);
+            xsat::profile::send<block_sync::delchunks_action>(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n},
+                                                              consensus_block_itr->bucket_id);
         } else {
             consensus_block = *consensus_block_itr;
         }
+        erase_fork_node(consensus_block_itr->bucket_id);
         consensus_block_itr = consensus_block_idx.erase(consensus_block_itr);
     }
 
@@ -561,6 +718,8 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
         row.bits = consensus_block.bits;
         row.nonce = consensus_block.nonce;
     });
+    save_header(consensus_block.height, consensus_block.hash, consensus_block.previous_block_hash,
+                consensus_block.cumulative_work, consensus_block.timestamp, consensus_block.bits);
 
     // save block extra
     _block_extra.emplace(get_self(), [&](auto& row) {
@@ -569,13 +728,74 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
     });
 
     // next action
-    chain_state.status = distributing_rewards;
+    // Validator rewards accumulated by rwddist.xsat per epoch are already allocated, skip distributing them
+    reward_distribution::reward_log_table _reward_log(REWARD_DISTRIBUTION_CONTRACT, REWARD_DISTRIBUTION_CONTRACT.value);
+    auto reward_log_itr = _reward_log.find(chain_state.migrating_height);
+    if (reward_log_itr != _reward_log.end()
+        && reward_log_itr->num_validators_assigned == reward_log_itr->provider_validators.size()) {
+        finish_migration(chain_state);
+    } else {
+        // continue after the validators `distribute` has already accumulated
+        if (reward_log_itr != _reward_log.end()) {
+            chain_state.num_validators_assigned = reward_log_itr->num_validators_assigned;
+        }
+        chain_state.status = distributing_rewards;
+    }
+}
+
+void utxo_manage::finish_migration(utxo_manage::chain_state_row& chain_state) {
+    chain_state.irreversible_height = chain_state.migrating_height;
+    chain_state.irreversible_hash = chain_state.migrating_hash;
+    chain_state.migrating_height = 0;
+    chain_state.migrating_hash = ZERO_HASH;
+    chain_state.migrating_num_utxos = 0;
+    chain_state.migrated_num_utxos = 0;
+    chain_state.num_provider_validators = 0;
+    chain_state.num_validators_assigned = 0;
+    chain_state.synchronizer = {};
+    chain_state.miner = {};
+    chain_state.parser = {};
+    chain_state.status = parsing;
 }
 
 void utxo_manage::find_set_next_parsable_block(utxo_manage::chain_state_row& chain_state,
                                                const uint16_t parse_timeout_seconds) {
     if (chain_state.parsing_height != 0)
         return;
+
+    // Only the best chain is parsed, find its lowest unparsed block by backtracking from the best tip
+    auto chain_tip_idx = _chain_tip.get_index<"bywork"_n>();
+    auto chain_tip_itr = chain_tip_idx.end();
+    if (chain_tip_itr != chain_tip_idx.begin()) {
+        chain_tip_itr--;
+        // The migrating block has been parsed and its fork node may already be erased
+        const auto base_height = std::max(chain_state.irreversible_height, chain_state.migrating_height);
+        auto parsable_block_itr = _consensus_block.end();
+        auto lowest_height = chain_tip_itr->height + 1;
+        auto fork_node_itr = _fork_tree.find(chain_tip_itr->bucket_id);
+        while (fork_node_itr != _fork_tree.end() && fork_node_itr->height > base_height) {
+            auto consensus_block_itr = _consensus_block.find(fork_node_itr->bucket_id);
+            if (consensus_block_itr != _consensus_block.end() && !consensus_block_itr->parse) {
+                parsable_block_itr = consensus_block_itr;
+            }
+            lowest_height = fork_node_itr->height;
+            fork_node_itr = _fork_tree.find(fork_node_itr->parent_bucket_id);
+        }
+
+        // The best chain can be traced back to the irreversible block
+        if (lowest_height == base_height + 1) {
+            if (parsable_block_itr != _consensus_block.end()) {
+                chain_state.parsing_height = parsable_block_itr->height;
+                chain_state.parsing_progress_of[parsable_block_itr->hash]
+                    = {.bucket_id = parsable_block_itr->bucket_id,
+                       .parser = parsable_block_itr->synchronizer,
+                       .parse_expiration_time = current_time_point() + eosio::seconds(parse_timeout_seconds)};
+            }
+            return;
+        }
+    }
+
+    // Blocks that reached consensus before the fork tree was maintained
     uint128_t id = compute_parse_height(false, chain_state.irreversible_height);
     auto block_id_idx = _consensus_block.get_index<"parseheight"_n>();
     auto consensus_block_itr = block_id_idx.upper_bound(id);
@@ -607,6 +827,12 @@ void utxo_manage::find_set_next_irreversible_block(utxo_manage::chain_state_row&
 
     // Get the next irreversible block
     auto consensus_block = find_next_irreversible_block(chain_state.irreversible_height, chain_state.irreversible_hash);
+
+    // A deferred fork that became the best chain must be parsed before it is migrated
+    if (!consensus_block.parse) {
+        return;
+    }
+
     chain_state.migrating_height = consensus_block.height;
     chain_state.migrating_hash = consensus_block.hash;
     chain_state.miner = consensus_block.miner;
@@ -618,7 +844,7 @@ void utxo_manage::find_set_next_irreversible_block(utxo_manage::chain_state_row&
     block_endorse::endorsement_table _endorsement(BLOCK_ENDORSE_CONTRACT, chain_state.migrating_height);
     auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
     auto endorsement_itr = endorsement_idx.require_find(chain_state.migrating_hash);
-    chain_state.num_provider_validators = endorsement_itr->provider_validators.size();
+    chain_state.num_provider_validators = endorsement_itr->num_endorsed();
 
     auto consensus_block_itr = _consensus_block.find(consensus_block.bucket_id);
     _consensus_block.modify(consensus_block_itr, same_payer, [&](auto& row) {
@@ -640,6 +866,31 @@ utxo_manage::consensus_block_row utxo_manage::find_next_irreversible_block(const
         return *next_irreversible_itr;
     }
 
+    // Backtrack from the tip with the largest cumulative work through the fork tree
+    auto chain_tip_idx = _chain_tip.get_index<"bywork"_n>();
+    auto chain_tip_itr = chain_tip_idx.end();
+    while (chain_tip_itr != chain_tip_idx.begin()) {
+        chain_tip_itr--;
+        auto fork_node_itr = _fork_tree.find(chain_tip_itr->bucket_id);
+        while (fork_node_itr != _fork_tree.end() && fork_node_itr->height > irreversible_height + 1) {
+            fork_node_itr = _fork_tree.find(fork_node_itr->parent_bucket_id);
+        }
+        // The tree of the heaviest tip is incomplete, a lighter tip must not be selected in its place
+        if (fork_node_itr == _fork_tree.end()) {
+            break;
+        }
+
+        auto consensus_block_itr = _consensus_block.find(fork_node_itr->bucket_id);
+        if (fork_node_itr->height == irreversible_height + 1 && consensus_block_itr != _consensus_block.end()
+            && consensus_block_itr->previous_block_hash == irreversible_hash) {
+            return *consensus_block_itr;
+        }
+
+        // The tip is on a fork that can no longer become irreversible
+        chain_tip_itr = chain_tip_idx.erase(chain_tip_itr);
+    }
+
+    // Blocks that reached consensus before the fork tree was maintained
     // Find the parent block with the largest cumulative work after 6 blocks
     consensus_block_row parent;
     auto parent_height = irreversible_height + IRREVERSIBLE_BLOCKS;
@@ -666,6 +917,94 @@ utxo_manage::consensus_block_row utxo_manage::find_next_irreversible_block(const
     return *irreversible_block;
 }
 
+void utxo_manage::update_chain_tips(const consensus_block_row& consensus_block) {
+    // The parent is either a consensus block or an irreversible block (0)
+    uint64_t parent_bucket_id = 0;
+    auto fork_node_idx = _fork_tree.get_index<"byblockid"_n>();
+    auto parent_itr = fork_node_idx.find(
+        xsat::utils::compute_block_id(consensus_block.height - 1, consensus_block.previous_block_hash));
+    if (parent_itr != fork_node_idx.end()) {
+        parent_bucket_id = parent_itr->bucket_id;
+    }
+
+    _fork_tree.emplace(get_self(), [&](auto& row) {
+        row.bucket_id = consensus_block.bucket_id;
+        row.height = consensus_block.height;
+        row.parent_bucket_id = parent_bucket_id;
+        row.hash = consensus_block.hash;
+        row.previous_block_hash = consensus_block.previous_block_hash;
+        row.cumulative_work = consensus_block.cumulative_work;
+        row.timestamp = consensus_block.timestamp;
+        row.bits = consensus_block.bits;
+    });
+
+    // The parent is no longer a tip after it has been extended
+    auto parent_tip_itr = _chain_tip.find(parent_bucket_id);
+    if (parent_tip_itr != _chain_tip.end()) {
+        _chain_tip.erase(parent_tip_itr);
+    }
+
+    // Children that reached consensus before this block were stored without a parent
+    bool has_children = false;
+    auto height_idx = _fork_tree.get_index<"byheight"_n>();
+    auto child_itr = height_idx.lower_bound(consensus_block.height + 1);
+    auto child_end = height_idx.upper_bound(consensus_block.height + 1);
+    for (; child_itr != child_end; child_itr++) {
+        if (child_itr->parent_bucket_id != 0 || child_itr->previous_block_hash != consensus_block.hash) {
+            continue;
+        }
+        height_idx.modify(child_itr, same_payer, [&](auto& row) {
+            row.parent_bucket_id = consensus_block.bucket_id;
+        });
+        has_children = true;
+    }
+    if (has_children) {
+        return;
+    }
+
+    _chain_tip.emplace(get_self(), [&](auto& row) {
+        row.bucket_id = consensus_block.bucket_id;
+        row.height = consensus_block.height;
+        row.hash = consensus_block.hash;
+        row.cumulative_work = consensus_block.cumulative_work;
+    });
+}
+
+void utxo_manage::save_header(const uint64_t height, const checksum256& hash, const checksum256& previous_block_hash,
+                              const checksum256& cumulative_work, const uint32_t timestamp, const uint32_t bits) {
+    auto header_itr = _header.find(height);
+    if (header_itr == _header.end()) {
+        xsat::cache::emplace(_header, get_self(), [&](auto& row) {
+            row.height = height;
+            row.hash = hash;
+            row.previous_block_hash = previous_block_hash;
+            row.cumulative_work = cumulative_work;
+            row.timestamp = timestamp;
+            row.bits = bits;
+        });
+    } else {
+        xsat::cache::modify(_header, header_itr, same_payer, [&](auto& row) {
+            row.hash = hash;
+            row.previous_block_hash = previous_block_hash;
+            row.cumulative_work = cumulative_work;
+            row.timestamp = timestamp;
+            row.bits = bits;
+        });
+    }
+}
+
+void utxo_manage::erase_fork_node(const uint64_t bucket_id) {
+    auto fork_node_itr = _fork_tree.find(bucket_id);
+    if (fork_node_itr != _fork_tree.end()) {
+        _fork_tree.erase(fork_node_itr);
+    }
+
+    auto chain_tip_itr = _chain_tip.find(bucket_id);
+    if (chain_tip_itr != _chain_tip.end()) {
+        _chain_tip.erase(chain_tip_itr);
+    }
+}
+
 void utxo_manage::save_spent_utxo(const uint64_t height, const utxo_manage::utxo_row& utxo) {
     auto id = _spent_utxo.available_primary_key();
     if (id == 0) {
@@ -684,51 +1023,44 @@ void utxo_manage::save_spent_utxo(const uint64_t height, const utxo_manage::utxo
 void utxo_manage::save_pending_utxo(const uint64_t height, const checksum256& hash, const checksum256& txid,
                                     const uint32_t index, const std::vector<uint8_t>& script_data, const uint64_t value,
                                     const name& type) {
-    auto id = _pending_utxo.available_primary_key();
-    if (id == 0) {
-        id = 1;
-    }
-    _pending_utxo.emplace(get_self(), [&](auto& row) {
-        row.id = id;
-        row.height = height;
-        row.hash = hash;
-        row.txid = txid;
-        row.index = index;
-        row.scriptpubkey = script_data;
-        row.value = value;
-        row.type = type;
-    });
+    xsat::parsing::save_pending_utxo(_pending_utxo, get_self(), height, hash, txid, index, script_data, value, type);
 }
 
 utxo_manage::utxo_row utxo_manage::save_utxo(const checksum256& txid, const uint32_t index,
                                              const std::vector<uint8_t>& script_data, const uint64_t value) {
     //  save output
-    auto id = _utxo.available_primary_key();
-    if (id == 0) {
-        id = 1;
+    return xsat::parsing::save_utxo(_utxo, get_self(), txid, index, script_data, value);
+}
+
+void utxo_manage::update_utxo_set_hash(checksum256& utxo_set_hash, const checksum256& txid, const uint32_t index,
+                                       const std::vector<uint8_t>& scriptpubkey, const uint64_t value,
+                                       const bool spent) {
+    // additive set hash, the order in which utxos are added or spent does not matter
+    auto set_hash = bitcoin::be_uint_from_checksum256(utxo_set_hash);
+    auto utxo_hash
+        = bitcoin::be_uint_from_checksum256(xsat::utils::compute_utxo_hash(txid, index, value, scriptpubkey));
+    utxo_set_hash = bitcoin::be_checksum256_from_uint(spent ? set_hash - utxo_hash : set_hash + utxo_hash);
+}
+
+template <typename IDX>
+void utxo_manage::watch_custody(IDX& custody_idx, map<uint64_t, int64_t>& custody_deltas,
+                                const std::vector<uint8_t>& scriptpubkey, const int64_t value) {
+    auto custody_itr = custody_idx.find(xsat::utils::hash(scriptpubkey));
+    if (custody_itr != custody_idx.end()) {
+        custody_deltas[custody_itr->id] += value;
     }
-    auto utxo_itr = _utxo.emplace(get_self(), [&](auto& row) {
-        row.id = id;
-        row.txid = txid;
-        row.index = index;
-        row.scriptpubkey = script_data;
-        row.value = value;
-    });
-    return *utxo_itr;
 }
 
 template <typename IDX>
 optional<utxo_manage::utxo_row> utxo_manage::remove_utxo(IDX& utxo_idx, const checksum256& prev_txid,
                                                          const uint32_t prev_index) {
-    auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(prev_txid, prev_index));
-    if (utxo_itr != utxo_idx.end()) {
-        auto found_utxo = *utxo_itr;
-        utxo_idx.erase(utxo_itr);
+    auto found_utxo = xsat::parsing::remove_utxo(utxo_idx, prev_txid, prev_index);
+    if (found_utxo.has_value()) {
         return found_utxo;
     } else {
-        // log
-        utxo_manage::lostutxolog_action _lostutxolog(get_self(), {get_self(), "active"_n});
-        _lostutxolog.send(prev_txid, prev_index);
+        // log, sent inline because the return value of `processblock` is the process result
+        xsat::profile::send<utxo_manage::lostutxolog_action>(get_self(), {get_self(), "active"_n}, prev_txid,
+                                                             prev_index);
         return nullopt;
     }
 }
@@ -5,7 +5,9 @@
 #include <eosio/singleton.hpp>
 #include <eosio/crypto.hpp>
 #include "../internal/defines.hpp"
+#include <bitcoin/core/block_header.hpp>
 #include "../internal/utils.hpp"
+#include "../internal/cache.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -162,7 +164,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         map<checksum256, parsing_progress_row> parsing_progress_of;
         parsing_status status;
     };
-    typedef eosio::singleton<"chainstate"_n, chain_state_row> chain_state_table;
+    typedef xsat::profile::singleton<"chainstate"_n, chain_state_row> chain_state_table;
 
     /**
      * ## TABLE `config`
@@ -202,7 +204,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint8_t num_merkle_layer = 11;
         uint16_t num_miner_priority_blocks = 10;
     };
-    typedef eosio::singleton<"config"_n, config_row> config_table;
+    typedef xsat::profile::singleton<"config"_n, config_row> config_table;
 
     /**
      * ## TABLE `utxos`
@@ -238,7 +240,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         checksum256 by_scriptpubkey() const { return xsat::utils::hash(scriptpubkey); }
         checksum256 by_utxo_id() const { return xsat::utils::compute_utxo_id(txid, index); }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "utxos"_n, utxo_row,
         eosio::indexed_by<"scriptpubkey"_n, const_mem_fun<utxo_row, checksum256, &utxo_row::by_scriptpubkey>>,
         eosio::indexed_by<"byutxoid"_n, const_mem_fun<utxo_row, checksum256, &utxo_row::by_utxo_id>>>
@@ -291,7 +293,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         checksum256 by_block_utxo_id() const { return compute_utxo_id_for_block(height, hash, txid, index); }
         checksum256 by_type() const { return compute_type_id_for_block(height, hash, type); }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "pendingutxos"_n, pending_utxo_row,
         eosio::indexed_by<"byheight"_n, const_mem_fun<pending_utxo_row, uint64_t, &pending_utxo_row::by_height>>,
         eosio::indexed_by<"byblockid"_n, const_mem_fun<pending_utxo_row, checksum256, &pending_utxo_row::by_block_id>>,
@@ -341,7 +343,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         checksum256 by_scriptpubkey() const { return xsat::utils::hash(scriptpubkey); }
         checksum256 by_utxo_id() const { return xsat::utils::compute_utxo_id(txid, index); }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "spentutxos"_n, spent_utxo_row,
         eosio::indexed_by<"byheight"_n, const_mem_fun<spent_utxo_row, uint64_t, &spent_utxo_row::by_height>>,
         eosio::indexed_by<"scriptpubkey"_n,
@@ -349,6 +351,58 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         eosio::indexed_by<"byutxoid"_n, const_mem_fun<spent_utxo_row, checksum256, &spent_utxo_row::by_utxo_id>>>
         spent_utxo_table;
 
+    /**
+     * ## TABLE `utxocommit`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{checksum256} utxo_set_hash` - the sum modulo 2^256 of `sha256(txid, index, value, scriptpubkey)` over all utxos
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "utxo_set_hash": "c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] utxo_commit_row {
+        checksum256 utxo_set_hash;
+    };
+    typedef xsat::profile::singleton<"utxocommit"_n, utxo_commit_row> utxo_commit_table;
+
+    /**
+     * ## TABLE `utxocommits`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - primary key, irreversible block height
+     * - `{checksum256} hash` - irreversible block hash
+     * - `{checksum256} utxo_set_hash` - the UTXO set commitment after the block has been migrated
+     * - `{uint64_t} num_utxos` - the number of utxos after the block has been migrated
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840000,
+     *   "hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5",
+     *   "utxo_set_hash": "c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0",
+     *   "num_utxos": 6683
+     * }
+     * ```
+     */
+    struct [[eosio::table]] utxo_checkpoint_row {
+        uint64_t height;
+        checksum256 hash;
+        checksum256 utxo_set_hash;
+        uint64_t num_utxos;
+        uint64_t primary_key() const { return height; }
+    };
+    typedef xsat::profile::multi_index<"utxocommits"_n, utxo_checkpoint_row> utxo_checkpoint_table;
+
     /**
      * ## TABLE `blocks`
      *
@@ -394,11 +448,133 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint64_t primary_key() const { return height; }
         checksum256 by_hash() const { return hash; }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "blocks"_n, block_row,
         eosio::indexed_by<"byhash"_n, const_mem_fun<block_row, checksum256, &block_row::by_hash>>>
         block_table;
 
+    /**
+     * ## TABLE `headers`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - primary key, block height of the main chain
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
+     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840011,
+     *   "hash": "00000000000000000002d12efb02bcf70580b2eebf4b775578844640512e30f3",
+     *   "previous_block_hash": "00000000000000000000da20f7d8e9e6412d4f1d8b62d88264cddbdd48256ba0",
+     *   "cumulative_work": "0000000000000000000000000000000000000000753f3af9322a2a893cb6ece4",
+     *   "timestamp": 1713576761,
+     *   "bits": 386089497
+     *  }
+     * ```
+     */
+    struct [[eosio::table]] header_row {
+        uint64_t height;
+        checksum256 hash;
+        checksum256 previous_block_hash;
+        checksum256 cumulative_work;
+        uint32_t timestamp;
+        uint32_t bits;
+        uint64_t primary_key() const { return height; }
+    };
+    typedef xsat::profile::multi_index<"headers"_n, header_row> header_table;
+
+    /**
+     * ## TABLE `hdrepochs`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} epoch` - primary key, the difficulty adjustment period `height / 2016`
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block preceding the epoch
+     * - `{std::vector<char>} headers` - the 80-byte serialized block headers of the epoch in height order
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "epoch": 416,
+     *   "cumulative_work": "0000000000000000000000000000000000000000739f0c837d8538b068f839a0",
+     *   "headers": "0000812e28e0ae3dea13180d58259e5e080ccf85034389b9ea3a02000000000000000000..."
+     * }
+     * ```
+     */
+    struct [[eosio::table]] header_epoch_row {
+        uint64_t epoch;
+        checksum256 cumulative_work;
+        std::vector<char> headers;
+        uint64_t primary_key() const { return epoch; }
+    };
+    typedef xsat::profile::multi_index<"hdrepochs"_n, header_epoch_row> header_epoch_table;
+
+    /**
+     * ## TABLE `hdrarchive`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} start_height` - the height of the first archived header
+     * - `{uint64_t} num_headers` - the number of archived headers, which is also the number of MMR leaves
+     * - `{checksum256} last_hash` - the hash of the last archived header
+     * - `{checksum256} cumulative_work` - the cumulative workload of the last archived header
+     * - `{std::vector<checksum256>} peaks` - the MMR peaks ordered from the highest to the lowest
+     * - `{checksum256} mmr_root` - the MMR root committing to the hashes of all archived headers
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "start_height": 838656,
+     *   "num_headers": 1,
+     *   "last_hash": "00000000000000000001f2fa38c036edc385487c0226fbffc8bfe72c5a655899",
+     *   "cumulative_work": "0000000000000000000000000000000000000000739f5b15b3757c13af5b1a6b",
+     *   "peaks": ["00000000000000000001f2fa38c036edc385487c0226fbffc8bfe72c5a655899"],
+     *   "mmr_root": "00000000000000000001f2fa38c036edc385487c0226fbffc8bfe72c5a655899"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] header_archive_row {
+        uint64_t start_height;
+        uint64_t num_headers;
+        checksum256 last_hash;
+        checksum256 cumulative_work;
+        std::vector<checksum256> peaks;
+        checksum256 mmr_root;
+    };
+    typedef xsat::profile::singleton<"hdrarchive"_n, header_archive_row> header_archive_table;
+
+    /**
+     * ## TABLE `watchconfig`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{bool} custody_enabled` - whether migration reports balance changes of `custody.xsat` addresses
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "custody_enabled": true
+     * }
+     * ```
+     */
+    struct [[eosio::table]] watch_config_row {
+        bool custody_enabled = false;
+    };
+    typedef xsat::profile::singleton<"watchconfig"_n, watch_config_row> watch_config_table;
+
     /**
      * ## TABLE `block.extra`
      *
@@ -422,7 +598,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint64_t bucket_id;
         uint64_t primary_key() const { return height; }
     };
-    typedef eosio::multi_index<"block.extra"_n, block_extra_row> block_extra_table;
+    typedef xsat::profile::multi_index<"block.extra"_n, block_extra_row> block_extra_table;
 
     /**
      * ## TABLE `consensusblk`
@@ -496,7 +672,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint128_t by_parse_height() const { return compute_parse_height(parse, height); }
         checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
     };
-    typedef eosio::multi_index<
+    typedef xsat::profile::multi_index<
         "consensusblk"_n, consensus_block_row,
         eosio::indexed_by<"byheight"_n, const_mem_fun<consensus_block_row, uint64_t, &consensus_block_row::by_height>>,
         eosio::indexed_by<"bysyncer"_n,
@@ -507,6 +683,91 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
                           const_mem_fun<consensus_block_row, checksum256, &consensus_block_row::by_block_id>>>
         consensus_block_table;
 
+    /**
+     * ## TABLE `forktree`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} bucket_id` - primary key, the bucket_id of the consensus block
+     * - `{uint64_t} height` - block height
+     * - `{uint64_t} parent_bucket_id` - the bucket_id of the parent consensus block, 0 means the parent is irreversible
+     * or has not reached consensus yet, the node is linked once the parent reaches consensus
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
+     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "bucket_id": 6,
+     *   "height": 840004,
+     *   "parent_bucket_id": 5,
+     *   "hash": "000000000000000000028458274b1f458d57d817fdce349e31dd5cb51b277d36",
+     *   "previous_block_hash": "00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119",
+     *   "cumulative_work": "0000000000000000000000000000000000000000753d14f9b89852d25002c757",
+     *   "timestamp": 1713573202,
+     *   "bits": 386089497
+     * }
+     * ```
+     */
+    struct [[eosio::table]] fork_node_row {
+        uint64_t bucket_id;
+        uint64_t height;
+        uint64_t parent_bucket_id;
+        checksum256 hash;
+        checksum256 previous_block_hash;
+        checksum256 cumulative_work;
+        uint32_t timestamp;
+        uint32_t bits;
+        uint64_t primary_key() const { return bucket_id; }
+        uint64_t by_height() const { return height; }
+        checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
+    };
+    typedef xsat::profile::multi_index<
+        "forktree"_n, fork_node_row,
+        eosio::indexed_by<"byheight"_n, const_mem_fun<fork_node_row, uint64_t, &fork_node_row::by_height>>,
+        eosio::indexed_by<"byblockid"_n, const_mem_fun<fork_node_row, checksum256, &fork_node_row::by_block_id>>>
+        fork_tree_table;
+
+    /**
+     * ## TABLE `chaintips`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} bucket_id` - primary key, the bucket_id of the tip consensus block
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "bucket_id": 11,
+     *   "height": 840009,
+     *   "hash": "00000000000000000000c6075e66b667adcdb8935e6d9a877f5cf140c806ae87",
+     *   "cumulative_work": "0000000000000000000000000000000000000000754133d8a3c2a45d2c8ec7e0"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] chain_tip_row {
+        uint64_t bucket_id;
+        uint64_t height;
+        checksum256 hash;
+        checksum256 cumulative_work;
+        uint64_t primary_key() const { return bucket_id; }
+        checksum256 by_work() const { return cumulative_work; }
+    };
+    typedef xsat::profile::multi_index<
+        "chaintips"_n, chain_tip_row,
+        eosio::indexed_by<"bywork"_n, const_mem_fun<chain_tip_row, checksum256, &chain_tip_row::by_work>>>
+        chain_tip_table;
+
     /**
      * ## STRUCT `process_block_result`
      *
@@ -583,6 +844,27 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
                 const uint16_t retained_spent_utxo_blocks, const uint16_t num_retain_data_blocks,
                 const uint8_t num_merkle_layer, const uint16_t num_miner_priority_blocks);
 
+    /**
+     * ## ACTION `setwatch`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Opt in to the custody watchlist. While enabled, every output created or spent during migration is looked up
+     * > in the `custody.xsat` scriptpubkey index and the balance changes are sent to `custody.xsat::syncbalances`.
+     *
+     * ### params
+     *
+     * - `{bool} custody_enabled` - whether to watch custody addresses
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat setwatch '[true]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void setwatch(const bool custody_enabled);
+
     /**
      * ## ACTION `addutxo`
      *
@@ -609,6 +891,28 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     void addutxo(const uint64_t id, const checksum256 &txid, const uint32_t index, const vector<uint8_t> &scriptpubkey,
                  const uint64_t value);
 
+    /**
+     * ## ACTION `addutxos`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Bulk import a page of a UTXO set snapshot. `tests/bench/snapshot` converts a Bitcoin Core `dumptxoutset`
+     * file into pages.
+     *
+     * ### params
+     *
+     * - `{checksum256} utxo_set_hash` - the declared UTXO set commitment after the page has been applied
+     * - `{std::vector<char>} utxos` - consecutive serialized `(checksum256 txid, uint32_t index, uint64_t value, std::vector<uint8_t> scriptpubkey)`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat addutxos '["c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0", "a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf01000000fb80e4f2000000001976a914536ffa992491508dca0354e52f32a3a7a679a53a88ac"]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void addutxos(const checksum256 &utxo_set_hash, const std::vector<char> &utxos);
+
     /**
      * ## ACTION `delutxo`
      *
@@ -679,6 +983,50 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     [[eosio::action]]
     void delblock(const uint64_t height);
 
+    /**
+     * ## ACTION `syncheaders`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Backfill the compact header index from the `blocks` table and the fork tree from the `consensusblk` table.
+     *
+     * ### params
+     *
+     * - `{uint64_t} start_height` - the first irreversible block height to backfill
+     * - `{uint64_t} rows` - number of blocks to scan, irreversible blocks first and then consensus blocks from
+     * `start_height`, 0 scans every block
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat syncheaders '[0, 1000]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void syncheaders(const uint64_t start_height, uint64_t rows);
+
+    /**
+     * ## ACTION `addheaders`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Append history block headers to the epoch archive and its MMR.
+     *
+     * ### params
+     *
+     * - `{uint64_t} start_height` - the height of the first header, the archive must start at the first block of an epoch
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block preceding the first header
+     * - `{std::vector<char>} headers` - consecutive 80-byte serialized block headers
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat addheaders '[838656, "0000000000000000000000000000000000000000739f0c837d8538b068f839a0", "0000812e28e0ae3d..."]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void addheaders(const uint64_t start_height, const checksum256 &cumulative_work, const std::vector<char> &headers);
+
     /**
      * ## ACTION `delspentutxo`
      *
@@ -777,6 +1125,9 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     [[eosio::action]]
     void setirrhash(const checksum256 &irreversible_hash);
 
+    [[eosio::action]]
+    void setmigrating(const uint64_t height, const checksum256 &hash, const name &parser);
+
     [[eosio::action]]
     vector<string> scripttoaddr(const vector<uint8_t> &scriptpubkey);
 
@@ -795,6 +1146,9 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
                       const uint32_t bits, const uint32_t nonce, const name &synchronizer, const name &miner,
                       const time_point_sec &created_at);
 
+    [[eosio::action]]
+    consensus_block_row nextirrblk(const uint64_t irreversible_height, const checksum256 &irreversible_hash);
+
     void resetpending(uint64_t row);
 #endif
 
@@ -814,7 +1168,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         ds << height;
         ds << hash;
         ds << type;
-        return eosio::sha256((char *)result.data(), result.size());
+        return xsat::profile::sha256((char *)result.data(), result.size());
     }
 
     static checksum256 compute_scriptpubkey_id_for_block(const uint64_t height, const checksum256 &hash,
@@ -825,7 +1179,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         ds << height;
         ds << hash;
         ds << scriptpubkey;
-        return eosio::sha256((char *)result.data(), result.size());
+        return xsat::profile::sha256((char *)result.data(), result.size());
     }
 
     static checksum256 compute_utxo_id_for_block(const uint64_t height, const checksum256 &hash,
@@ -837,7 +1191,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         ds << hash;
         ds << tx_id;
         ds << index;
-        return eosio::sha256((char *)result.data(), result.size());
+        return xsat::profile::sha256((char *)result.data(), result.size());
     }
 
     static uint128_t compute_parse_height(const bool parse, const uint64_t height) {
@@ -845,67 +1199,108 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     }
 
     static bool check_consensus(const uint64_t height, const eosio::checksum256 &hash) {
-        utxo_manage::consensus_block_table _consensus_block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-        auto consensus_block_idx = _consensus_block.get_index<"byblockid"_n>();
-        auto consensus_block_itr = consensus_block_idx.find(xsat::utils::compute_block_id(height, hash));
-        if (consensus_block_itr != consensus_block_idx.end())
+        utxo_manage::header_table _header(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        if (_header.find(height) != _header.end())
             return true;
 
-        utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-        auto block_itr = _block.find(height);
-        return block_itr != _block.end();
+        if (height <= START_HEIGHT && get_archived_header(height).has_value())
+            return true;
+
+        utxo_manage::fork_tree_table _fork_tree(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        auto fork_node_idx = _fork_tree.get_index<"byblockid"_n>();
+        return fork_node_idx.find(xsat::utils::compute_block_id(height, hash)) != fork_node_idx.end();
     }
 
     static optional<bitcoin::core::block> get_ancestor(const uint64_t height, const optional<checksum256> hash) {
-        utxo_manage::consensus_block_table _consensus_block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-        optional<bitcoin::core::block> result = std::nullopt;
-        if (hash.has_value()) {
-            auto consensus_block_idx = _consensus_block.get_index<"byblockid"_n>();
-            auto consensus_block_itr = consensus_block_idx.find(xsat::utils::compute_block_id(height, *hash));
-            if (consensus_block_itr != consensus_block_idx.end()) {
-                return bitcoin::core::block{.height = height,
-                                            .hash = consensus_block_itr->hash,
-                                            .previous_block_hash = consensus_block_itr->previous_block_hash,
-                                            .cumulative_work = consensus_block_itr->cumulative_work,
-                                            .timestamp = consensus_block_itr->timestamp,
-                                            .bits = consensus_block_itr->bits};
+        // main chain, difficulty checks walk back over the same headers so they are read through the cache
+        const auto& header = xsat::cache::find<utxo_manage::header_table>(UTXO_MANAGE_CONTRACT,
+                                                                          UTXO_MANAGE_CONTRACT.value, height);
+        if (header.has_value() && (!hash.has_value() || header->hash == *hash)) {
+            return bitcoin::core::block{.height = height,
+                                        .hash = header->hash,
+                                        .previous_block_hash = header->previous_block_hash,
+                                        .cumulative_work = header->cumulative_work,
+                                        .timestamp = header->timestamp,
+                                        .bits = header->bits};
+        }
+
+        // history headers that have been archived
+        if (!header.has_value() && height <= START_HEIGHT) {
+            auto archived_block = get_archived_header(height);
+            if (archived_block.has_value() && (!hash.has_value() || archived_block->hash == *hash)) {
+                return archived_block;
             }
+        }
 
-            utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-            auto block_idx = _block.get_index<"byhash"_n>();
-            auto block_itr = block_idx.find(*hash);
-            if (block_itr != block_idx.end()) {
-                return bitcoin::core::block{.height = height,
-                                            .hash = block_itr->hash,
-                                            .previous_block_hash = block_itr->previous_block_hash,
-                                            .cumulative_work = block_itr->cumulative_work,
-                                            .timestamp = block_itr->timestamp,
-                                            .bits = block_itr->bits};
+        // forks that have reached consensus but are not yet irreversible
+        utxo_manage::fork_tree_table _fork_tree(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        auto fork_node_itr = _fork_tree.end();
+        if (hash.has_value()) {
+            auto fork_node_idx = _fork_tree.get_index<"byblockid"_n>();
+            auto fork_node_idx_itr = fork_node_idx.find(xsat::utils::compute_block_id(height, *hash));
+            if (fork_node_idx_itr != fork_node_idx.end()) {
+                fork_node_itr = _fork_tree.iterator_to(*fork_node_idx_itr);
             }
         } else {
-            auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
-            auto consensus_block_itr = consensus_block_idx.find(height);
-            if (consensus_block_itr != consensus_block_idx.end()) {
-                return bitcoin::core::block{.height = height,
-                                            .hash = consensus_block_itr->hash,
-                                            .previous_block_hash = consensus_block_itr->previous_block_hash,
-                                            .cumulative_work = consensus_block_itr->cumulative_work,
-                                            .timestamp = consensus_block_itr->timestamp,
-                                            .bits = consensus_block_itr->bits};
+            auto fork_node_idx = _fork_tree.get_index<"byheight"_n>();
+            auto fork_node_idx_itr = fork_node_idx.find(height);
+            if (fork_node_idx_itr != fork_node_idx.end()) {
+                fork_node_itr = _fork_tree.iterator_to(*fork_node_idx_itr);
             }
+        }
+        if (fork_node_itr == _fork_tree.end()) {
+            return std::nullopt;
+        }
+        return bitcoin::core::block{.height = height,
+                                    .hash = fork_node_itr->hash,
+                                    .previous_block_hash = fork_node_itr->previous_block_hash,
+                                    .cumulative_work = fork_node_itr->cumulative_work,
+                                    .timestamp = fork_node_itr->timestamp,
+                                    .bits = fork_node_itr->bits};
+    }
+
+    static optional<bitcoin::core::block> get_archived_header(const uint64_t height) {
+        const auto epoch_size = CHAIN_PARAMS.difficulty_adjustment_interval();
+        // an epoch row holds up to 2016 headers, deserialize it once per action
+        const auto& header_epoch = xsat::cache::find<utxo_manage::header_epoch_table>(
+            UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value, height / epoch_size);
+        const uint64_t index = height % epoch_size;
+        if (!header_epoch.has_value() || header_epoch->headers.size() <= index * BLOCK_HEADER_SIZE) {
+            return std::nullopt;
+        }
 
-            utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-            auto block_itr = _block.find(height);
-            if (block_itr != _block.end()) {
-                return bitcoin::core::block{.height = height,
-                                            .hash = block_itr->hash,
-                                            .previous_block_hash = block_itr->previous_block_hash,
-                                            .cumulative_work = block_itr->cumulative_work,
-                                            .timestamp = block_itr->timestamp,
-                                            .bits = block_itr->bits};
+        // Only the cumulative work preceding the epoch is stored, accumulate the work up to the header
+        eosio::datastream<const char *> ds(header_epoch->headers.data(), header_epoch->headers.size());
+        auto cumulative_work = bitcoin::be_uint_from_checksum256(header_epoch->cumulative_work);
+        bitcoin::core::block_header block_header;
+        uint32_t bits = 0;
+        bitcoin::uint256_t work = 0;
+        for (uint64_t i = 0; i <= index; i++) {
+            ds >> block_header;
+            if (block_header.bits != bits) {
+                bits = block_header.bits;
+                work = block_header.work();
             }
+            cumulative_work += work;
         }
-        return result;
+        return bitcoin::core::block{.height = height,
+                                    .hash = bitcoin::be_checksum256_from_uint(block_header.hash()),
+                                    .previous_block_hash
+                                    = bitcoin::be_checksum256_from_uint(block_header.previous_block_hash),
+                                    .cumulative_work = bitcoin::be_checksum256_from_uint(cumulative_work),
+                                    .timestamp = block_header.timestamp,
+                                    .bits = block_header.bits};
+    }
+
+    // returns the tip with the largest cumulative work
+    static optional<chain_tip_row> get_best_tip() {
+        utxo_manage::chain_tip_table _chain_tip(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        auto chain_tip_idx = _chain_tip.get_index<"bywork"_n>();
+        auto chain_tip_itr = chain_tip_idx.end();
+        if (chain_tip_itr == chain_tip_idx.begin()) {
+            return std::nullopt;
+        }
+        return *(--chain_tip_itr);
     }
 
    private:
@@ -917,7 +1312,19 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     pending_utxo_table _pending_utxo = pending_utxo_table(_self, _self.value);
     spent_utxo_table _spent_utxo = spent_utxo_table(_self, _self.value);
     block_table _block = block_table(_self, _self.value);
+    header_table _header = header_table(_self, _self.value);
+    utxo_commit_table _utxo_commit = utxo_commit_table(_self, _self.value);
+    utxo_checkpoint_table _utxo_checkpoint = utxo_checkpoint_table(_self, _self.value);
+    header_epoch_table _header_epoch = header_epoch_table(_self, _self.value);
+    header_archive_table _header_archive = header_archive_table(_self, _self.value);
+    watch_config_table _watch_config = watch_config_table(_self, _self.value);
     consensus_block_table _consensus_block = consensus_block_table(_self, _self.value);
+    fork_tree_table _fork_tree = fork_tree_table(_self, _self.value);
+    chain_tip_table _chain_tip = chain_tip_table(_self, _self.value);
+
+#ifdef PROFILE
+    xsat::profile::recorder _profile = {_self};
+#endif
 
     // private function
     void parsing_transactions(const uint64_t height, const checksum256 &hash, parsing_progress_row *parsing_progress,
@@ -928,6 +1335,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     void delete_data(utxo_manage::chain_state_row &chain_state, const uint16_t retained_spent_utxo_blocks,
                      const uint16_t num_retain_data_blocks, uint64_t process_row);
 
+    void finish_migration(utxo_manage::chain_state_row &chain_state);
+
     void find_set_next_parsable_block(chain_state_row &chain_state, const uint16_t parse_timeout_seconds);
 
     consensus_block_row find_next_irreversible_block(const uint64_t irreversible_height,
@@ -935,6 +1344,13 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
 
     void find_set_next_irreversible_block(chain_state_row &chain_state);
 
+    void update_chain_tips(const consensus_block_row &consensus_block);
+
+    void save_header(const uint64_t height, const checksum256 &hash, const checksum256 &previous_block_hash,
+                     const checksum256 &cumulative_work, const uint32_t timestamp, const uint32_t bits);
+
+    void erase_fork_node(const uint64_t bucket_id);
+
     void save_spent_utxo(const uint64_t height, const utxo_manage::utxo_row &pending_utxo);
 
     void save_pending_utxo(const uint64_t height, const checksum256 &hash, const checksum256 &txid,
@@ -947,6 +1363,13 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     utxo_row save_utxo(const checksum256 &txid, const uint32_t index, const std::vector<uint8_t> &script_data,
                        const uint64_t value);
 
+    void update_utxo_set_hash(checksum256 &utxo_set_hash, const checksum256 &txid, const uint32_t index,
+                              const std::vector<uint8_t> &scriptpubkey, const uint64_t value, const bool spent);
+
+    template <typename IDX>
+    void watch_custody(IDX &custody_idx, map<uint64_t, int64_t> &custody_deltas,
+                       const std::vector<uint8_t> &scriptpubkey, const int64_t value);
+
 #ifdef DEBUG
     template <typename T>
     void clear_table(T &table, uint64_t rows_to_clear);
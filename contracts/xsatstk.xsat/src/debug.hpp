@@ -24,6 +24,8 @@ void xsat_stake::cleartable(const name table_name, const optional<name> scope, c
         clear_table(_staking, rows_to_clear);
     else if (table_name == "releases"_n)
         clear_table(_release, rows_to_clear);
+    else if (table_name == "withdrawable"_n)
+        clear_table(_withdrawable, rows_to_clear);
     else
         check(false, "xsatstk.xsat::cleartable: [table_name] unknown table to clear");
 }
@@ -22,19 +22,14 @@ void xsat_stake::setstatus(const bool disabled_staking) {
 void xsat_stake::withdraw(const name& staker) {
     require_auth(staker);
 
-    time_point_sec now_time = current_time_point();
-    auto _release = release_table(get_self(), staker.value);
-    auto release_idx = _release.get_index<"byexpire"_n>();
-    auto release_itr = release_idx.lower_bound(0);
-    auto end_release_itr = release_idx.upper_bound(now_time.sec_since_epoch());
+    collect_expired_releases(staker);
 
-    check(release_itr != end_release_itr, "xsatstk.xsat::withdraw: there is no expired token that can be withdrawn");
+    auto withdrawable_itr = _withdrawable.find(staker.value);
+    check(withdrawable_itr != _withdrawable.end(),
+          "xsatstk.xsat::withdraw: there is no expired token that can be withdrawn");
 
-    auto max_row = 100;
-    while (release_itr != end_release_itr && max_row--) {
-        token_transfer(get_self(), staker, {release_itr->quantity, EXSAT_CONTRACT}, "release");
-        release_itr = release_idx.erase(release_itr);
-    }
+    token_transfer(get_self(), staker, {withdrawable_itr->quantity, EXSAT_CONTRACT}, "release");
+    _withdrawable.erase(withdrawable_itr);
 }
 
 //@auth staker
@@ -50,6 +45,9 @@ void xsat_stake::release(const name& staker, const name& validator, const asset&
         row.quantity -= quantity;
     });
 
+    // move releases that have already expired out of the way
+    collect_expired_releases(staker);
+
     // save release
     auto _release = release_table(get_self(), staker.value);
     auto id = next_release_id();
@@ -116,6 +114,34 @@ asset xsat_stake::get_balance(const name& owner, const extended_symbol& token) {
     return ac->balance;
 }
 
+void xsat_stake::collect_expired_releases(const name& staker) {
+    time_point_sec now_time = current_time_point();
+    auto _release = release_table(get_self(), staker.value);
+    auto release_idx = _release.get_index<"byexpire"_n>();
+    auto release_itr = release_idx.lower_bound(0);
+    auto end_release_itr = release_idx.upper_bound(now_time.sec_since_epoch());
+    if (release_itr == end_release_itr) return;
+
+    asset expired_quantity = {0, XSAT_SYMBOL};
+    auto max_row = 100;
+    while (release_itr != end_release_itr && max_row--) {
+        expired_quantity += release_itr->quantity;
+        release_itr = release_idx.erase(release_itr);
+    }
+
+    auto withdrawable_itr = _withdrawable.find(staker.value);
+    if (withdrawable_itr == _withdrawable.end()) {
+        _withdrawable.emplace(get_self(), [&](auto& row) {
+            row.staker = staker;
+            row.quantity = expired_quantity;
+        });
+    } else {
+        _withdrawable.modify(withdrawable_itr, same_payer, [&](auto& row) {
+            row.quantity += expired_quantity;
+        });
+    }
+}
+
 uint64_t xsat_stake::next_release_id() {
     global_id_row global_id = _global_id.get_or_default();
     global_id.release_id++;
@@ -112,6 +112,31 @@ class [[eosio::contract("xsatstk.xsat")]] xsat_stake : public contract {
         eosio::indexed_by<"byexpire"_n, const_mem_fun<release_row, uint64_t, &release_row::by_expiration_time>>>
         release_table;
 
+    /**
+     * ## TABLE `withdrawable`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{name} staker` - the staker account
+     * - `{asset} quantity` - expired release quantity waiting to be withdrawn
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "staker": "alice",
+     *   "quantity": "1.00000000 XSAT"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] withdrawable_row {
+        name staker;
+        asset quantity;
+        uint64_t primary_key() const { return staker.value; }
+    };
+    typedef eosio::multi_index<"withdrawable"_n, withdrawable_row> withdrawable_table;
+
     /**
      * ## ACTION `setstatus`
      *
@@ -159,7 +184,7 @@ class [[eosio::contract("xsatstk.xsat")]] xsat_stake : public contract {
      *
      * - **authority**: `staker`
      *
-     * > Withdraw expired staking tokens.
+     * > Withdraw expired staking tokens with a single transfer.
      *
      * ### params
      *
@@ -187,8 +212,10 @@ class [[eosio::contract("xsatstk.xsat")]] xsat_stake : public contract {
     global_id_table _global_id = global_id_table(_self, _self.value);
     config_table _config = config_table(_self, _self.value);
     staking_table _staking = staking_table(_self, _self.value);
+    withdrawable_table _withdrawable = withdrawable_table(_self, _self.value);
 
     uint64_t next_release_id();
+    void collect_expired_releases(const name& staker);
     asset get_balance(const name& owner, const extended_symbol& token);
     void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
     void do_stake(const name& from, const name& validator, const asset& quantity);
@@ -26,11 +26,7 @@ namespace bitcoin::core {
     bitcoin::uint256_t generate_witness_merkle(std::vector<eosio::checksum256>& hashes,
                                                const eosio::checksum256& witness_reserved_value) {
         bitcoin::uint256_t witness_merkle = generate_merkle_root(hashes);
-        auto concatenated_hashes = std::array<uint8_t, 64>();
-        auto ds = eosio::datastream<uint8_t*>(concatenated_hashes.data(), concatenated_hashes.size());
-        ds << witness_merkle << witness_reserved_value;
-
-        return bitcoin::dhash(concatenated_hashes);
+        return bitcoin::dhash_nodes(witness_merkle, bitcoin::le_uint_from_checksum256(witness_reserved_value));
     }
 
     bitcoin::uint256_t generate_witness_merkle(const std::vector<bitcoin::core::transaction>& transactions,
@@ -48,8 +44,7 @@ namespace bitcoin::core {
             transaction_hashes.emplace_back(std::move(hash));
         }
 
-        auto cur_hashes = std::vector<bitcoin::uint256_t>(transaction_hashes);
-        return bitcoin::generate_merkle_root(cur_hashes, mutated);
+        return bitcoin::generate_merkle_root(transaction_hashes, mutated);
     }
     struct block_header {
         uint32_t version;
@@ -92,11 +87,7 @@ namespace bitcoin::core {
                                     const uint256_t& witness_reserved_value, const uint256_t& witness_commitment,
                                     bool* mutated) {
             bitcoin::uint256_t witness_merkle = generate_witness_merkle(transactions, mutated);
-            auto concatenated_hashes = std::array<uint8_t, 64>();
-            auto ds = eosio::datastream<uint8_t*>(concatenated_hashes.data(), concatenated_hashes.size());
-            ds << witness_merkle << witness_reserved_value;
-
-            auto expected_witness_commitment = bitcoin::dhash(concatenated_hashes);
+            auto expected_witness_commitment = bitcoin::dhash_nodes(witness_merkle, witness_reserved_value);
 
             return witness_commitment == expected_witness_commitment;
         }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <intx/intx.hpp>
+#include <array>
+#include <string_view>
+#include <vector>
+
 namespace bitcoin::core {
     enum base58_type {
         PUBKEY_ADDRESS,
@@ -26,25 +31,30 @@ namespace bitcoin::core {
         uint32_t bits;
     };
 
+    // chain parameters are literal types so that `CHAIN_PARAMS` is built at compile time
     struct Params {
         int BIP34_height;
         int BIP65_height;
         int BIP66_height;
         int CSV_height;
         int Segwit_height;
-        std::string pow_limit;
+        intx::uint256 pow_limit;
         bool pow_allow_min_difficulty_blocks;
         bool enforce_BIP94;
         bool pow_no_retargeting;
         uint64_t pow_target_spacing;
         uint64_t pow_target_timespan;
 
-        std::vector<unsigned char> base58Prefixes[MAX_BASE58_TYPES];
-        std::string bech32_hrp;
+        std::array<unsigned char, 1> base58Prefixes[MAX_BASE58_TYPES];
+        std::string_view bech32_hrp;
+
+        std::vector<unsigned char> base58_prefix(base58_type type) const {
+            return {base58Prefixes[type].begin(), base58Prefixes[type].end()};
+        }
 
-        uint64_t difficulty_adjustment_interval() const { return pow_target_timespan / pow_target_spacing; }
+        constexpr uint64_t difficulty_adjustment_interval() const { return pow_target_timespan / pow_target_spacing; }
 
-        int deployment_height(buried_deployment dep) const {
+        constexpr int deployment_height(buried_deployment dep) const {
             switch (dep) {
                 case DEPLOYMENT_HEIGHTINCB:
                     return BIP34_height;
@@ -8,7 +8,7 @@ namespace bitcoin::core {
     typedef std::optional<block>(GetAncestor)(const uint64_t, const optional<checksum256>);
 
     bitcoin::uint256_t get_pow_limit(const bitcoin::core::Params& params) {
-        return intx::from_string<bitcoin::uint256_t>(params.pow_limit);
+        return params.pow_limit;
     }
 
     uint32_t calculate_next_work_required(const block& prev_block, const uint32_t first_block_time,
@@ -68,7 +68,10 @@ namespace bitcoin::core {
             ds << locktime;
         }
 
-        uint256_t merkle_hash() const {
+        // without the segwit marker and flag the raw bytes are already the serialization hashed for the txid
+        bool has_segwit_marker() const { return (*data)[from + 4] == 0 && (*data)[from + 5] == 1; }
+
+        std::vector<char> merkle_data() const {
             eosio::datastream<size_t> ps;
             serialize_for_merkle(ps);
             auto serialized_size = ps.tellp();
@@ -76,7 +79,23 @@ namespace bitcoin::core {
             hash_data.resize(serialized_size);
             eosio::datastream<char*> ds(hash_data.data(), hash_data.size());
             serialize_for_merkle(ds);
-            return bitcoin::dhash(hash_data);
+            return hash_data;
+        }
+
+        uint256_t merkle_hash() const {
+            if (!has_segwit_marker()) {
+                return hash();
+            }
+            return bitcoin::dhash(merkle_data());
+        }
+
+        // txid in display byte order
+        eosio::checksum256 txid() const {
+            if (!has_segwit_marker()) {
+                return bitcoin::dhash_to_checksum256(data->data() + from, to - from);
+            }
+            const auto hash_data = merkle_data();
+            return bitcoin::dhash_to_checksum256(hash_data.data(), hash_data.size());
         }
 
         uint256_t hash() const {
@@ -184,6 +203,7 @@ namespace eosio {
  */
     template <typename Stream>
     datastream<Stream>& operator>>(datastream<Stream>& ds, bitcoin::core::transaction& v) {
+        BITCOIN_PROFILE_COUNT(deserializations, 1);
         v.from = ds.tellp();
         ds >> v.version;
         auto rewind = ds.tellp();
@@ -244,19 +244,19 @@ namespace bitcoin {
             if (vSolutions[0].size() == 0) {
                 return false;
             }
-            std::vector<unsigned char> data = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
+            std::vector<unsigned char> data = params.base58_prefix(bitcoin::core::base58_type::PUBKEY_ADDRESS);
             data.insert(data.end(), vSolutions[0].begin(), vSolutions[0].end());
             addressRet.push_back(bitcoin::EncodeBase58Check(data));
 
             return true;
         } else if (whichType == TxoutType::PUBKEYHASH) {
-            std::vector<unsigned char> data = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
+            std::vector<unsigned char> data = params.base58_prefix(bitcoin::core::base58_type::PUBKEY_ADDRESS);
             data.insert(data.end(), vSolutions[0].begin(), vSolutions[0].begin() + 20);
             addressRet.push_back(bitcoin::EncodeBase58Check(data));
 
             return true;
         } else if (whichType == TxoutType::SCRIPTHASH) {
-            std::vector<unsigned char> data = params.base58Prefixes[bitcoin::core::base58_type::SCRIPT_ADDRESS];
+            std::vector<unsigned char> data = params.base58_prefix(bitcoin::core::base58_type::SCRIPT_ADDRESS);
             data.insert(data.end(), vSolutions[0].begin(), vSolutions[0].begin() + 20);
             addressRet.push_back(bitcoin::EncodeBase58Check(data));
             return true;
@@ -268,7 +268,8 @@ namespace bitcoin {
                     data.push_back(c);
                 },
                 vSolutions[0].begin(), vSolutions[0].end());
-            addressRet.push_back(bitcoin::bech32::Encode(bech32::Encoding::BECH32, params.bech32_hrp, data));
+            addressRet.push_back(
+                bitcoin::bech32::Encode(bech32::Encoding::BECH32, std::string(params.bech32_hrp), data));
             return true;
         } else if (whichType == TxoutType::WITNESS_V0_SCRIPTHASH) {
             std::vector<unsigned char> data = {0};
@@ -279,7 +280,8 @@ namespace bitcoin {
                 },
                 vSolutions[0].begin(), vSolutions[0].end());
 
-            addressRet.push_back(bitcoin::bech32::Encode(bech32::Encoding::BECH32, params.bech32_hrp, data));
+            addressRet.push_back(
+                bitcoin::bech32::Encode(bech32::Encoding::BECH32, std::string(params.bech32_hrp), data));
             return true;
         } else if (whichType == TxoutType::WITNESS_V1_TAPROOT) {
             std::vector<unsigned char> data = {1};
@@ -290,7 +292,8 @@ namespace bitcoin {
                 },
                 vSolutions[0].begin(), vSolutions[0].end());
 
-            addressRet.push_back(bitcoin::bech32::Encode(bech32::Encoding::BECH32M, params.bech32_hrp, data));
+            addressRet.push_back(
+                bitcoin::bech32::Encode(bech32::Encoding::BECH32M, std::string(params.bech32_hrp), data));
             return true;
         } else if (whichType == TxoutType::WITNESS_UNKNOWN) {
             unsigned int version = vSolutions[0][0];
@@ -306,14 +309,15 @@ namespace bitcoin {
                     data.push_back(c);
                 },
                 vSolutions[1].begin(), vSolutions[1].begin() + length);
-            addressRet.push_back(bitcoin::bech32::Encode(bech32::Encoding::BECH32M, params.bech32_hrp, data));
+            addressRet.push_back(
+                bitcoin::bech32::Encode(bech32::Encoding::BECH32M, std::string(params.bech32_hrp), data));
             return true;
         } else if (whichType == TxoutType::MULTISIG) {
             for (unsigned int i = 1; i < vSolutions.size() - 1; i++) {
                 if (vSolutions[i].size() == 0) {
                     continue;
                 }
-                std::vector<unsigned char> data = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
+                std::vector<unsigned char> data = params.base58_prefix(bitcoin::core::base58_type::PUBKEY_ADDRESS);
                 data.insert(data.end(), vSolutions[i].begin(), vSolutions[i].end());
                 addressRet.push_back(bitcoin::EncodeBase58Check(data));
             }
@@ -336,8 +340,7 @@ namespace bitcoin {
             // base58-encoded Bitcoin addresses.
             // Public-key-hash-addresses have version 0 (or 111 testnet).
             // The data vector contains RIPEMD160(SHA256(pubkey)), where pubkey is the serialized public key.
-            const std::vector<unsigned char>& pubkey_prefix
-                = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
+            const auto& pubkey_prefix = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
             if (data.size() == 20 + pubkey_prefix.size()
                 && std::equal(pubkey_prefix.begin(), pubkey_prefix.end(), data.begin())) {
                 script.reserve(25);
@@ -351,8 +354,7 @@ namespace bitcoin {
             }
             // Script-hash-addresses have version 5 (or 196 testnet).
             // The data vector contains RIPEMD160(SHA256(cscript)), where cscript is the serialized redemption script.
-            const std::vector<unsigned char>& script_prefix
-                = params.base58Prefixes[bitcoin::core::base58_type::SCRIPT_ADDRESS];
+            const auto& script_prefix = params.base58Prefixes[bitcoin::core::base58_type::SCRIPT_ADDRESS];
             if (data.size() == 20 + script_prefix.size()
                 && std::equal(script_prefix.begin(), script_prefix.end(), data.begin())) {
                 script.reserve(23);
@@ -392,8 +394,8 @@ namespace bitcoin {
             }
             // Bech32 decoding
             if (dec.hrp != params.bech32_hrp) {
-                error_str = "Invalid or unsupported prefix for Segwit (Bech32) address (expected " + params.bech32_hrp
-                            + ", got " + dec.hrp + ").";
+                error_str = "Invalid or unsupported prefix for Segwit (Bech32) address (expected "
+                            + std::string(params.bech32_hrp) + ", got " + dec.hrp + ").";
                 return false;
             }
             int version = dec.data[0];  // The first 5 bit symbol is the witness version (0-16)
@@ -483,16 +485,14 @@ namespace bitcoin {
             // base58-encoded Bitcoin addresses.
             // Public-key-hash-addresses have version 0 (or 111 testnet).
             // The data vector contains RIPEMD160(SHA256(pubkey)), where pubkey is the serialized public key.
-            const std::vector<unsigned char>& pubkey_prefix
-                = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
+            const auto& pubkey_prefix = params.base58Prefixes[bitcoin::core::base58_type::PUBKEY_ADDRESS];
             if (data.size() == 20 + pubkey_prefix.size()
                 && std::equal(pubkey_prefix.begin(), pubkey_prefix.end(), data.begin())) {
                 return true;
             }
             // Script-hash-addresses have version 5 (or 196 testnet).
             // The data vector contains RIPEMD160(SHA256(cscript)), where cscript is the serialized redemption script.
-            const std::vector<unsigned char>& script_prefix
-                = params.base58Prefixes[bitcoin::core::base58_type::SCRIPT_ADDRESS];
+            const auto& script_prefix = params.base58Prefixes[bitcoin::core::base58_type::SCRIPT_ADDRESS];
             if (data.size() == 20 + script_prefix.size()
                 && std::equal(script_prefix.begin(), script_prefix.end(), data.begin())) {
                 return true;
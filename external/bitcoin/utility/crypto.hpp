@@ -4,41 +4,78 @@
 #include <eosio/crypto.hpp>
 #include <eosio/datastream.hpp>
 #include <eosio/serialize.hpp>
+#include <array>
+#include <cstring>
+
+// operation counts of `-DPROFILE` builds, read by the embedding code
+#ifdef PROFILE
+namespace bitcoin::profile {
+    inline uint64_t sha256 = 0;
+    inline uint64_t deserializations = 0;
+}  // namespace bitcoin::profile
+#define BITCOIN_PROFILE_COUNT(counter, n) (bitcoin::profile::counter += (n))
+#else
+#define BITCOIN_PROFILE_COUNT(counter, n) ((void)0)
+#endif
 
 namespace bitcoin {
+    // double-sha256 of `len` bytes written to `out` in the byte order of the digest, without heap allocations
+    inline void dhash(const char* data, const size_t len, std::array<uint8_t, 32>& out) {
+        out = eosio::sha256(data, len).extract_as_byte_array();
+        out = eosio::sha256((const char*)out.data(), out.size()).extract_as_byte_array();
+        BITCOIN_PROFILE_COUNT(sha256, 2);
+    }
+
+    // double-sha256 of the concatenation of two 32-byte nodes
+    inline void dhash_nodes(const uint8_t* left, const uint8_t* right, std::array<uint8_t, 32>& out) {
+        std::array<uint8_t, 64> concatenated;
+        std::memcpy(concatenated.data(), left, 32);
+        std::memcpy(concatenated.data() + 32, right, 32);
+        dhash((const char*)concatenated.data(), concatenated.size(), out);
+    }
+
+    // merkle parent of two nodes stored as little-endian integers
+    inline bitcoin::uint256_t dhash_nodes(const bitcoin::uint256_t& left, const bitcoin::uint256_t& right) {
+        std::array<uint8_t, 64> concatenated;
+        intx::le::unsafe::store<bitcoin::uint256_t>(concatenated.data(), left);
+        intx::le::unsafe::store<bitcoin::uint256_t>(concatenated.data() + 32, right);
+        std::array<uint8_t, 32> out;
+        dhash((const char*)concatenated.data(), concatenated.size(), out);
+        return intx::le::unsafe::load<bitcoin::uint256_t>(out.data());
+    }
+
+    // double-sha256 as a checksum256 in display byte order, e.g. a txid or a block hash
+    inline eosio::checksum256 dhash_to_checksum256(const char* data, const size_t len) {
+        std::array<uint8_t, 32> out;
+        dhash(data, len, out);
+        bitcoin::reverse_bytes(out);
+        return eosio::checksum256(out);
+    }
+
     template <typename T>
     bitcoin::uint256_t dhash(const T& data) {
         auto packed_data = eosio::pack(data);
-        auto h = eosio::sha256((char*)packed_data.data(), packed_data.size());
-        auto buffer = h.extract_as_byte_array();
-        h = eosio::sha256((char*)buffer.data(), buffer.size());
-        return bitcoin::le_uint_from_checksum256(h);
+        return dhash((const char*)packed_data.data(), packed_data.size());
     }
 
     template <typename T>
     bitcoin::uint256_t dhash(T* data, size_t len) {
-        auto h = eosio::sha256(data, len);
-        auto buffer = h.extract_as_byte_array();
-        h = eosio::sha256((char*)buffer.data(), buffer.size());
-        return bitcoin::le_uint_from_checksum256(h);
+        std::array<uint8_t, 32> out;
+        dhash((const char*)data, len, out);
+        return intx::le::unsafe::load<bitcoin::uint256_t>(out.data());
     }
 
     template <typename T>
     auto dhash(const std::vector<T>& data) -> std::enable_if_t<sizeof(T) == 1, bitcoin::uint256_t> {
-        auto h = eosio::sha256((char*)data.data(), data.size());
-        auto buffer = h.extract_as_byte_array();
-        h = eosio::sha256((char*)buffer.data(), buffer.size());
-        return bitcoin::le_uint_from_checksum256(h);
+        return dhash(data.data(), data.size());
     }
 
     template <typename T, size_t N>
     auto dhash(const std::array<T, N>& data) -> std::enable_if_t<sizeof(T) == 1, bitcoin::uint256_t> {
-        auto h = eosio::sha256((char*)data.data(), data.size());
-        auto buffer = h.extract_as_byte_array();
-        h = eosio::sha256((char*)buffer.data(), buffer.size());
-        return bitcoin::le_uint_from_checksum256(h);
+        return dhash(data.data(), data.size());
     }
 
+    // computes the root in place, `hashes` holds the intermediate layers
     bitcoin::uint256_t generate_merkle_root(std::vector<bitcoin::uint256_t>& hashes, bool* mutated = nullptr) {
         bool mutation = false;
         while (hashes.size() > 1) {
@@ -54,18 +91,10 @@ namespace bitcoin {
             }
 
             // combine hashes
-            auto new_hashes = std::vector<bitcoin::uint256_t>();
-            new_hashes.reserve(hashes.size() / 2);
-            for (auto i = 0; i < hashes.size(); i += 2) {
-                auto concatenated_hashes = std::array<uint8_t, 64>();
-                auto ds = eosio::datastream<uint8_t*>(concatenated_hashes.data(), concatenated_hashes.size());
-                ds << hashes[i] << hashes[i + 1];
-
-                auto h = bitcoin::dhash(concatenated_hashes);
-                new_hashes.push_back(h);
+            for (size_t i = 0; i < hashes.size(); i += 2) {
+                hashes[i / 2] = bitcoin::dhash_nodes(hashes[i], hashes[i + 1]);
             }
-
-            hashes = std::move(new_hashes);
+            hashes.resize(hashes.size() / 2);
         }
         if (mutated) *mutated = mutation;
         if (hashes.size() == 0) return bitcoin::uint256_t(0);
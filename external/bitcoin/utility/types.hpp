@@ -1,7 +1,9 @@
 #pragma once
 
 #include <intx/intx.hpp>
+#include <algorithm>
 #include <array>
+#include <cstring>
 
 namespace bitcoin {
     using uint256_t = intx::uint256;
@@ -27,12 +29,23 @@ namespace bitcoin {
         return eosio::checksum256(buffer);
     }
 
-    eosio::checksum256 checksum256_from_vector(const std::vector<uint8_t>& vec) {
+    // reverses the byte order in place, e.g. between the digest order and the display order of a hash
+    inline void reverse_bytes(std::array<uint8_t, 32>& bytes) {
+        std::reverse(bytes.begin(), bytes.end());
+    }
+
+    // builds a checksum256 directly from 32 bytes
+    inline eosio::checksum256 checksum256_from_bytes(const uint8_t* data) {
         std::array<uint8_t, 32> buffer;
-        std::copy(vec.begin(), vec.end(), buffer.data());
+        std::memcpy(buffer.data(), data, buffer.size());
         return eosio::checksum256(buffer);
     }
 
+    eosio::checksum256 checksum256_from_vector(const std::vector<uint8_t>& vec) {
+        eosio::check(vec.size() == 32, "checksum256 requires 32 bytes");
+        return checksum256_from_bytes(vec.data());
+    }
+
     namespace varint {
         template <typename Stream>
         uint64_t decode(eosio::datastream<Stream>& ds) {
@@ -0,0 +1,87 @@
+const fs = require('fs')
+const path = require('path')
+const { contracts, BLOCKS, setup, replay } = require('./pipeline')
+
+// Replays the mainnet fixtures through the full upload, verify, endorse and parse pipeline and records the elapsed
+// time of every hot action, keyed by the stage it executed. Results are compared against a baseline recorded on the
+// same machine and stages that regress by more than the threshold are reported.
+//
+// The gate is advisory: wall-clock time depends on the machine, its load and the host WebAssembly engine, so a
+// regression only fails the suite with BENCH_STRICT set. The deterministic gate is the operation counts asserted by
+// tests/profile.spec.js.
+//
+// BENCH_BASELINE   baseline file, written on the first run (default tests/bench/baseline.json)
+// BENCH_THRESHOLD  allowed regression of the mean, as a ratio (default 0.25)
+// BENCH_MIN_MS     stages faster than this are reported but not enforced (default 1)
+// BENCH_PROCESS_ROW  `process_row` passed to `processblock` (default 0)
+// BENCH_STRICT     fail the suite on a regression instead of only reporting it
+const BASELINE = process.env.BENCH_BASELINE || path.join(__dirname, 'baseline.json')
+const THRESHOLD = Number(process.env.BENCH_THRESHOLD || 0.25)
+const MIN_MS = Number(process.env.BENCH_MIN_MS || 1)
+const PROCESS_ROW = Number(process.env.BENCH_PROCESS_ROW || 0)
+const STRICT = Boolean(process.env.BENCH_STRICT)
+
+jest.setTimeout(30 * 60 * 1000)
+
+// elapsed milliseconds of every sample, keyed by action and stage
+const samples = {}
+
+const measure = async (key, send) => {
+    const start = process.hrtime.bigint()
+    await send()
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6
+    ;(samples[key] = samples[key] || []).push(elapsed)
+}
+
+const summarize = () => {
+    const summary = {}
+    for (const [key, values] of Object.entries(samples)) {
+        const total = values.reduce((sum, value) => sum + value, 0)
+        summary[key] = {
+            calls: values.length,
+            mean_ms: total / values.length,
+            max_ms: Math.max(...values),
+            total_ms: total,
+        }
+    }
+    return summary
+}
+
+beforeAll(setup)
+
+describe('bench', () => {
+    for (const [height, hash] of BLOCKS) {
+        it(`pipeline ${height}`, async () => {
+            await replay(height, hash, { measure, process_row: PROCESS_ROW })
+
+            // pay, measured on its own since it is otherwise folded into every action above
+            await measure('pay', () =>
+                contracts.rescmng.actions.pay([height, hash, 'alice', 1, 1]).send('blksync.xsat@active')
+            )
+        })
+    }
+    it('regression', () => {
+        const summary = summarize()
+        console.table(summary)
+
+        if (!fs.existsSync(BASELINE)) {
+            fs.writeFileSync(BASELINE, JSON.stringify(summary, null, 4))
+            return
+        }
+
+        const baseline = JSON.parse(fs.readFileSync(BASELINE, 'utf8'))
+        const regressions = []
+        for (const [key, { mean_ms }] of Object.entries(summary)) {
+            const expected = baseline[key]
+            if (!expected || expected.mean_ms < MIN_MS) continue
+            if (mean_ms > expected.mean_ms * (1 + THRESHOLD)) {
+                regressions.push(`${key}: ${mean_ms.toFixed(2)}ms > ${expected.mean_ms.toFixed(2)}ms`)
+            }
+        }
+        if (!STRICT) {
+            if (regressions.length) console.warn(`timing regressions (advisory):\n${regressions.join('\n')}`)
+            return
+        }
+        expect(regressions).toEqual([])
+    })
+})
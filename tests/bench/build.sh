@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# Native benchmarks and tools, requires the CDT headers and OpenSSL
+CDT_INCLUDE=${CDT_INCLUDE:-$(dirname $(readlink -f $(which cdt-cpp)))/../include/eosiolib}
+CXXFLAGS="-std=c++17 -O2 -Wno-unknown-attributes -Wno-attributes -Wno-deprecated-declarations \
+    -I $CDT_INCLUDE/core -I $CDT_INCLUDE/contracts -I $CDT_INCLUDE/.. -I ../../contracts -I ../../external \
+    -I ../../external/intx/include"
+
+set -e
+cd "$(dirname "$0")"
+c++ replay.cpp -o replay $CXXFLAGS -lcrypto
+c++ planner.cpp -o planner $CXXFLAGS -lcrypto
+c++ planner_test.cpp -o planner_test $CXXFLAGS -lcrypto
+c++ snapshot.cpp -o snapshot $CXXFLAGS -lcrypto
+c++ snapshot_test.cpp -o snapshot_test $CXXFLAGS -lcrypto
+./planner_test ../data
+./snapshot_test ../data
+./replay ../data
@@ -0,0 +1,219 @@
+#pragma once
+
+// In-memory stand-in for `eosio::multi_index`, so contract helpers templated on their tables run natively.
+//
+// Rows live in a std::map by primary key and every `indexed_by` index in a std::multimap from its extracted key to the
+// primary key, updated on `emplace`, `modify` and `erase` like the secondary rows of the chain database.
+// `mock::table<T>` maps a contract's `eosio::multi_index` typedef to the mock with the same row and indices.
+
+#include <array>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <eosio/check.hpp>
+#include <eosio/multi_index.hpp>
+
+namespace mock {
+
+    template <eosio::name::raw TableName, typename T, typename... Indices>
+    class multi_index {
+        using rows_type = std::map<uint64_t, T>;
+
+        template <typename Index>
+        using extractor_type = typename Index::secondary_extractor_type;
+
+        template <typename Index>
+        using key_type = std::decay_t<decltype(extractor_type<Index>{}(std::declval<const T&>()))>;
+
+        template <size_t I>
+        using index_type = std::tuple_element_t<I, std::tuple<Indices...>>;
+
+        using indices_type = std::tuple<std::multimap<key_type<Indices>, uint64_t>...>;
+
+        rows_type _rows;
+        indices_type _indices;
+        uint64_t _next_primary_key = 0;
+
+        template <size_t... I>
+        void insert_keys(const T& row, std::index_sequence<I...>) {
+            (std::get<I>(_indices).emplace(extractor_type<Indices>{}(row), row.primary_key()), ...);
+        }
+
+        template <size_t I>
+        void erase_key(const T& row) {
+            auto& index = std::get<I>(_indices);
+            auto [first, last] = index.equal_range(extractor_type<index_type<I>>{}(row));
+            for (; first != last; ++first) {
+                if (first->second == row.primary_key()) {
+                    index.erase(first);
+                    return;
+                }
+            }
+        }
+
+        template <size_t... I>
+        void erase_keys(const T& row, std::index_sequence<I...>) {
+            (erase_key<I>(row), ...);
+        }
+
+        template <eosio::name::raw IndexName>
+        static constexpr size_t index_position() {
+            constexpr std::array<uint64_t, sizeof...(Indices)> names = {static_cast<uint64_t>(Indices::index_name)...};
+            for (size_t i = 0; i < names.size(); i++) {
+                if (names[i] == static_cast<uint64_t>(IndexName)) return i;
+            }
+            return names.size();
+        }
+
+       public:
+        class const_iterator {
+            typename rows_type::const_iterator _itr;
+
+           public:
+            explicit const_iterator(typename rows_type::const_iterator itr) : _itr(itr) {}
+            const T& operator*() const { return _itr->second; }
+            const T* operator->() const { return &_itr->second; }
+            const_iterator& operator++() {
+                ++_itr;
+                return *this;
+            }
+            bool operator==(const const_iterator& other) const { return _itr == other._itr; }
+            bool operator!=(const const_iterator& other) const { return _itr != other._itr; }
+        };
+
+        template <size_t I>
+        class index {
+            using map_type = std::tuple_element_t<I, indices_type>;
+            using secondary_key_type = typename map_type::key_type;
+
+            multi_index* _table;
+
+           public:
+            class const_iterator {
+                typename map_type::const_iterator _itr;
+                const multi_index* _table;
+
+               public:
+                const_iterator(typename map_type::const_iterator itr, const multi_index* table)
+                    : _itr(itr), _table(table) {}
+                const T& operator*() const { return _table->_rows.at(_itr->second); }
+                const T* operator->() const { return &**this; }
+                const_iterator& operator++() {
+                    ++_itr;
+                    return *this;
+                }
+                bool operator==(const const_iterator& other) const { return _itr == other._itr; }
+                bool operator!=(const const_iterator& other) const { return _itr != other._itr; }
+                typename map_type::const_iterator base() const { return _itr; }
+            };
+
+            explicit index(multi_index* table) : _table(table) {}
+
+            const map_type& keys() const { return std::get<I>(_table->_indices); }
+
+            const_iterator begin() const { return {keys().begin(), _table}; }
+            const_iterator end() const { return {keys().end(), _table}; }
+            const_iterator lower_bound(const secondary_key_type& key) const {
+                return {keys().lower_bound(key), _table};
+            }
+            const_iterator upper_bound(const secondary_key_type& key) const {
+                return {keys().upper_bound(key), _table};
+            }
+
+            // the first row with `key`, like the chain database
+            const_iterator find(const secondary_key_type& key) const {
+                auto itr = keys().lower_bound(key);
+                return {itr != keys().end() && itr->first == key ? itr : keys().end(), _table};
+            }
+
+            template <typename Lambda>
+            void modify(const const_iterator& itr, const eosio::name& payer, Lambda&& updater) {
+                _table->modify(_table->find(itr.base()->second), payer, std::forward<Lambda>(updater));
+            }
+
+            const_iterator erase(const_iterator itr) {
+                auto next = itr;
+                ++next;
+                _table->erase(_table->find(itr.base()->second));
+                return next;
+            }
+        };
+
+        multi_index() = default;
+        multi_index(eosio::name code, uint64_t scope) {}
+
+        const_iterator begin() const { return const_iterator(_rows.begin()); }
+        const_iterator end() const { return const_iterator(_rows.end()); }
+        const_iterator find(const uint64_t primary) const { return const_iterator(_rows.find(primary)); }
+        const_iterator lower_bound(const uint64_t primary) const { return const_iterator(_rows.lower_bound(primary)); }
+        const_iterator upper_bound(const uint64_t primary) const { return const_iterator(_rows.upper_bound(primary)); }
+
+        const_iterator require_find(const uint64_t primary, const char* error_msg = "unable to find key") const {
+            auto itr = find(primary);
+            eosio::check(itr != end(), error_msg);
+            return itr;
+        }
+
+        const T& get(const uint64_t primary, const char* error_msg = "unable to find key") const {
+            return *require_find(primary, error_msg);
+        }
+
+        uint64_t available_primary_key() const { return _next_primary_key; }
+
+        size_t size() const { return _rows.size(); }
+
+        template <eosio::name::raw IndexName>
+        auto get_index() {
+            constexpr auto position = index_position<IndexName>();
+            static_assert(position < sizeof...(Indices), "name does not match any index");
+            return index<position>(this);
+        }
+
+        template <typename Lambda>
+        const_iterator emplace(const eosio::name& payer, Lambda&& constructor) {
+            T row;
+            constructor(row);
+            const auto primary = row.primary_key();
+            eosio::check(_rows.find(primary) == _rows.end(),
+                         "could not insert object, most likely a uniqueness constraint was violated");
+            auto itr = _rows.emplace(primary, std::move(row)).first;
+            insert_keys(itr->second, std::index_sequence_for<Indices...>{});
+            if (primary >= _next_primary_key) {
+                _next_primary_key = primary + 1;
+            }
+            return const_iterator(itr);
+        }
+
+        template <typename Lambda>
+        void modify(const const_iterator& itr, const eosio::name& payer, Lambda&& updater) {
+            auto& row = _rows.at(itr->primary_key());
+            const auto primary = row.primary_key();
+            erase_keys(row, std::index_sequence_for<Indices...>{});
+            updater(row);
+            eosio::check(row.primary_key() == primary, "updater cannot change primary key when modifying an object");
+            insert_keys(row, std::index_sequence_for<Indices...>{});
+        }
+
+        const_iterator erase(const_iterator itr) {
+            const auto primary = itr->primary_key();
+            ++itr;
+            auto row = _rows.find(primary);
+            erase_keys(row->second, std::index_sequence_for<Indices...>{});
+            _rows.erase(row);
+            return itr;
+        }
+    };
+
+    template <typename Table>
+    struct table_traits;
+
+    template <eosio::name::raw TableName, typename T, typename... Indices>
+    struct table_traits<eosio::multi_index<TableName, T, Indices...>> {
+        using type = multi_index<TableName, T, Indices...>;
+    };
+
+    // the mock of a contract table typedef, e.g. `mock::table<utxo_manage::utxo_table>`
+    template <typename Table>
+    using table = typename table_traits<Table>::type;
+}  // namespace mock
@@ -0,0 +1,57 @@
+#pragma once
+
+// Host implementations of the CDT intrinsics used by `external/bitcoin`, so the parsing hot paths can be
+// benchmarked natively without interpreter overhead.
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <openssl/sha.h>
+#include <eosio/check.hpp>
+#include <eosio/crypto.hpp>
+
+extern "C" {
+void eosio_assert(uint32_t test, const char* msg) {
+    if (!test) throw std::runtime_error(msg);
+}
+
+void eosio_assert_message(uint32_t test, const char* msg, uint32_t msg_len) {
+    if (!test) throw std::runtime_error(std::string(msg, msg_len));
+}
+
+void eosio_assert_code(uint32_t test, uint64_t code) {
+    if (!test) throw std::runtime_error("assertion failure with code " + std::to_string(code));
+}
+}
+
+namespace eosio {
+    checksum256 sha256(const char* data, uint32_t length) {
+        std::array<uint8_t, 32> hash;
+        SHA256(reinterpret_cast<const unsigned char*>(data), length, hash.data());
+        return checksum256(hash);
+    }
+}  // namespace eosio
+
+// mainnet block fixtures are stored as hex
+static std::vector<char> read_fixture(const std::string& path) {
+    std::ifstream file(path);
+    eosio::check(file.good(), "fixture does not exist");
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const auto hex = buffer.str();
+
+    std::vector<char> data;
+    data.reserve(hex.size() / 2);
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        data.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return data;
+}
+
+static std::vector<char> read_fixture(const std::string& dir, const uint64_t height) {
+    return read_fixture(dir + "/mainnet-" + std::to_string(height) + ".json");
+}
@@ -0,0 +1,236 @@
+const { Name, TimePointSec } = require('@greymass/eosio')
+const { Blockchain } = require('@proton/vert')
+const { BTC, BTC_CONTRACT } = require('../src/constants')
+const fs = require('fs')
+const path = require('path')
+const { decodeReturn_verify, max_chunk_size } = require('../src/help')
+
+// The upload, verify, endorse and parse pipeline shared by the vert benchmarks. `replay` drives one mainnet fixture
+// from `initbucket` until `processblock` has parsed it, sending every action through `hooks.measure(key, send)` and
+// calling `hooks.phase(name)` after the upload, verify, endorse and parse phases.
+
+// Vert EOS VM
+const blockchain = new Blockchain()
+
+// `-DPROFILE` builds of blksync.xsat and utxomng.xsat (tests/wasm/profile) are loaded when PIPELINE_PROFILE is set
+const PROFILED = process.env.PIPELINE_PROFILE ? ['blksync.xsat', 'utxomng.xsat'] : []
+const wasm = account => (PROFILED.includes(account) ? `tests/wasm/profile/${account}` : `tests/wasm/${account}`)
+
+// contracts
+const contracts = {
+    blksync: blockchain.createContract('blksync.xsat', wasm('blksync.xsat'), true),
+    poolreg: blockchain.createContract('poolreg.xsat', 'tests/wasm/poolreg.xsat', true),
+    rescmng: blockchain.createContract('rescmng.xsat', 'tests/wasm/rescmng.xsat', true),
+    utxomng: blockchain.createContract('utxomng.xsat', wasm('utxomng.xsat'), true),
+    blkendt: blockchain.createContract('blkendt.xsat', 'tests/wasm/blkendt.xsat', true),
+    staking: blockchain.createContract('staking.xsat', 'tests/wasm/staking.xsat', true),
+    endrmng: blockchain.createContract('endrmng.xsat', 'tests/wasm/endrmng.xsat', true),
+    btc: blockchain.createContract('btc.xsat', 'tests/wasm/btc.xsat', true),
+    exsat: blockchain.createContract('exsat.xsat', 'tests/wasm/exsat.xsat', true),
+    rwddist: blockchain.createContract('rwddist.xsat', 'tests/wasm/rwddist.xsat', true),
+}
+
+// accounts
+blockchain.createAccounts('fees.xsat', 'alice', 'amy', 'anna', 'bob', 'brian')
+
+const BLOCKS = [
+    [840000, '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5'],
+    [840001, '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463'],
+    [840002, '00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9'],
+    [840003, '00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119'],
+    [840004, '000000000000000000028458274b1f458d57d817fdce349e31dd5cb51b277d36'],
+    [840005, '000000000000000000027b0ec0e3acadd018cd19e7dd976602f216a1bc12d079'],
+    [840006, '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac'],
+    [840007, '000000000000000000030d1455700ec234e4214e75e8e1112632b74febe80c78'],
+]
+
+// blksync.xsat block_status
+const BLOCK_STATUS = {
+    1: 'uploading',
+    2: 'upload_complete',
+    3: 'verify_merkle',
+    4: 'verify_parent_hash',
+    5: 'waiting_miner_verification',
+    6: 'verify_fail',
+    7: 'verify_pass',
+}
+
+// utxomng.xsat parsing_status
+const PARSING_STATUS = {
+    1: 'waiting',
+    2: 'migrating',
+    3: 'deleting_data',
+    4: 'distributing_rewards',
+    5: 'parsing',
+}
+
+const read_block = height => fs.readFileSync(path.join(__dirname, `../data/mainnet-${height}.json`)).toString('utf8')
+
+const get_chain_state = () => {
+    return contracts.utxomng.tables.chainstate().getTableRows()[0]
+}
+
+const get_block_bucket = (synchronizer, height, hash) => {
+    const scope = Name.from(synchronizer).value.value
+    return contracts.blksync.tables
+        .blockbuckets(scope)
+        .getTableRows()
+        .find(row => Number(row.height) === height && row.hash === hash)
+}
+
+const get_nonce = () => new Date().getTime()
+
+// the stage `processblock` executes in the current chain state
+const parsing_stage = chain_state => {
+    if (chain_state.status === 1) {
+        return chain_state.migrating_height > 0 ? 'migrating' : 'parsing'
+    }
+    return PARSING_STATUS[chain_state.status]
+}
+
+// one-time setup, same as utxomng.xsat.spec.js
+const setup = async () => {
+    blockchain.setTime(TimePointSec.from(new Date()))
+
+    // create XSAT token
+    await contracts.exsat.actions.create(['rwddist.xsat', '10000000.00000000 XSAT']).send('exsat.xsat@active')
+
+    // create BTC token
+    await contracts.btc.actions.create(['btc.xsat', '10000000.00000000 BTC']).send('btc.xsat@active')
+    await contracts.btc.actions.issue(['btc.xsat', '10000000.00000000 BTC', 'init']).send('btc.xsat@active')
+
+    for (const account of ['alice', 'amy', 'anna', 'bob', 'brian']) {
+        // transfer BTC to account
+        await contracts.btc.actions.transfer(['btc.xsat', account, '1000000.00000000 BTC', '']).send('btc.xsat@active')
+        // deposit fees
+        await contracts.btc.actions
+            .transfer([account, 'rescmng.xsat', '1000.00000000 BTC', account])
+            .send(`${account}@active`)
+    }
+
+    // add staking token
+    await contracts.staking.actions.addtoken([{ sym: BTC, contract: BTC_CONTRACT }]).send('staking.xsat@active')
+
+    // register synchronizer
+    await contracts.poolreg.actions
+        .initpool([
+            'alice',
+            839997,
+            'alice',
+            ['37jKPSmbEGwgfacCr2nayn1wTaqMAbA94Z', '39C7fxSzEACPjM78Z7xdPxhf7mKxJwvfMJ'],
+        ])
+        .send('poolreg.xsat@active')
+    await contracts.poolreg.actions.buyslot(['alice', 'alice', 10]).send('alice@active')
+
+    // register validator
+    for (const account of ['alice', 'amy', 'anna', 'bob', 'brian']) {
+        await contracts.endrmng.actions.regvalidator([account, account, 2000]).send(`${account}@active`)
+    }
+
+    // init
+    await contracts.blkendt.actions.config([0, 0, 2, 860000, 0, '21000.00000000 XSAT']).send('blkendt.xsat@active')
+    await contracts.utxomng.actions.config([600, 100, 5000, 100, 11, 0]).send('utxomng.xsat@active')
+
+    // staking
+    await contracts.btc.actions.transfer(['alice', 'staking.xsat', '100.00000000 BTC', 'alice']).send('alice@active')
+    await contracts.btc.actions.transfer(['bob', 'staking.xsat', '200.00000000 BTC', 'bob']).send('bob@active')
+    await contracts.btc.actions.transfer(['amy', 'staking.xsat', '300.00000000 BTC', 'amy']).send('amy@active')
+    await contracts.btc.actions.transfer(['anna', 'staking.xsat', '700.00000000 BTC', 'anna']).send('anna@active')
+    await contracts.btc.actions.transfer(['brian', 'staking.xsat', '900.00000000 BTC', 'brian']).send('brian@active')
+
+    await contracts.utxomng.actions
+        .addblock({
+            height: 839999,
+            hash: '0000000000000000000172014ba58d66455762add0512355ad651207918494ab',
+            cumulative_work: '0000000000000000000000000000000000000000753b8c1eaae701e1f0146360',
+            version: 671088644,
+            previous_block_hash: '00000000000000000001dcce6ce7c8a45872cafd1fb04732b447a14a91832591',
+            merkle: '5cdb277afa34ea35aa620e5cad205f18acda80b80dec9dacf4b84636a5ad0448',
+            timestamp: 1713571533,
+            bits: 386089497,
+            nonce: 3205594798,
+        })
+        .send('utxomng.xsat@active')
+
+    await contracts.rescmng.actions
+        .init({
+            cost_per_slot: '0.00000001 BTC',
+            cost_per_endorsement: '0.00000004 BTC',
+            cost_per_parse: '0.00000005 BTC',
+            cost_per_upload: '0.00000002 BTC',
+            cost_per_verification: '0.00000003 BTC',
+            fee_account: 'fees.xsat',
+        })
+        .send('rescmng.xsat@active')
+}
+
+const replay = async (height, hash, hooks = {}) => {
+    const measure = hooks.measure || ((key, send) => send())
+    const phase = hooks.phase || (() => {})
+    const process_row = hooks.process_row || 0
+
+    const block = read_block(height)
+    const block_size = block.length / 2
+    const num_chunks = Math.ceil(block.length / max_chunk_size)
+
+    // upload
+    await measure('initbucket', () =>
+        contracts.blksync.actions
+            .initbucket(['alice', height, hash, block_size, num_chunks, max_chunk_size])
+            .send('alice@active')
+    )
+    for (let i = 0; i < num_chunks; i++) {
+        const chunk = block.substring(i * max_chunk_size, (i + 1) * max_chunk_size)
+        await measure('pushchunk', () =>
+            contracts.blksync.actions.pushchunk(['alice', height, hash, i, chunk]).send('alice@active')
+        )
+    }
+    await phase('upload')
+
+    // verify, one sample per stage
+    let max_times = 10
+    let status = ''
+    while (max_times-- && status != 'verify_pass') {
+        const stage = BLOCK_STATUS[get_block_bucket('alice', height, hash).status]
+        await measure(`verify:${stage}`, () =>
+            contracts.blksync.actions.verify(['alice', height, hash, get_nonce()]).send('alice@active')
+        )
+        status = decodeReturn_verify(blockchain.actionTraces[0].returnValue).status
+    }
+    if (status != 'verify_pass') {
+        throw new Error(`${height} did not pass verification: ${status}`)
+    }
+    await phase('verify')
+
+    // endorse
+    blockchain.addTime(TimePointSec.from(1000))
+    for (const validator of ['amy', 'anna', 'brian', 'bob']) {
+        await measure('endorse', () =>
+            contracts.blkendt.actions.endorse([validator, height, hash]).send(`${validator}@active`)
+        )
+    }
+    await phase('endorse')
+
+    // parse and migrate; `distribute` and `endtreward` run inline in the migrating and distributing_rewards stages
+    blockchain.addTime(TimePointSec.from(600))
+    max_times = 10000
+    while (max_times-- && get_chain_state().parsing_height > 0) {
+        const stage = parsing_stage(get_chain_state())
+        await measure(`processblock:${stage}`, () =>
+            contracts.utxomng.actions.processblock(['alice', process_row, get_nonce()]).send('alice@active')
+        )
+    }
+    if (get_chain_state().parsed_height != height) {
+        throw new Error(`${height} was not parsed`)
+    }
+    await phase('parse')
+}
+
+module.exports = {
+    blockchain,
+    contracts,
+    BLOCKS,
+    get_chain_state,
+    setup,
+    replay,
+}
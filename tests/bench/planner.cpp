@@ -0,0 +1,49 @@
+#include "native.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include "planner.hpp"
+
+// Prints the upload plan of a raw block fixture: the `initbucket` params, every `pushchunk` slice and the expected
+// number of `verify` and `processblock` calls.
+//
+// usage: ./planner <fixture> [num_txs_per_verification] [process_row] [max_chunk_size]
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <fixture> [num_txs_per_verification] [process_row] [max_chunk_size]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    xsat::planner::config cfg;
+    if (argc > 2) {
+        cfg.num_txs_per_verification = std::strtoul(argv[2], nullptr, 10);
+        cfg.num_merkle_layer = static_cast<uint8_t>(std::log2(cfg.num_txs_per_verification));
+    }
+    if (argc > 3) {
+        cfg.process_row = std::strtoull(argv[3], nullptr, 10);
+    }
+    if (argc > 4) {
+        cfg.max_chunk_size = std::strtoul(argv[4], nullptr, 10);
+    }
+
+    auto block_data = read_fixture(argv[1]);
+    const auto plan = xsat::planner::make_plan(block_data, cfg);
+    const auto num_slices = xsat::planner::simulate_verify(block_data, plan, cfg);
+    eosio::check(num_slices + 1 == plan.num_verify_steps, "simulated verify steps do not match the plan");
+
+    std::printf("initbucket: block_size=%u num_chunks=%u chunk_size=%u\n", plan.block_size, plan.num_chunks,
+                plan.chunk_size);
+    for (const auto& chunk : plan.chunks) {
+        std::printf("pushchunk:  chunk_id=%-2u offset=%-8u size=%u\n", chunk.chunk_id, chunk.offset, chunk.size);
+    }
+    std::printf("transactions: %llu  rows: %llu  utxos: %llu\n",
+                static_cast<unsigned long long>(plan.num_transactions), static_cast<unsigned long long>(plan.num_rows),
+                static_cast<unsigned long long>(plan.num_utxos));
+    std::printf("verify: %llu  processblock: %llu parse + %llu migrate\n",
+                static_cast<unsigned long long>(plan.num_verify_steps),
+                static_cast<unsigned long long>(plan.num_parse_steps),
+                static_cast<unsigned long long>(plan.num_migrate_steps));
+    return 0;
+}
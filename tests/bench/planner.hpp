@@ -0,0 +1,178 @@
+#pragma once
+
+// Off-chain upload planner for `blksync.xsat`: splits a raw block into the chunks sent with `initbucket`/`pushchunk`
+// and predicts how many `verify` and `processblock` calls the block will take, using the same `external/bitcoin`
+// parsing code as the contracts.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/core/block_header.hpp>
+#include <bitcoin/core/transaction.hpp>
+
+namespace xsat::planner {
+
+    // mirrors `contracts/internal/defines.hpp`
+    static constexpr uint64_t BLOCK_HEADER_SIZE = 80;
+    static constexpr uint64_t MAX_BLOCK_SIZE = 4LL * 1024 * 1024;
+    static constexpr uint8_t MAX_NUM_CHUNKS = 64;
+
+    // largest `pushchunk` payload that fits the default `max_transaction_net_usage`
+    static constexpr uint32_t MAX_CHUNK_SIZE = 512 * 1024;
+
+    struct config {
+        // `utxomng.xsat` config
+        uint16_t num_txs_per_verification = 2048;
+        uint8_t num_merkle_layer = 11;
+        // `process_row` passed to `processblock`, 0 processes everything in one call
+        uint64_t process_row = 0;
+        // upper bound of a single `pushchunk` payload
+        uint32_t max_chunk_size = MAX_CHUNK_SIZE;
+    };
+
+    struct chunk {
+        uint8_t chunk_id;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct plan {
+        uint32_t block_size = 0;
+        uint8_t num_chunks = 0;
+        uint32_t chunk_size = 0;
+        std::vector<chunk> chunks;
+
+        uint64_t num_transactions = 0;
+        // rows consumed by `processblock` while parsing: every vin and vout
+        uint64_t num_rows = 0;
+        // pending utxos migrated once the block is irreversible: non-coinbase vins and spendable vouts
+        uint64_t num_utxos = 0;
+
+        // `verify` calls: one per merkle slice plus the parent hash check
+        uint64_t num_verify_steps = 0;
+        // `processblock` calls for parsing and for migrating the block
+        uint64_t num_parse_steps = 0;
+        uint64_t num_migrate_steps = 0;
+    };
+
+    static uint64_t ceil_div(const uint64_t a, const uint64_t b) { return (a + b - 1) / b; }
+
+    // mirrors `xsat::utils::is_unspendable_legacy`
+    static bool is_unspendable(const std::vector<uint8_t>& script) {
+        return !script.empty() && (script[0] == 0x6a || (script.size() > 1 && script[0] == 0x00 && script[1] == 0x6a));
+    }
+
+    // fewest chunks within `max_chunk_size`, sized as evenly as possible so no chunk is a small remainder
+    static std::vector<chunk> split(const uint32_t block_size, const uint32_t max_chunk_size) {
+        eosio::check(block_size > BLOCK_HEADER_SIZE && block_size <= MAX_BLOCK_SIZE,
+                     "block_size must be greater than 80 and less than or equal to 4194304");
+        eosio::check(max_chunk_size > 0, "max_chunk_size must be greater than 0");
+
+        const auto num_chunks = ceil_div(block_size, max_chunk_size);
+        eosio::check(num_chunks <= MAX_NUM_CHUNKS, "block does not fit in 64 chunks of max_chunk_size");
+
+        std::vector<chunk> chunks;
+        chunks.reserve(num_chunks);
+        const uint32_t base = block_size / num_chunks;
+        const uint32_t remainder = block_size % num_chunks;
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < num_chunks; i++) {
+            const uint32_t size = base + (i < remainder ? 1 : 0);
+            chunks.push_back({static_cast<uint8_t>(i), offset, size});
+            offset += size;
+        }
+        return chunks;
+    }
+
+    static plan make_plan(std::vector<char>& block_data, const config& cfg) {
+        eosio::check(cfg.num_txs_per_verification > 0, "num_txs_per_verification must be greater than 0");
+        eosio::check(uint64_t(1) << cfg.num_merkle_layer == cfg.num_txs_per_verification,
+                     "num_txs_per_verification must be 2 ^ num_merkle_layer");
+
+        plan result;
+        result.block_size = block_data.size();
+        result.chunks = split(result.block_size, cfg.max_chunk_size);
+        result.num_chunks = result.chunks.size();
+        result.chunk_size = result.chunks.front().size;
+
+        eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+        bitcoin::core::block_header block_header;
+        block_stream >> block_header;
+        result.num_transactions = bitcoin::varint::decode(block_stream);
+        eosio::check(result.num_transactions > 0, "tx_size_limits");
+
+        for (uint64_t i = 0; i < result.num_transactions; i++) {
+            bitcoin::core::transaction transaction(&block_data);
+            block_stream >> transaction;
+
+            result.num_rows += transaction.inputs.size() + transaction.outputs.size();
+            if (!transaction.is_coinbase()) {
+                result.num_utxos += transaction.inputs.size();
+            }
+            for (const auto& output : transaction.outputs) {
+                if (!is_unspendable(output.script.data)) {
+                    result.num_utxos++;
+                }
+            }
+        }
+        eosio::check(block_stream.tellp() == result.block_size, "data_exceeds");
+
+        result.num_verify_steps = ceil_div(result.num_transactions, cfg.num_txs_per_verification) + 1;
+        const auto process_row = cfg.process_row == 0 ? result.num_rows : cfg.process_row;
+        result.num_parse_steps = ceil_div(result.num_rows, process_row);
+        result.num_migrate_steps = result.num_utxos == 0 ? 1 : ceil_div(result.num_utxos, process_row);
+        return result;
+    }
+
+    // Reassembles the chunks the way `read_bucket` concatenates them and replays the `verify_merkle` slices of
+    // `blksync.xsat::check_merkle`, returning the number of slices once the relayed merkle root matches the header.
+    static uint64_t simulate_verify(const std::vector<char>& block_data, const plan& p, const config& cfg) {
+        std::vector<char> bucket;
+        bucket.reserve(p.block_size);
+        for (const auto& c : p.chunks) {
+            eosio::check(c.offset == bucket.size(), "chunks must be contiguous");
+            bucket.insert(bucket.end(), block_data.begin() + c.offset, block_data.begin() + c.offset + c.size);
+        }
+        eosio::check(bucket.size() == p.block_size, "uploaded size does not match block_size");
+
+        eosio::datastream<const char*> block_stream(bucket.data(), bucket.size());
+        bitcoin::core::block_header block_header;
+        block_stream >> block_header;
+        const auto num_transactions = bitcoin::varint::decode(block_stream);
+
+        std::vector<bitcoin::uint256_t> relay_header_merkle;
+        uint64_t processed_transactions = 0;
+        while (processed_transactions < num_transactions) {
+            uint64_t rows = cfg.num_txs_per_verification;
+            if (rows > num_transactions - processed_transactions) {
+                rows = num_transactions - processed_transactions;
+            }
+            std::vector<bitcoin::core::transaction> transactions;
+            transactions.reserve(rows);
+            for (uint64_t i = 0; i < rows; i++) {
+                bitcoin::core::transaction transaction(&bucket);
+                block_stream >> transaction;
+                transactions.emplace_back(std::move(transaction));
+            }
+
+            bool mutated = false;
+            auto header_merkle = bitcoin::core::generate_header_merkle(transactions, &mutated);
+            eosio::check(!mutated, "bad_txns_duplicate");
+
+            // calculate to the same layer
+            if (num_transactions > cfg.num_txs_per_verification && rows != cfg.num_txs_per_verification) {
+                auto current_layer = static_cast<uint8_t>(std::ceil(std::log2(rows)));
+                for (; current_layer < cfg.num_merkle_layer; current_layer++) {
+                    header_merkle = bitcoin::dhash_nodes(header_merkle, header_merkle);
+                }
+            }
+            relay_header_merkle.push_back(header_merkle);
+            processed_transactions += rows;
+        }
+        eosio::check(block_stream.tellp() == p.block_size, "data_exceeds");
+
+        const auto num_slices = relay_header_merkle.size();
+        eosio::check(bitcoin::generate_merkle_root(relay_header_merkle) == block_header.merkle, "merkle_invalid");
+        return num_slices;
+    }
+}  // namespace xsat::planner
@@ -0,0 +1,120 @@
+#include "native.hpp"
+
+#include <cstdio>
+#include <functional>
+#include "planner.hpp"
+
+// Unit tests of the upload planner, run against the mainnet block fixtures.
+
+static int failures = 0;
+
+static void test(const char* name, const std::function<void()>& fn) {
+    try {
+        fn();
+        std::printf("ok    %s\n", name);
+    } catch (const std::exception& e) {
+        failures++;
+        std::printf("FAIL  %s: %s\n", name, e.what());
+    }
+}
+
+static void expect_throw(const std::function<void()>& fn, const std::string& msg) {
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        eosio::check(std::string(e.what()) == msg, "unexpected error: " + std::string(e.what()));
+        return;
+    }
+    eosio::check(false, "expected error: " + msg);
+}
+
+int main(int argc, char** argv) {
+    const std::string dir = argc > 1 ? argv[1] : "../data";
+
+    test("split: chunks are contiguous and evenly sized", [] {
+        const auto chunks = xsat::planner::split(1000001, 100000);
+        eosio::check(chunks.size() == 11, "num_chunks");
+        uint32_t offset = 0;
+        for (uint8_t i = 0; i < chunks.size(); i++) {
+            eosio::check(chunks[i].chunk_id == i, "chunk_id");
+            eosio::check(chunks[i].offset == offset, "offset");
+            eosio::check(chunks[i].size == 90910 || chunks[i].size == 90909, "size");
+            offset += chunks[i].size;
+        }
+        eosio::check(offset == 1000001, "block_size");
+    });
+
+    test("split: single chunk", [] {
+        const auto chunks = xsat::planner::split(81, xsat::planner::MAX_CHUNK_SIZE);
+        eosio::check(chunks.size() == 1 && chunks[0].size == 81, "single chunk");
+    });
+
+    test("split: limits", [] {
+        expect_throw([] { xsat::planner::split(80, xsat::planner::MAX_CHUNK_SIZE); },
+                     "block_size must be greater than 80 and less than or equal to 4194304");
+        expect_throw([] { xsat::planner::split(xsat::planner::MAX_BLOCK_SIZE + 1, xsat::planner::MAX_CHUNK_SIZE); },
+                     "block_size must be greater than 80 and less than or equal to 4194304");
+        expect_throw([] { xsat::planner::split(xsat::planner::MAX_BLOCK_SIZE, 1024); },
+                     "block does not fit in 64 chunks of max_chunk_size");
+    });
+
+    test("make_plan: config must match the merkle layer", [&] {
+        auto block_data = read_fixture(dir, 840002);
+        xsat::planner::config cfg;
+        cfg.num_txs_per_verification = 1000;
+        expect_throw([&] { xsat::planner::make_plan(block_data, cfg); },
+                     "num_txs_per_verification must be 2 ^ num_merkle_layer");
+    });
+
+    test("make_plan: 840002", [&] {
+        auto block_data = read_fixture(dir, 840002);
+        xsat::planner::config cfg;
+        const auto plan = xsat::planner::make_plan(block_data, cfg);
+        eosio::check(plan.block_size == block_data.size(), "block_size");
+        eosio::check(plan.num_chunks == (block_data.size() + xsat::planner::MAX_CHUNK_SIZE - 1)
+                                            / xsat::planner::MAX_CHUNK_SIZE,
+                     "num_chunks");
+        eosio::check(plan.num_verify_steps
+                         == (plan.num_transactions + cfg.num_txs_per_verification - 1) / cfg.num_txs_per_verification
+                                + 1,
+                     "num_verify_steps");
+        eosio::check(plan.num_parse_steps == 1 && plan.num_migrate_steps == 1, "process everything in one call");
+        eosio::check(plan.num_utxos < plan.num_rows, "coinbase vin is not migrated");
+    });
+
+    test("make_plan: process_row", [&] {
+        auto block_data = read_fixture(dir, 840002);
+        xsat::planner::config cfg;
+        cfg.process_row = 1000;
+        const auto plan = xsat::planner::make_plan(block_data, cfg);
+        eosio::check(plan.num_parse_steps == (plan.num_rows + 999) / 1000, "num_parse_steps");
+        eosio::check(plan.num_migrate_steps == (plan.num_utxos + 999) / 1000, "num_migrate_steps");
+    });
+
+    test("simulate_verify: every fixture", [&] {
+        for (const auto height : {839999, 840002, 840003, 840004, 840005, 840006, 840007, 840672}) {
+            auto block_data = read_fixture(dir, height);
+            for (const uint8_t layer : {9, 11, 13}) {
+                xsat::planner::config cfg;
+                cfg.num_merkle_layer = layer;
+                cfg.num_txs_per_verification = 1 << layer;
+                const auto plan = xsat::planner::make_plan(block_data, cfg);
+                const auto num_slices = xsat::planner::simulate_verify(block_data, plan, cfg);
+                eosio::check(num_slices + 1 == plan.num_verify_steps,
+                             "verify steps of " + std::to_string(height) + " do not match the plan");
+            }
+        }
+    });
+
+    test("simulate_verify: corrupted chunk", [&] {
+        auto block_data = read_fixture(dir, 840002);
+        xsat::planner::config cfg;
+        const auto plan = xsat::planner::make_plan(block_data, cfg);
+        // flip a bit of the last locktime, the block still parses but the merkle root no longer matches
+        block_data.back() ^= 0x01;
+        expect_throw([&] { xsat::planner::simulate_verify(block_data, plan, cfg); }, "merkle_invalid");
+    });
+
+    std::printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
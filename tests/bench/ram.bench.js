@@ -0,0 +1,199 @@
+const { Name, Serializer } = require('@greymass/eosio')
+const fs = require('fs')
+const path = require('path')
+const { contracts, BLOCKS, setup, replay } = require('./pipeline')
+
+// Replays the mainnet fixtures through blksync.xsat -> utxomng.xsat -> rwddist.xsat and accounts the RAM billed for
+// every table after each phase: bytes per row, per secondary index and per block, plus the peak and the final
+// (steady-state) usage. The report is printed and written to BENCH_RAM_REPORT (default tests/bench/ram.json).
+//
+// Row sizes are the packed row plus the chainbase `billable_size` of the row and of each secondary index entry.
+// Log events are returned as action return values and take no RAM, so they do not appear in the report.
+const REPORT = process.env.BENCH_RAM_REPORT || path.join(__dirname, 'ram.json')
+
+jest.setTimeout(30 * 60 * 1000)
+
+// chainbase billable sizes, see `config::billable_size_v`
+const ROW_OVERHEAD = 108
+const TABLE_OVERHEAD = 108
+const INDEX_OVERHEAD = { i64: 128, i128: 136, i256: 152 }
+
+// secondary indices of the tables written by the pipeline, in declaration order
+const INDICES = {
+    'blksync.xsat': {
+        blockbuckets: { bystatus: 'i64', byblockid: 'i256' },
+        passedindexs: { bybucketid: 'i64', byhash: 'i256' },
+        blockminer: { byhash: 'i256' },
+    },
+    'utxomng.xsat': {
+        utxos: { scriptpubkey: 'i256', byutxoid: 'i256' },
+        pendingutxos: {
+            byheight: 'i64',
+            byblockid: 'i256',
+            scriptpubkey: 'i256',
+            byblkutxoid: 'i256',
+            bytype: 'i256',
+            byutxoid: 'i256',
+        },
+        spentutxos: { byheight: 'i64', scriptpubkey: 'i256', byutxoid: 'i256' },
+        blocks: { byhash: 'i256' },
+        consensusblk: { byheight: 'i64', bysyncer: 'i64', parseheight: 'i128', byblockid: 'i256' },
+        forktree: { byheight: 'i64', byblockid: 'i256' },
+        chaintips: { bywork: 'i256' },
+    },
+    'blkendt.xsat': {
+        valsets: { byepoch: 'i64' },
+        valmembers: { byindex: 'i64' },
+        endorsebits: { byhash: 'i256' },
+        // legacy rows, only written before `endorsebits`
+        endorsements: { byhash: 'i256' },
+    },
+    'rwddist.xsat': {
+        rewardlogs: { bysyncer: 'i64', byparser: 'i64', byminer: 'i64' },
+    },
+}
+
+// `block.chunk` rows are raw block data written with `db_store_i64`, they are accounted from the buckets instead
+const RAW_TABLES = ['block.chunk']
+
+const ACCOUNTS = ['alice', 'amy', 'anna', 'bob', 'brian', 'fees.xsat', ...Object.values(contracts).map(c => c.name)]
+
+// candidate scopes: every account, every replayed height and every validator set id (`valmembers`)
+const scopes = () => {
+    const values = new Set(ACCOUNTS.map(account => Name.from(String(account)).value.value.toString()))
+    for (let height = 839999; height <= BLOCKS[BLOCKS.length - 1][0]; height++) {
+        values.add(String(height))
+    }
+    for (const validator_set of contracts.blkendt.tables.valsets().getTableRows()) {
+        values.add(String(validator_set.id))
+    }
+    return [...values].map(value => BigInt(value))
+}
+
+const scan_table = (contract, table) => {
+    const indices = (INDICES[contract.name.toString()] || {})[table.name] || {}
+    const usage = { rows: 0, data_bytes: 0, row_bytes: 0, index_bytes: {}, bytes: 0 }
+    for (const index of Object.keys(indices)) {
+        usage.index_bytes[index] = 0
+    }
+
+    for (const scope of scopes()) {
+        const rows = contract.tables[table.name](scope).getTableRows()
+        if (rows.length == 0) continue
+
+        usage.bytes += TABLE_OVERHEAD * (1 + Object.keys(indices).length)
+        for (const row of rows) {
+            const data = Serializer.encode({ object: row, abi: contract.abi, type: table.type }).array.length
+            usage.rows++
+            usage.data_bytes += data
+            usage.row_bytes += data + ROW_OVERHEAD
+            for (const [index, type] of Object.entries(indices)) {
+                usage.index_bytes[index] += INDEX_OVERHEAD[type]
+            }
+        }
+    }
+    usage.bytes += usage.row_bytes + Object.values(usage.index_bytes).reduce((sum, bytes) => sum + bytes, 0)
+    return usage
+}
+
+const scan_chunks = () => {
+    const usage = { rows: 0, data_bytes: 0, row_bytes: 0, index_bytes: {}, bytes: 0 }
+    for (const scope of scopes()) {
+        for (const bucket of contracts.blksync.tables.blockbuckets(scope).getTableRows()) {
+            usage.rows += bucket.uploaded_num_chunks
+            usage.data_bytes += bucket.uploaded_size
+            usage.row_bytes += bucket.uploaded_size + ROW_OVERHEAD * bucket.uploaded_num_chunks
+            usage.bytes += TABLE_OVERHEAD + bucket.uploaded_size + ROW_OVERHEAD * bucket.uploaded_num_chunks
+        }
+    }
+    return usage
+}
+
+// billed RAM of every table, keyed by `contract:table`
+const snapshot = () => {
+    const tables = {}
+    for (const contract of Object.values(contracts)) {
+        for (const table of contract.abi.tables) {
+            if (RAW_TABLES.includes(table.name.toString())) continue
+            tables[`${contract.name}:${table.name}`] = scan_table(contract, table)
+        }
+    }
+    tables['blksync.xsat:block.chunk'] = scan_chunks()
+    return tables
+}
+
+const total = tables => Object.values(tables).reduce((sum, usage) => sum + usage.bytes, 0)
+
+const phases = []
+const blocks = []
+
+beforeAll(setup)
+
+describe('ram', () => {
+    for (const [height, hash] of BLOCKS) {
+        it(`pipeline ${height}`, async () => {
+            const before = phases.length ? phases[phases.length - 1].tables : snapshot()
+            await replay(height, hash, {
+                phase: name => {
+                    phases.push({ height, phase: name, tables: snapshot() })
+                },
+            })
+
+            // bytes added by this block, per table
+            const after = phases[phases.length - 1].tables
+            const delta = {}
+            for (const [key, usage] of Object.entries(after)) {
+                const bytes = usage.bytes - (before[key] ? before[key].bytes : 0)
+                if (bytes != 0) delta[key] = bytes
+            }
+            blocks.push({ height, delta })
+        })
+    }
+
+    it('report', () => {
+        const final = phases[phases.length - 1].tables
+        const peak = {}
+        for (const { tables } of phases) {
+            for (const [key, usage] of Object.entries(tables)) {
+                peak[key] = Math.max(peak[key] || 0, usage.bytes)
+            }
+        }
+
+        const summary = {}
+        for (const [key, usage] of Object.entries(final)) {
+            if (peak[key] == 0) continue
+            const per_block = blocks.map(block => block.delta[key] || 0)
+            summary[key] = {
+                rows: usage.rows,
+                bytes_per_row: usage.rows ? Math.round(usage.row_bytes / usage.rows) : 0,
+                index_bytes: Object.values(usage.index_bytes).reduce((sum, bytes) => sum + bytes, 0),
+                bytes_per_block: Math.round(per_block.reduce((sum, bytes) => sum + bytes, 0) / per_block.length),
+                peak_bytes: peak[key],
+                steady_bytes: usage.bytes,
+            }
+        }
+        console.table(summary)
+
+        const peak_total = Math.max(...phases.map(({ tables }) => total(tables)))
+        console.log(`peak: ${peak_total} bytes, steady state: ${total(final)} bytes`)
+
+        fs.writeFileSync(
+            REPORT,
+            JSON.stringify(
+                {
+                    summary,
+                    peak_bytes: peak_total,
+                    steady_bytes: total(final),
+                    indices: Object.fromEntries(Object.entries(final).map(([key, usage]) => [key, usage.index_bytes])),
+                    blocks,
+                    phases: phases.map(({ height, phase, tables }) => ({ height, phase, bytes: total(tables) })),
+                },
+                null,
+                4
+            )
+        )
+        expect(peak_total).toBeGreaterThanOrEqual(total(final))
+        // scoped by validator set id, not by account or height
+        expect(summary['blkendt.xsat:valmembers'].peak_bytes).toBeGreaterThan(0)
+    })
+})
@@ -0,0 +1,99 @@
+#include "native.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <blksync.xsat/blksync.xsat.hpp>
+#include <utxomng.xsat/utxomng.xsat.hpp>
+#include <internal/parsing.hpp>
+#include "mock_table.hpp"
+
+// Replays the mainnet block fixtures through `xsat::parsing`, the code blksync.xsat and utxomng.xsat run for
+// `verify`, the parsing step of `processblock` and the migration step of `processblock`, and reports ns/tx per stage.
+// The `pendingutxos` and `utxos` tables are `mock::multi_index` instances with the rows and secondary indices of
+// utxomng.xsat, so every emplace and erase also maintains the indices the contract pays for.
+//
+// The fixtures are not consecutive blocks, inputs spending outputs of missing blocks are reported as lost.
+
+using clock_type = std::chrono::steady_clock;
+
+static const uint64_t HEIGHTS[] = {839999, 840002, 840003, 840004, 840005, 840006, 840007, 840672};
+
+// `num_txs_per_verification` and `num_merkle_layer` of the default utxomng.xsat config
+static constexpr uint16_t NUM_TXS_PER_VERIFICATION = 2048;
+static constexpr uint8_t NUM_MERKLE_LAYER = 11;
+
+static double ns_per_tx(const clock_type::time_point start, const clock_type::time_point end, const uint64_t txs) {
+    return std::chrono::duration<double, std::nano>(end - start).count() / txs;
+}
+
+int main(int argc, char** argv) {
+    const std::string dir = argc > 1 ? argv[1] : "../data";
+    mock::table<utxo_manage::pending_utxo_table> pending_utxos;
+    mock::table<utxo_manage::utxo_table> utxos;
+    auto utxo_idx = utxos.get_index<"byutxoid"_n>();
+    auto pending_utxo_idx = pending_utxos.get_index<"byblockid"_n>();
+
+    std::printf("%-8s %8s %14s %14s %14s\n", "height", "txs", "verify", "parse", "migrate");
+    for (const auto height : HEIGHTS) {
+        const auto block_data = read_fixture(dir, height);
+        bitcoin::core::block_header block_header;
+        eosio::datastream<const char*> header_stream(block_data.data(), block_data.size());
+        header_stream >> block_header;
+        const auto hash = bitcoin::be_checksum256_from_uint(block_header.hash());
+
+        // verify, one step per `num_txs_per_verification` transactions, each reading the rest of the block
+        const auto start = clock_type::now();
+        block_sync::verify_info_data verify_info = {};
+        do {
+            const std::vector<char> remaining(block_data.begin() + verify_info.processed_position, block_data.end());
+            const auto err_msg = xsat::parsing::verify_transactions(
+                remaining, hash, height, block_data.size(), NUM_TXS_PER_VERIFICATION, NUM_MERKLE_LAYER, verify_info,
+                [](const bitcoin::core::transaction& coinbase) {});
+            eosio::check(!err_msg.has_value(), err_msg.value_or(""));
+        } while (verify_info.processed_transactions < verify_info.num_transactions);
+        const auto verified = clock_type::now();
+
+        // parse
+        utxo_manage::parsing_progress_row parsing_progress = {};
+        const std::vector<char> transactions(block_data.begin() + BLOCK_HEADER_SIZE, block_data.end());
+        xsat::parsing::parse_transactions(transactions, parsing_progress, 0,
+                                          [&](const checksum256& txid, const uint32_t index,
+                                              const std::vector<uint8_t>& script_data, const uint64_t value,
+                                              const name& type) {
+                                              xsat::parsing::save_pending_utxo(pending_utxos, name(), height, hash,
+                                                                               txid, index, script_data, value, type);
+                                          });
+        const auto parsed = clock_type::now();
+
+        // migrate
+        uint64_t num_vins = 0;
+        uint64_t num_vouts = 0;
+        uint64_t num_lost = 0;
+        const auto block_id = xsat::utils::compute_block_id(height, hash);
+        auto end_itr = pending_utxo_idx.upper_bound(block_id);
+        for (auto itr = pending_utxo_idx.lower_bound(block_id); itr != end_itr;) {
+            if (itr->type == "vin"_n) {
+                num_vins++;
+                if (!xsat::parsing::remove_utxo(utxo_idx, itr->txid, itr->index).has_value()) {
+                    num_lost++;
+                }
+            } else {
+                num_vouts++;
+                xsat::parsing::save_utxo(utxos, name(), itr->txid, itr->index, itr->scriptpubkey, itr->value);
+            }
+            itr = pending_utxo_idx.erase(itr);
+        }
+        const auto migrated = clock_type::now();
+
+        const auto num_transactions = verify_info.num_transactions;
+        eosio::check(parsing_progress.parsed_transactions == num_transactions, "parsed_transactions");
+        eosio::check(parsing_progress.num_utxos == num_vins + num_vouts, "num_utxos");
+        std::printf("%-8llu %8llu %14.1f %14.1f %14.1f  (%llu vins, %llu vouts, %llu lost, %zu utxos)\n",
+                    static_cast<unsigned long long>(height), static_cast<unsigned long long>(num_transactions),
+                    ns_per_tx(start, verified, num_transactions), ns_per_tx(verified, parsed, num_transactions),
+                    ns_per_tx(parsed, migrated, num_transactions), static_cast<unsigned long long>(num_vins),
+                    static_cast<unsigned long long>(num_vouts), static_cast<unsigned long long>(num_lost),
+                    utxos.size());
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "native.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "snapshot.hpp"
+
+// Converts a Bitcoin Core `dumptxoutset` file into `utxomng.xsat::addutxos` pages. Every page is written to
+// `<out_dir>/page-<n>.bin` and listed with the `utxo_set_hash` it declares; pages must be imported in order.
+//
+// usage: ./snapshot <dumptxoutset> <out_dir> [max_page_size] [utxo_set_hash]
+
+static checksum256 parse_hash(const std::string& hex) {
+    eosio::check(hex.size() == 64, "utxo_set_hash must be 32 bytes of hex");
+    std::array<uint8_t, 32> bytes;
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = static_cast<uint8_t>(std::stoi(hex.substr(i * 2, 2), nullptr, 16));
+    }
+    return checksum256(bytes);
+}
+
+static std::string to_hex(const checksum256& hash) {
+    std::string hex;
+    char buffer[3];
+    for (const auto byte : hash.extract_as_byte_array()) {
+        std::snprintf(buffer, sizeof(buffer), "%02x", byte);
+        hex += buffer;
+    }
+    return hex;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <dumptxoutset> <out_dir> [max_page_size] [utxo_set_hash]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t max_page_size = xsat::snapshot::MAX_PAGE_SIZE;
+    if (argc > 3) {
+        max_page_size = std::strtoul(argv[3], nullptr, 10);
+    }
+    checksum256 utxo_set_hash;
+    if (argc > 4) {
+        utxo_set_hash = parse_hash(argv[4]);
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    eosio::check(file.good(), "snapshot does not exist");
+    xsat::snapshot::reader snapshot(file);
+    const auto& meta = snapshot.get_metadata();
+    std::printf("base_blockhash: %s  coins: %llu\n", to_hex(meta.base_blockhash).c_str(),
+                static_cast<unsigned long long>(meta.coins_count));
+
+    const std::string dir = argv[2];
+    std::ofstream manifest(dir + "/pages.txt");
+    eosio::check(manifest.good(), "out_dir does not exist");
+    uint64_t num_pages = 0;
+    xsat::snapshot::make_pages(snapshot, max_page_size, utxo_set_hash, [&](const xsat::snapshot::page& page) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "page-%06llu.bin", static_cast<unsigned long long>(num_pages++));
+        std::ofstream out(dir + "/" + name, std::ios::binary);
+        out.write(page.utxos.data(), page.utxos.size());
+        manifest << name << " " << page.num_utxos << " " << to_hex(page.utxo_set_hash) << "\n";
+        std::printf("%s  utxos: %-8llu bytes: %-8zu utxo_set_hash: %s\n", name,
+                    static_cast<unsigned long long>(page.num_utxos), page.utxos.size(),
+                    to_hex(page.utxo_set_hash).c_str());
+    });
+    return 0;
+}
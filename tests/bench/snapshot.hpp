@@ -0,0 +1,411 @@
+#pragma once
+
+// Off-chain converter from a Bitcoin Core `dumptxoutset` file to the pages imported with `utxomng.xsat::addutxos`.
+//
+// A page is the packed `utxos` param of `addutxos`, a sequence of `(txid, index, value, scriptpubkey)`, and declares
+// the rolling UTXO set hash expected once it has been applied. The hash is computed with the contract's own
+// `xsat::utils::compute_utxo_hash`.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <bitcoin/utility/types.hpp>
+#include <internal/utils.hpp>
+
+namespace xsat::snapshot {
+
+    // `SnapshotMetadata` of Bitcoin Core 28+, older snapshots start directly with the base block hash
+    static constexpr char MAGIC[] = {'u', 't', 'x', 'o', '\xff'};
+    static constexpr uint16_t VERSION = 2;
+
+    // number of special script types of `ScriptCompression`
+    static constexpr uint64_t NUM_SPECIAL_SCRIPTS = 6;
+
+    // largest `addutxos` payload that fits the default `max_transaction_net_usage`
+    static constexpr uint32_t MAX_PAGE_SIZE = 512 * 1024;
+
+    struct metadata {
+        uint16_t version = 0;
+        std::array<uint8_t, 4> network_magic = {};
+        // display byte order
+        checksum256 base_blockhash;
+        uint64_t coins_count = 0;
+    };
+
+    struct coin {
+        // display byte order, as stored in the `utxos` table
+        checksum256 txid;
+        uint32_t index = 0;
+        uint64_t value = 0;
+        std::vector<uint8_t> scriptpubkey;
+        uint32_t height = 0;
+        bool coinbase = false;
+
+        bool operator==(const coin& other) const {
+            return txid == other.txid && index == other.index && value == other.value
+                   && scriptpubkey == other.scriptpubkey && height == other.height && coinbase == other.coinbase;
+        }
+    };
+
+    struct page {
+        std::vector<char> utxos;
+        uint64_t num_utxos = 0;
+        // rolling hash of the UTXO set after the page has been applied
+        checksum256 utxo_set_hash;
+    };
+
+    // serialization primitives of Bitcoin Core
+
+    inline uint8_t read_byte(std::istream& in) {
+        const int ch = in.get();
+        eosio::check(ch != std::char_traits<char>::eof(), "unexpected end of snapshot");
+        return static_cast<uint8_t>(ch);
+    }
+
+    template <typename T>
+    T read_le(std::istream& in) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(read_byte(in)) << (8 * i);
+        }
+        return value;
+    }
+
+    template <typename T>
+    void write_le(std::ostream& out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // `uint256` in internal byte order read as a checksum256 in display byte order
+    inline checksum256 read_hash(std::istream& in) {
+        std::array<uint8_t, 32> bytes;
+        for (auto& byte : bytes) byte = read_byte(in);
+        bitcoin::reverse_bytes(bytes);
+        return checksum256(bytes);
+    }
+
+    inline void write_hash(std::ostream& out, const checksum256& hash) {
+        auto bytes = hash.extract_as_byte_array();
+        bitcoin::reverse_bytes(bytes);
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    inline uint64_t read_compact_size(std::istream& in) {
+        const uint8_t size = read_byte(in);
+        if (size < 253) return size;
+        if (size == 253) return read_le<uint16_t>(in);
+        if (size == 254) return read_le<uint32_t>(in);
+        return read_le<uint64_t>(in);
+    }
+
+    inline void write_compact_size(std::ostream& out, const uint64_t size) {
+        if (size < 253) {
+            out.put(static_cast<char>(size));
+        } else if (size <= 0xffff) {
+            out.put(static_cast<char>(253));
+            write_le<uint16_t>(out, size);
+        } else if (size <= 0xffffffff) {
+            out.put(static_cast<char>(254));
+            write_le<uint32_t>(out, size);
+        } else {
+            out.put(static_cast<char>(255));
+            write_le<uint64_t>(out, size);
+        }
+    }
+
+    // `VARINT`, MSB base-128 with an offset per continuation byte
+    inline uint64_t read_varint(std::istream& in) {
+        uint64_t n = 0;
+        while (true) {
+            const uint8_t ch = read_byte(in);
+            eosio::check(n <= (std::numeric_limits<uint64_t>::max() >> 7), "varint is too large");
+            n = (n << 7) | (ch & 0x7f);
+            if (!(ch & 0x80)) return n;
+            eosio::check(n != std::numeric_limits<uint64_t>::max(), "varint is too large");
+            n++;
+        }
+    }
+
+    inline void write_varint(std::ostream& out, uint64_t n) {
+        uint8_t tmp[10];
+        int len = 0;
+        while (true) {
+            tmp[len] = (n & 0x7f) | (len ? 0x80 : 0x00);
+            if (n <= 0x7f) break;
+            n = (n >> 7) - 1;
+            len++;
+        }
+        do {
+            out.put(static_cast<char>(tmp[len]));
+        } while (len--);
+    }
+
+    // `CompressAmount`
+    inline uint64_t compress_amount(uint64_t n) {
+        if (n == 0) return 0;
+        int e = 0;
+        while (((n % 10) == 0) && e < 9) {
+            n /= 10;
+            e++;
+        }
+        if (e < 9) {
+            const int d = n % 10;
+            n /= 10;
+            return 1 + (n * 9 + d - 1) * 10 + e;
+        }
+        return 1 + (n - 1) * 10 + 9;
+    }
+
+    // `DecompressAmount`
+    inline uint64_t decompress_amount(uint64_t x) {
+        if (x == 0) return 0;
+        x--;
+        int e = x % 10;
+        x /= 10;
+        uint64_t n = 0;
+        if (e < 9) {
+            const int d = (x % 9) + 1;
+            x /= 9;
+            n = x * 10 + d;
+        } else {
+            n = x + 1;
+        }
+        while (e) {
+            n *= 10;
+            e--;
+        }
+        return n;
+    }
+
+    // converts a secp256k1 public key between its 33-byte and 65-byte encodings, empty if it is not on the curve
+    inline std::vector<uint8_t> convert_pubkey(const std::vector<uint8_t>& pubkey, const bool compressed) {
+        EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+        EC_POINT* point = EC_POINT_new(group);
+        std::vector<uint8_t> result(compressed ? 33 : 65);
+        const auto form = compressed ? POINT_CONVERSION_COMPRESSED : POINT_CONVERSION_UNCOMPRESSED;
+        if (!EC_POINT_oct2point(group, point, pubkey.data(), pubkey.size(), nullptr)
+            || EC_POINT_point2oct(group, point, form, result.data(), result.size(), nullptr) != result.size()) {
+            result.clear();
+        }
+        EC_POINT_free(point);
+        EC_GROUP_free(group);
+        return result;
+    }
+
+    // `ScriptCompression`
+    inline std::vector<uint8_t> decompress_script(std::istream& in) {
+        const uint64_t type = read_varint(in);
+        if (type >= NUM_SPECIAL_SCRIPTS) {
+            const uint64_t size = type - NUM_SPECIAL_SCRIPTS;
+            eosio::check(size <= 10000, "script is too large");
+            std::vector<uint8_t> script(size);
+            for (auto& byte : script) byte = read_byte(in);
+            return script;
+        }
+
+        std::vector<uint8_t> data(type < 2 ? 20 : 32);
+        for (auto& byte : data) byte = read_byte(in);
+        std::vector<uint8_t> script;
+        switch (type) {
+            case 0x00:
+                // P2PKH
+                script = {0x76, 0xa9, 20};
+                script.insert(script.end(), data.begin(), data.end());
+                script.insert(script.end(), {0x88, 0xac});
+                break;
+            case 0x01:
+                // P2SH
+                script = {0xa9, 20};
+                script.insert(script.end(), data.begin(), data.end());
+                script.push_back(0x87);
+                break;
+            case 0x02:
+            case 0x03:
+                // P2PK, compressed public key
+                script = {33, static_cast<uint8_t>(type)};
+                script.insert(script.end(), data.begin(), data.end());
+                script.push_back(0xac);
+                break;
+            default: {
+                // P2PK, uncompressed public key stored as its x coordinate and the parity of y
+                std::vector<uint8_t> pubkey = {static_cast<uint8_t>(type - 2)};
+                pubkey.insert(pubkey.end(), data.begin(), data.end());
+                pubkey = convert_pubkey(pubkey, false);
+                eosio::check(!pubkey.empty(), "invalid compressed public key");
+                script = {65};
+                script.insert(script.end(), pubkey.begin(), pubkey.end());
+                script.push_back(0xac);
+            }
+        }
+        return script;
+    }
+
+    inline void compress_script(std::ostream& out, const std::vector<uint8_t>& script) {
+        auto special = [&](const uint8_t type, auto begin, auto end) {
+            out.put(static_cast<char>(type));
+            out.write(reinterpret_cast<const char*>(&*begin), end - begin);
+        };
+        const auto size = script.size();
+        if (size == 25 && script[0] == 0x76 && script[1] == 0xa9 && script[2] == 20 && script[23] == 0x88
+            && script[24] == 0xac) {
+            return special(0x00, script.begin() + 3, script.begin() + 23);
+        }
+        if (size == 23 && script[0] == 0xa9 && script[1] == 20 && script[22] == 0x87) {
+            return special(0x01, script.begin() + 2, script.begin() + 22);
+        }
+        if (size == 35 && script[0] == 33 && (script[1] == 0x02 || script[1] == 0x03) && script[34] == 0xac) {
+            return special(script[1], script.begin() + 2, script.begin() + 34);
+        }
+        if (size == 67 && script[0] == 65 && script[1] == 0x04 && script[66] == 0xac
+            && !convert_pubkey({script.begin() + 1, script.begin() + 66}, true).empty()) {
+            return special(0x04 | (script[65] & 0x01), script.begin() + 2, script.begin() + 34);
+        }
+        write_varint(out, size + NUM_SPECIAL_SCRIPTS);
+        out.write(reinterpret_cast<const char*>(script.data()), size);
+    }
+
+    // `Coin` without its outpoint
+    inline void read_coin(std::istream& in, coin& c) {
+        const uint64_t code = read_varint(in);
+        c.height = code >> 1;
+        c.coinbase = code & 1;
+        c.value = decompress_amount(read_varint(in));
+        c.scriptpubkey = decompress_script(in);
+    }
+
+    inline void write_coin(std::ostream& out, const coin& c) {
+        write_varint(out, uint64_t(c.height) * 2 + c.coinbase);
+        write_varint(out, compress_amount(c.value));
+        compress_script(out, c.scriptpubkey);
+    }
+
+    // reads the coins of a snapshot in file order, coins of the same transaction are grouped since version 2
+    class reader {
+       public:
+        explicit reader(std::istream& in) : _in(in) {
+            char magic[sizeof(MAGIC)];
+            _in.read(magic, sizeof(magic));
+            eosio::check(_in.gcount() == sizeof(magic), "unexpected end of snapshot");
+            if (std::equal(std::begin(magic), std::end(magic), std::begin(MAGIC))) {
+                _metadata.version = read_le<uint16_t>(_in);
+                eosio::check(_metadata.version == VERSION, "unsupported snapshot version");
+                for (auto& byte : _metadata.network_magic) byte = read_byte(_in);
+            } else {
+                _in.seekg(-static_cast<std::streamoff>(sizeof(magic)), std::ios::cur);
+            }
+            _metadata.base_blockhash = read_hash(_in);
+            _metadata.coins_count = read_le<uint64_t>(_in);
+        }
+
+        const metadata& get_metadata() const { return _metadata; }
+
+        std::optional<coin> next() {
+            if (_num_coins == _metadata.coins_count) {
+                return std::nullopt;
+            }
+            coin c;
+            if (_metadata.version == 0) {
+                c.txid = read_hash(_in);
+                c.index = read_le<uint32_t>(_in);
+            } else {
+                if (_pending_in_group == 0) {
+                    _txid = read_hash(_in);
+                    _pending_in_group = read_compact_size(_in);
+                    eosio::check(_pending_in_group > 0, "empty coin group");
+                }
+                c.txid = _txid;
+                const uint64_t index = read_compact_size(_in);
+                eosio::check(index <= std::numeric_limits<uint32_t>::max(), "invalid vout");
+                c.index = index;
+                _pending_in_group--;
+            }
+            read_coin(_in, c);
+            _num_coins++;
+            return c;
+        }
+
+       private:
+        std::istream& _in;
+        metadata _metadata;
+        uint64_t _num_coins = 0;
+        checksum256 _txid;
+        uint64_t _pending_in_group = 0;
+    };
+
+    // writes a snapshot, `version` 0 is the format of Bitcoin Core 26 and 27
+    inline void write(std::ostream& out, const metadata& meta, const std::vector<coin>& coins) {
+        if (meta.version != 0) {
+            out.write(MAGIC, sizeof(MAGIC));
+            write_le<uint16_t>(out, meta.version);
+            out.write(reinterpret_cast<const char*>(meta.network_magic.data()), meta.network_magic.size());
+        }
+        write_hash(out, meta.base_blockhash);
+        write_le<uint64_t>(out, coins.size());
+
+        for (size_t i = 0; i < coins.size();) {
+            if (meta.version == 0) {
+                write_hash(out, coins[i].txid);
+                write_le<uint32_t>(out, coins[i].index);
+                write_coin(out, coins[i++]);
+                continue;
+            }
+            size_t end = i;
+            while (end < coins.size() && coins[end].txid == coins[i].txid) end++;
+            write_hash(out, coins[i].txid);
+            write_compact_size(out, end - i);
+            for (; i < end; i++) {
+                write_compact_size(out, coins[i].index);
+                write_coin(out, coins[i]);
+            }
+        }
+    }
+
+    // mirrors `utxo_manage::update_utxo_set_hash` for an added utxo
+    inline void add_to_set_hash(checksum256& utxo_set_hash, const coin& c) {
+        auto set_hash = bitcoin::be_uint_from_checksum256(utxo_set_hash);
+        auto utxo_hash = bitcoin::be_uint_from_checksum256(
+            xsat::utils::compute_utxo_hash(c.txid, c.index, c.value, c.scriptpubkey));
+        utxo_set_hash = bitcoin::be_checksum256_from_uint(set_hash + utxo_hash);
+    }
+
+    // splits the coins into `addutxos` pages of at most `max_page_size` bytes, starting from the current
+    // `utxocommit` hash of the contract
+    template <typename Callback>
+    uint64_t make_pages(reader& snapshot, const uint32_t max_page_size, checksum256 utxo_set_hash,
+                        Callback&& on_page) {
+        uint64_t num_pages = 0;
+        page current;
+        auto flush = [&]() {
+            current.utxo_set_hash = utxo_set_hash;
+            on_page(current);
+            current = page{};
+            num_pages++;
+        };
+
+        while (auto c = snapshot.next()) {
+            const auto packed = eosio::pack(std::make_tuple(c->txid, c->index, c->value, c->scriptpubkey));
+            eosio::check(packed.size() <= max_page_size, "utxo does not fit in a page");
+            if (current.utxos.size() + packed.size() > max_page_size) {
+                flush();
+            }
+            current.utxos.insert(current.utxos.end(), packed.begin(), packed.end());
+            current.num_utxos++;
+            add_to_set_hash(utxo_set_hash, *c);
+        }
+        if (current.num_utxos > 0) {
+            flush();
+        }
+        return num_pages;
+    }
+}  // namespace xsat::snapshot
@@ -0,0 +1,229 @@
+#include "native.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <bitcoin/core/block_header.hpp>
+#include <bitcoin/core/transaction.hpp>
+#include "snapshot.hpp"
+
+// Round-trip tests of the snapshot converter: coins written in the `dumptxoutset` format are read back, packed into
+// `addutxos` pages, unpacked the way the contract does and hashed with `xsat::utils::compute_utxo_hash`.
+
+static int failures = 0;
+
+static void test(const char* name, const std::function<void()>& fn) {
+    try {
+        fn();
+        std::printf("ok    %s\n", name);
+    } catch (const std::exception& e) {
+        failures++;
+        std::printf("FAIL  %s: %s\n", name, e.what());
+    }
+}
+
+static std::vector<uint8_t> from_hex(const std::string& hex) {
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        data.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return data;
+}
+
+static checksum256 txid_of(const uint8_t n) {
+    std::array<uint8_t, 32> bytes = {};
+    bytes[0] = n;
+    bytes[31] = 0xa5;
+    return checksum256(bytes);
+}
+
+// one coin per script type of `ScriptCompression`, plus amounts on the edges of `CompressAmount`
+static std::vector<xsat::snapshot::coin> sample_coins() {
+    const std::vector<std::vector<uint8_t>> scripts = {
+        // P2PKH
+        from_hex("76a91462e907b15cbf27d5425399ebf6f0fb50ebb88f1888ac"),
+        // P2SH
+        from_hex("a914748284390f9e263a4b766a75d0633c50426eb87587"),
+        // P2PK, compressed public keys of G and -G
+        from_hex("210279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798ac"),
+        from_hex("210379be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798ac"),
+        // P2PK, uncompressed public keys of G (even y) and -G (odd y)
+        from_hex("410479be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798483ada7726a3c4655da4fbfc0e1108a8f"
+                 "d17b448a68554199c47d08ffb10d4b8ac"),
+        from_hex("410479be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798b7c52588d95c3b9aa25b0403f1eef757"
+                 "02e84bb7597aabe663b82f6f04ef2777ac"),
+        // P2WPKH and P2TR are stored raw
+        from_hex("0014751e76e8199196d454941c45d1b3a323f1433bd6"),
+        from_hex("5120a60869f0dbcf1dc659c9cecbaf8050135ea9e8cdc487053f1dc6880949dc684c"),
+        // empty script
+        {},
+    };
+    const std::vector<uint64_t> values = {0, 1, 10, 546, 123456789, 5000000000, 2100000000000000};
+    std::vector<xsat::snapshot::coin> coins;
+    uint8_t n = 0;
+    for (size_t i = 0; i < scripts.size(); i++) {
+        xsat::snapshot::coin c;
+        c.txid = txid_of(n++);
+        c.scriptpubkey = scripts[i];
+        c.value = values[i % values.size()];
+        c.height = 839999 - i;
+        c.coinbase = i == 0;
+        coins.push_back(c);
+        // a second output of the same transaction
+        c.index = 7;
+        c.value = values[(i + 1) % values.size()];
+        coins.push_back(c);
+    }
+    return coins;
+}
+
+static std::vector<xsat::snapshot::coin> read_all(std::istream& in) {
+    xsat::snapshot::reader snapshot(in);
+    std::vector<xsat::snapshot::coin> coins;
+    while (auto c = snapshot.next()) {
+        coins.push_back(*c);
+    }
+    eosio::check(coins.size() == snapshot.get_metadata().coins_count, "coins_count");
+    return coins;
+}
+
+static checksum256 expected_set_hash(const std::vector<xsat::snapshot::coin>& coins) {
+    bitcoin::uint256_t set_hash = 0;
+    for (const auto& c : coins) {
+        set_hash += bitcoin::be_uint_from_checksum256(
+            xsat::utils::compute_utxo_hash(c.txid, c.index, c.value, c.scriptpubkey));
+    }
+    return bitcoin::be_checksum256_from_uint(set_hash);
+}
+
+// pages of `coins`, unpacked the way `utxo_manage::addutxos` reads them
+static void check_pages(const std::vector<xsat::snapshot::coin>& coins, const uint16_t version,
+                        const uint32_t max_page_size) {
+    xsat::snapshot::metadata meta;
+    meta.version = version;
+    std::stringstream stream;
+    xsat::snapshot::write(stream, meta, coins);
+
+    xsat::snapshot::reader snapshot(stream);
+    bitcoin::uint256_t set_hash = 0;
+    size_t next = 0;
+    const auto num_pages = xsat::snapshot::make_pages(snapshot, max_page_size, {}, [&](const auto& page) {
+        eosio::check(page.utxos.size() <= max_page_size, "page is too large");
+        eosio::datastream<const char*> ds(page.utxos.data(), page.utxos.size());
+        uint64_t num_utxos = 0;
+        while (ds.remaining()) {
+            checksum256 txid;
+            uint32_t index;
+            uint64_t value;
+            std::vector<uint8_t> scriptpubkey;
+            ds >> txid >> index >> value >> scriptpubkey;
+            const auto& c = coins[next++];
+            eosio::check(txid == c.txid && index == c.index && value == c.value && scriptpubkey == c.scriptpubkey,
+                         "page does not match the snapshot");
+            set_hash += bitcoin::be_uint_from_checksum256(
+                xsat::utils::compute_utxo_hash(txid, index, value, scriptpubkey));
+            num_utxos++;
+        }
+        eosio::check(num_utxos == page.num_utxos, "num_utxos");
+        eosio::check(bitcoin::be_checksum256_from_uint(set_hash) == page.utxo_set_hash,
+                     "declared utxo_set_hash does not match the page");
+    });
+    eosio::check(next == coins.size(), "every coin is paged");
+    eosio::check(num_pages > 0, "num_pages");
+    eosio::check(bitcoin::be_checksum256_from_uint(set_hash) == expected_set_hash(coins), "utxo_set_hash");
+}
+
+int main(int argc, char** argv) {
+    const std::string dir = argc > 1 ? argv[1] : "../data";
+
+    test("varint", [] {
+        for (const uint64_t n : {0ull, 1ull, 127ull, 128ull, 255ull, 16511ull, 16512ull, 1ull << 32, ~0ull >> 1}) {
+            std::stringstream stream;
+            xsat::snapshot::write_varint(stream, n);
+            eosio::check(xsat::snapshot::read_varint(stream) == n, "varint " + std::to_string(n));
+        }
+        // encodings of Bitcoin Core's serialize_tests
+        std::stringstream stream;
+        xsat::snapshot::write_varint(stream, 0x80);
+        eosio::check(stream.str() == std::string("\x80\x00", 2), "0x80");
+    });
+
+    test("amount", [] {
+        eosio::check(xsat::snapshot::compress_amount(0) == 0, "0");
+        eosio::check(xsat::snapshot::compress_amount(1) == 1, "1");
+        eosio::check(xsat::snapshot::compress_amount(100000000) == 9, "1 BTC");
+        eosio::check(xsat::snapshot::compress_amount(5000000000) == 50, "50 BTC");
+        eosio::check(xsat::snapshot::compress_amount(2100000000000000) == 21000000, "21M BTC");
+        for (uint64_t n = 0; n < 100000; n++) {
+            eosio::check(xsat::snapshot::decompress_amount(xsat::snapshot::compress_amount(n)) == n,
+                         "amount " + std::to_string(n));
+        }
+    });
+
+    test("script: special types are compressed", [] {
+        const auto coins = sample_coins();
+        const std::vector<uint8_t> expected = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05};
+        for (size_t i = 0; i < expected.size(); i++) {
+            std::stringstream stream;
+            xsat::snapshot::compress_script(stream, coins[i * 2].scriptpubkey);
+            eosio::check(static_cast<uint8_t>(stream.str()[0]) == expected[i], "type " + std::to_string(i));
+            eosio::check(xsat::snapshot::decompress_script(stream) == coins[i * 2].scriptpubkey,
+                         "script " + std::to_string(i));
+        }
+    });
+
+    test("reader: version 2 and legacy", [] {
+        const auto coins = sample_coins();
+        for (const uint16_t version : {uint16_t(0), xsat::snapshot::VERSION}) {
+            xsat::snapshot::metadata meta;
+            meta.version = version;
+            meta.base_blockhash = txid_of(0xff);
+            std::stringstream stream;
+            xsat::snapshot::write(stream, meta, coins);
+            xsat::snapshot::reader snapshot(stream);
+            eosio::check(snapshot.get_metadata().version == version, "version");
+            eosio::check(snapshot.get_metadata().base_blockhash == meta.base_blockhash, "base_blockhash");
+            stream.seekg(0);
+            eosio::check(read_all(stream) == coins, "coins of version " + std::to_string(version));
+        }
+    });
+
+    test("pages: round trip against compute_utxo_hash", [] {
+        const auto coins = sample_coins();
+        for (const uint16_t version : {uint16_t(0), xsat::snapshot::VERSION}) {
+            for (const uint32_t max_page_size : {128u, 1024u, xsat::snapshot::MAX_PAGE_SIZE}) {
+                check_pages(coins, version, max_page_size);
+            }
+        }
+    });
+
+    test("pages: outputs of 840002", [&] {
+        auto block_data = read_fixture(dir, 840002);
+        eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+        bitcoin::core::block_header block_header;
+        block_stream >> block_header;
+        const auto num_transactions = bitcoin::varint::decode(block_stream);
+
+        std::vector<xsat::snapshot::coin> coins;
+        for (uint64_t i = 0; i < num_transactions; i++) {
+            bitcoin::core::transaction transaction(&block_data, i == 0);
+            block_stream >> transaction;
+            const auto txid = transaction.txid();
+            for (uint32_t index = 0; index < transaction.outputs.size(); index++) {
+                if (xsat::utils::is_unspendable_legacy(transaction.outputs[index].script.data)) continue;
+                xsat::snapshot::coin c;
+                c.txid = txid;
+                c.index = index;
+                c.value = transaction.outputs[index].value;
+                c.scriptpubkey = transaction.outputs[index].script.data;
+                c.height = 840002;
+                c.coinbase = i == 0;
+                coins.push_back(c);
+            }
+        }
+        check_pages(coins, xsat::snapshot::VERSION, xsat::snapshot::MAX_PAGE_SIZE / 8);
+    });
+
+    std::printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -22,6 +22,10 @@ const contracts = {
 blockchain.createAccounts('fees.xsat', 'alice', 'amy', 'anna', 'bob', 'brian')
 
 const get_endorsements = height => {
+    return contracts.blkendt.tables.endorsebits(BigInt(height)).getTableRows()
+}
+
+const get_legacy_endorsements = height => {
     return contracts.blkendt.tables.endorsements(BigInt(height)).getTableRows()
 }
 
@@ -29,6 +33,14 @@ const get_config = () => {
     return contracts.blkendt.tables.config().getTableRows()[0]
 }
 
+const get_validator_sets = () => {
+    return contracts.blkendt.tables.valsets().getTableRows()
+}
+
+const get_validator_members = validator_set_id => {
+    return contracts.blkendt.tables.valmembers(BigInt(validator_set_id)).getTableRows()
+}
+
 // one-time setup
 beforeAll(async () => {
     blockchain.setTime(TimePointSec.from(new Date()))
@@ -214,27 +226,16 @@ describe('blkendt.xsat', () => {
         const height = 840000
         const hash = '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5'
         await contracts.blkendt.actions.endorse(['alice', height, hash]).send('alice@active')
+        const created_at = TimePointSec.from(blockchain.timestamp).toString()
         expect(get_endorsements(height)).toEqual([
             {
                 id: 0,
                 hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
-                requested_validators: [
-                    {
-                        account: 'bob',
-                        staking: '20000000000',
-                    },
-                    {
-                        account: 'brian',
-                        staking: '30000000000',
-                    },
-                ],
-                provider_validators: [
-                    {
-                        account: 'alice',
-                        staking: '10000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                ],
+                validator_set_id: 0,
+                num_validators: 3,
+                provider_bitmap: '01',
+                consensus_bitmap: '',
+                created_at,
             },
         ])
         await contracts.blkendt.actions.endorse(['bob', height, hash]).send('bob@active')
@@ -242,24 +243,11 @@ describe('blkendt.xsat', () => {
             {
                 id: 0,
                 hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
-                requested_validators: [
-                    {
-                        account: 'brian',
-                        staking: '30000000000',
-                    },
-                ],
-                provider_validators: [
-                    {
-                        account: 'alice',
-                        staking: '10000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                    {
-                        account: 'bob',
-                        staking: '20000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                ],
+                validator_set_id: 0,
+                num_validators: 3,
+                provider_bitmap: '03',
+                consensus_bitmap: '',
+                created_at,
             },
         ])
         await contracts.blkendt.actions.endorse(['brian', height, hash]).send('brian@active')
@@ -267,26 +255,46 @@ describe('blkendt.xsat', () => {
             {
                 id: 0,
                 hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
-                requested_validators: [],
-                provider_validators: [
-                    {
-                        account: 'alice',
-                        staking: '10000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                    {
-                        account: 'bob',
-                        staking: '20000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                    {
-                        account: 'brian',
-                        staking: '30000000000',
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                ],
+                validator_set_id: 0,
+                num_validators: 3,
+                provider_bitmap: '07',
+                consensus_bitmap: '07',
+                created_at,
+            },
+        ])
+    })
+
+    it('endorse: validator set is snapshotted once per epoch', async () => {
+        expect(get_validator_sets()).toEqual([
+            {
+                id: 0,
+                epoch: 416,
+                xsat_stake_active: false,
+                min_qualification: '10000000000',
+                num_validators: 3,
+                created_at: TimePointSec.from(blockchain.timestamp).toString(),
             },
         ])
+        expect(get_validator_members(0)).toEqual([
+            { account: 'alice', index: 0, staking: '10000000000' },
+            { account: 'bob', index: 1, staking: '20000000000' },
+            { account: 'brian', index: 2, staking: '30000000000' },
+        ])
+
+        // a competing hash in the same epoch reuses the snapshot
+        const height = 840000
+        const hash = '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463'
+        await contracts.blkendt.actions.endorse(['bob', height, hash]).send('bob@active')
+        expect(get_endorsements(height)[1]).toEqual({
+            id: 1,
+            hash,
+            validator_set_id: 0,
+            num_validators: 3,
+            provider_bitmap: '02',
+            consensus_bitmap: '',
+            created_at: TimePointSec.from(blockchain.timestamp).toString(),
+        })
+        expect(get_validator_sets().length).toEqual(1)
     })
 
     it('endorse: validator is on the list of provider validators', async () => {
@@ -298,6 +306,62 @@ describe('blkendt.xsat', () => {
         )
     })
 
+    it('batchendorse: missing required authority', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions
+                .batchendorse(['brian', [{ height: 840000, hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463' }]])
+                .send('alice@active'),
+            'missing required authority brian'
+        )
+    })
+
+    it('batchendorse: blocks cannot be empty', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.batchendorse(['brian', []]).send('brian@active'),
+            'eosio_assert: blkendt.xsat::batchendorse: blocks cannot be empty'
+        )
+    })
+
+    it('batchendorse: validator is on the list of provider validators', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions
+                .batchendorse([
+                    'brian',
+                    [
+                        { height: 840000, hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463' },
+                        { height: 840000, hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5' },
+                    ],
+                ])
+                .send('brian@active'),
+            'eosio_assert: 1006:blkendt.xsat::endorse: validator is on the list of provider validators'
+        )
+        expect(get_endorsements(840000)[1].provider_bitmap).toEqual('02')
+    })
+
+    it('batchendorse', async () => {
+        await contracts.blkendt.actions
+            .batchendorse([
+                'brian',
+                [
+                    { height: 840000, hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463' },
+                    { height: 840001, hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463' },
+                ],
+            ])
+            .send('brian@active')
+        expect(get_endorsements(840000)[1].provider_bitmap).toEqual('06')
+        expect(get_endorsements(840001)).toEqual([
+            {
+                id: 0,
+                hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463',
+                validator_set_id: 0,
+                num_validators: 3,
+                provider_bitmap: '04',
+                consensus_bitmap: '',
+                created_at: TimePointSec.from(blockchain.timestamp).toString(),
+            },
+        ])
+    })
+
     it('config', async () => {
         await contracts.blkendt.actions.config([1, 0, 2, 860000, 0, '21000.00000000 XSAT']).send('blkendt.xsat@active')
         expect(get_config()).toEqual({
@@ -408,21 +472,17 @@ describe('blkendt.xsat', () => {
             {
                 id: 0,
                 hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463',
-                requested_validators: [
-                    {
-                        account: 'alice',
-                        staking: Asset.from(100, BTC).units.toString(),
-                    },
-                ],
-                provider_validators: [
-                    {
-                        account: 'anna',
-                        staking: Asset.from(10, BTC).units.toNumber(),
-                        created_at: TimePointSec.from(blockchain.timestamp).toString(),
-                    },
-                ],
+                validator_set_id: 1,
+                num_validators: 2,
+                provider_bitmap: '02',
+                consensus_bitmap: '',
+                created_at: TimePointSec.from(blockchain.timestamp).toString(),
             },
         ])
+        expect(get_validator_members(1)).toEqual([
+            { account: 'alice', index: 0, staking: Asset.from(100, BTC).units.toString() },
+            { account: 'anna', index: 1, staking: Asset.from(10, BTC).units.toNumber() },
+        ])
     })
 
     it('add consensus block 860000', async () => {
@@ -470,3 +530,142 @@ describe('blkendt.xsat', () => {
         )
     })
 })
+
+describe('blkendt.xsat: endorsements written before endorsebits', () => {
+    const hash = '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5'
+    const other_hash = '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463'
+    const endorsed_at = '2024-08-13T00:00:00'
+    const provider = (account, staking) => ({ account, staking, created_at: endorsed_at })
+    const requested = (account, staking) => ({ account, staking })
+
+    it('migrateendt: missing required authority', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.migrateendt([840002]).send('alice@active'),
+            'missing required authority blkendt.xsat'
+        )
+    })
+
+    it('migrateendt: no legacy endorsements at this height', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.migrateendt([840002]).send('blkendt.xsat@active'),
+            'eosio_assert: blkendt.xsat::migrateendt: no legacy endorsements at this height'
+        )
+    })
+
+    it('endorse: a legacy endorsement is migrated first', async () => {
+        await contracts.blkendt.actions
+            .addlegacyend([
+                840002,
+                hash,
+                [provider('alice', '10000000000'), provider('bob', '20000000000')],
+                [requested('brian', '30000000000')],
+            ])
+            .send('blkendt.xsat@active')
+        expect(get_legacy_endorsements(840002).length).toEqual(1)
+
+        await contracts.blkendt.actions.endorse(['brian', 840002, hash]).send('brian@active')
+        expect(get_legacy_endorsements(840002)).toEqual([])
+        expect(get_endorsements(840002)).toEqual([
+            {
+                id: 0,
+                hash,
+                validator_set_id: 2,
+                num_validators: 3,
+                provider_bitmap: '07',
+                consensus_bitmap: '07',
+                created_at: endorsed_at,
+            },
+        ])
+        expect(get_validator_sets()[2]).toEqual({
+            id: 2,
+            epoch: 416,
+            xsat_stake_active: false,
+            min_qualification: 0,
+            num_validators: 3,
+            created_at: TimePointSec.from(blockchain.timestamp).toString(),
+        })
+        expect(get_validator_members(2)).toEqual([
+            { account: 'alice', index: 0, staking: '10000000000' },
+            { account: 'bob', index: 1, staking: '20000000000' },
+            { account: 'brian', index: 2, staking: '30000000000' },
+        ])
+    })
+
+    it('migrateendt: the block already has an endorsement in endorsebits', async () => {
+        await contracts.blkendt.actions
+            .addlegacyend([840002, hash, [provider('alice', '10000000000')], [requested('bob', '20000000000')]])
+            .send('blkendt.xsat@active')
+        await expectToThrow(
+            contracts.blkendt.actions.migrateendt([840002]).send('blkendt.xsat@active'),
+            'eosio_assert: blkendt.xsat::migrateendt: the block already has an endorsement in endorsebits'
+        )
+        await contracts.blkendt.actions.cleartable(['endorsements', 840002, 0]).send('blkendt.xsat@active')
+    })
+
+    it('migrateendt', async () => {
+        // every validator endorsed, only the first quorum of 3 shares the consensus rewards
+        await contracts.blkendt.actions
+            .addlegacyend([
+                840003,
+                hash,
+                [
+                    provider('bob', '20000000000'),
+                    provider('alice', '10000000000'),
+                    provider('brian', '30000000000'),
+                    provider('anna', '1000000000'),
+                ],
+                [],
+            ])
+            .send('blkendt.xsat@active')
+        // a competing block that has not reached consensus
+        await contracts.blkendt.actions
+            .addlegacyend([840003, other_hash, [provider('anna', '1000000000')], [requested('alice', '10000000000')]])
+            .send('blkendt.xsat@active')
+
+        await contracts.blkendt.actions.migrateendt([840003]).send('blkendt.xsat@active')
+        expect(get_legacy_endorsements(840003)).toEqual([])
+        expect(get_endorsements(840003)).toEqual([
+            {
+                id: 0,
+                hash,
+                validator_set_id: 3,
+                num_validators: 4,
+                provider_bitmap: '0f',
+                consensus_bitmap: '07',
+                created_at: endorsed_at,
+            },
+            {
+                id: 1,
+                hash: other_hash,
+                validator_set_id: 4,
+                num_validators: 2,
+                provider_bitmap: '01',
+                consensus_bitmap: '',
+                created_at: endorsed_at,
+            },
+        ])
+        expect(get_validator_members(3)).toEqual([
+            { account: 'alice', index: 1, staking: '10000000000' },
+            { account: 'anna', index: 3, staking: 1000000000 },
+            { account: 'bob', index: 0, staking: '20000000000' },
+            { account: 'brian', index: 2, staking: '30000000000' },
+        ])
+        expect(get_validator_members(4)).toEqual([
+            { account: 'alice', index: 1, staking: '10000000000' },
+            { account: 'anna', index: 0, staking: 1000000000 },
+        ])
+
+        // the migrated snapshots are not reused by new endorsements
+        await contracts.blkendt.actions.endorse(['bob', 840004, hash]).send('bob@active')
+        expect(get_endorsements(840004)[0].validator_set_id).toEqual(0)
+    })
+
+    it('erase: drops legacy endorsements', async () => {
+        await contracts.blkendt.actions
+            .addlegacyend([840004, other_hash, [provider('alice', '10000000000')], [requested('bob', '20000000000')]])
+            .send('blkendt.xsat@active')
+        await contracts.blkendt.actions.erase([840004]).send('utxomng.xsat@active')
+        expect(get_endorsements(840004)).toEqual([])
+        expect(get_legacy_endorsements(840004)).toEqual([])
+    })
+})
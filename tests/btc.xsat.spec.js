@@ -0,0 +1,138 @@
+const { Asset, Name, UInt64 } = require('@greymass/eosio')
+const { Blockchain, expectToThrow } = require('@proton/vert')
+const { BTC, XSAT } = require('./src/constants')
+const { getTokenBalance } = require('./src/help')
+
+// Vert EOS VM
+const blockchain = new Blockchain()
+// btc.xsat and exsat.xsat share the token code, `transfers` is covered for both
+const TOKENS = [
+    {
+        name: 'btc.xsat',
+        contract: blockchain.createContract('btc.xsat', 'tests/wasm/btc.xsat', true),
+        symbol: BTC,
+    },
+    {
+        name: 'exsat.xsat',
+        contract: blockchain.createContract('exsat.xsat', 'tests/wasm/exsat.xsat', true),
+        symbol: XSAT,
+    },
+]
+
+blockchain.createAccounts('alice', 'bob', 'carol', 'dave', 'erin')
+
+const traces_of = action => blockchain.actionTraces.filter(trace => trace.action.toString() === action)
+
+// the account paying the RAM of the `accounts` row of `owner`
+const get_payer = (contract, owner, symbol) => {
+    const table = blockchain.store.findTable(
+        BigInt(Name.from(contract).value.toString()),
+        BigInt(Name.from(owner).value.toString()),
+        BigInt(Name.from('accounts').value.toString())
+    )
+    const payer = table.get(BigInt(symbol.code.value.toString())).payer
+    return payer instanceof Name ? payer.toString() : new Name(UInt64.from(payer.toString())).toString()
+}
+
+for (const { name, contract, symbol } of TOKENS) {
+    describe(`${name}: transfers`, () => {
+        const quantity = amount => Asset.from(amount, symbol).toString()
+        const balance = account => getTokenBalance(blockchain, account, name, symbol.code.toString())
+
+        beforeAll(async () => {
+            await contract.actions.create([name, quantity(10000000)]).send(`${name}@active`)
+            await contract.actions.issue([name, quantity(10000000), 'init']).send(`${name}@active`)
+            await contract.actions.transfer([name, 'alice', quantity(1000), '']).send(`${name}@active`)
+        })
+
+        it('recipients cannot be empty', async () => {
+            await expectToThrow(
+                contract.actions.transfers(['alice', []]).send('alice@active'),
+                'eosio_assert: recipients cannot be empty'
+            )
+        })
+
+        it('missing required authority', async () => {
+            await expectToThrow(
+                contract.actions
+                    .transfers(['alice', [{ to: 'bob', quantity: quantity(1), memo: '' }]])
+                    .send('bob@active'),
+                'missing required authority alice'
+            )
+        })
+
+        it('cannot transfer to self', async () => {
+            const recipients = [
+                { to: 'bob', quantity: quantity(1), memo: '' },
+                { to: 'alice', quantity: quantity(1), memo: '' },
+            ]
+            await expectToThrow(
+                contract.actions.transfers(['alice', recipients]).send('alice@active'),
+                'eosio_assert: cannot transfer to self'
+            )
+        })
+
+        it('symbol precision mismatch', async () => {
+            const mismatch = Asset.from(1, Asset.Symbol.fromParts(symbol.code.toString(), 4)).toString()
+            const recipients = [
+                { to: 'bob', quantity: quantity(1), memo: '' },
+                { to: 'carol', quantity: mismatch, memo: '' },
+            ]
+            await expectToThrow(
+                contract.actions.transfers(['alice', recipients]).send('alice@active'),
+                'eosio_assert: symbol precision mismatch'
+            )
+        })
+
+        it('overdrawn balance', async () => {
+            // each quantity is covered, the sum is not
+            const recipients = [
+                { to: 'bob', quantity: quantity(600), memo: '' },
+                { to: 'carol', quantity: quantity(600), memo: '' },
+            ]
+            await expectToThrow(
+                contract.actions.transfers(['alice', recipients]).send('alice@active'),
+                'eosio_assert: overdrawn balance'
+            )
+        })
+
+        it('debit the sum once and credit each recipient', async () => {
+            const recipients = [
+                { to: 'bob', quantity: quantity(1), memo: 'bob' },
+                { to: 'carol', quantity: quantity(2), memo: 'carol' },
+                // listed twice, credited with the sum
+                { to: 'bob', quantity: quantity(3), memo: 'bob again' },
+            ]
+            const before = { alice: balance('alice'), bob: balance('bob'), carol: balance('carol') }
+            await contract.actions.transfers(['alice', recipients]).send('alice@active')
+
+            const units = amount => Asset.from(amount, symbol).units.toNumber()
+            expect(before.alice - balance('alice')).toEqual(units(6))
+            expect(balance('bob') - before.bob).toEqual(units(4))
+            expect(balance('carol') - before.carol).toEqual(units(2))
+
+            const [log] = traces_of('transferslog')
+            expect(Asset.from(log.decodedData.quantity).toString()).toEqual(quantity(6))
+            expect(Asset.from(log.decodedData.balance).toString()).toEqual(quantity(994))
+            expect(log.decodedData.recipients.length).toEqual(3)
+
+            // `from` and every distinct recipient are notified with `transfers`
+            const notified = traces_of('transfers').map(trace => trace.contract.toString())
+            expect(notified).toEqual([name, 'alice', 'bob', 'carol'])
+        })
+
+        it('the RAM of a new balance is paid by `from` unless the recipient signs', async () => {
+            const recipients = [
+                { to: 'dave', quantity: quantity(1), memo: '' },
+                { to: 'erin', quantity: quantity(1), memo: '' },
+            ]
+            await contract.actions.transfers(['alice', recipients]).send([
+                { actor: 'alice', permission: 'active' },
+                { actor: 'erin', permission: 'active' },
+            ])
+
+            expect(get_payer(name, 'dave', symbol)).toEqual('alice')
+            expect(get_payer(name, 'erin', symbol)).toEqual('erin')
+        })
+    })
+}
@@ -10,5 +10,16 @@ cdt-cpp ../../contracts/staking.xsat/staking.xsat.cpp -I ../../contracts/ -I ../
 cdt-cpp ../../contracts/xsatstk.xsat/xsatstk.xsat.cpp -I ../../contracts/ -I ../../external -DDEBUG 
 cdt-cpp ../../contracts/blkendt.xsat/blkendt.xsat.cpp -I ../../contracts/ -I ../../external -DDEBUG
 cdt-cpp ../../contracts/endrmng.xsat/endrmng.xsat.cpp -I ../../contracts/ -I ../../external -DDEBUG
+cdt-cpp ../../contracts/custody.xsat/custody.xsat.cpp -I ../../contracts/ -I ../../external -I ../../external/intx/include -DDEBUG
 cdt-cpp ../../contracts/blksync.xsat/blksync.xsat.cpp -I ../../contracts/ -I ../../external -I ../../external/intx/include -DDEBUG
 cdt-cpp ../../contracts/utxomng.xsat/utxomng.xsat.cpp -I ../../contracts/ -I ../../external -I ../../external/intx/include -DDEBUG
+
+# operation counters, see contracts/internal/profile.hpp
+mkdir -p profile && cd profile
+cdt-cpp ../../../contracts/blksync.xsat/blksync.xsat.cpp -I ../../../contracts/ -I ../../../external -I ../../../external/intx/include -DDEBUG -DPROFILE
+cdt-cpp ../../../contracts/utxomng.xsat/utxomng.xsat.cpp -I ../../../contracts/ -I ../../../external -I ../../../external/intx/include -DDEBUG -DPROFILE
+
+# inline log actions, see contracts/internal/events.hpp
+cd .. && mkdir -p legacy_log && cd legacy_log
+cdt-cpp ../../../contracts/btc.xsat/btc.xsat.cpp -I ../../../contracts/ -DDEBUG -DLEGACY_LOG
+cdt-cpp ../../../contracts/rescmng.xsat/rescmng.xsat.cpp -I ../../../contracts/ -I ../../../external -DDEBUG -DLEGACY_LOG
@@ -0,0 +1,177 @@
+const { Asset } = require('@greymass/eosio')
+const { Blockchain, expectToThrow } = require('@proton/vert')
+const { BTC } = require('./src/constants')
+
+// Vert EOS VM
+const blockchain = new Blockchain()
+// contracts
+const contracts = {
+    custody: blockchain.createContract('custody.xsat', 'tests/wasm/custody.xsat', true),
+    endrmng: blockchain.createContract('endrmng.xsat', 'tests/wasm/endrmng.xsat', true),
+}
+
+blockchain.createAccounts('utxomng.xsat', 'alice', 'bob')
+
+const PROXY = '0000000000000000000000000000000000000001'
+const STAKERS = {
+    amy: 'e4d68a77714d9d388d8233bee18d578559950cf5',
+    anna: '1231deb6f5749ef6ce6943a275a1d3e7486f4eae',
+    tony: 'ee37064f01ec9314278f4984ff4b9b695eb91912',
+    // without a custody record
+    unknown: 'bb776ae86d5996908af46482f24be8ccde2d4c41',
+    // credited before custody balances were tracked
+    legacy: '9c0e3f2e7c84d6ab7c5ad1d4b8c2c3e36d9a4f10',
+}
+const MAX_STAKING = 10000000000
+
+const get_custody = staker => {
+    return contracts.custody.tables
+        .custodies()
+        .getTableRows()
+        .find(row => row.staker === staker)
+}
+
+// credit stake of `staker` in endrmng.xsat
+const get_stake = staker => {
+    const row = contracts.endrmng.tables
+        .evmstakers()
+        .getTableRows()
+        .find(row => row.staker === staker)
+    return row ? Asset.from(row.quantity).units.toNumber() : 0
+}
+
+const get_balance = staker => {
+    return contracts.custody.tables.balances().getTableRow(BigInt(get_custody(staker).id))
+}
+
+const traces_of = action => blockchain.actionTraces.filter(trace => trace.action.toString() === action)
+
+// one-time setup
+beforeAll(async () => {
+    await contracts.endrmng.actions.regvalidator(['alice', 'alice', 0]).send('alice@active')
+    await contracts.endrmng.actions.addcrdtproxy([PROXY]).send('endrmng.xsat@active')
+
+    let n = 0
+    for (const staker of [STAKERS.amy, STAKERS.anna, STAKERS.tony]) {
+        await contracts.custody.actions
+            .addcustody([staker, PROXY, 'alice', null, `51${(++n).toString(16).padStart(2, '0')}`])
+            .send('custody.xsat@active')
+    }
+})
+
+describe('custody.xsat', () => {
+    it('creditstakes: missing required authority', async () => {
+        await expectToThrow(
+            contracts.custody.actions.creditstakes([[{ staker: STAKERS.amy, balance: 0 }]]).send('bob@active'),
+            'missing required authority custody.xsat'
+        )
+    })
+
+    it('creditstakes: balances cannot be empty', async () => {
+        await expectToThrow(
+            contracts.custody.actions.creditstakes([[]]).send('custody.xsat@active'),
+            'eosio_assert: custody.xsat::creditstakes: balances cannot be empty'
+        )
+    })
+
+    it('creditstakes: only changed stakers are sent in one endrmng.xsat::creditstakes', async () => {
+        await contracts.custody.actions.creditstake([STAKERS.amy, MAX_STAKING]).send('custody.xsat@active')
+        expect(get_stake(STAKERS.amy)).toEqual(MAX_STAKING)
+
+        await contracts.custody.actions
+            .creditstakes([
+                [
+                    { staker: STAKERS.unknown, balance: MAX_STAKING },
+                    // unchanged
+                    { staker: STAKERS.amy, balance: MAX_STAKING + 1 },
+                    { staker: STAKERS.anna, balance: MAX_STAKING - 1 },
+                    // changed
+                    { staker: STAKERS.tony, balance: MAX_STAKING },
+                ],
+            ])
+            .send('custody.xsat@active')
+
+        expect(traces_of('creditstake').length).toEqual(0)
+        const calls = traces_of('creditstakes').filter(trace => trace.contract.toString() === 'endrmng.xsat')
+        expect(calls.length).toEqual(1)
+        expect(calls[0].decodedData.stakes.map(stake => stake.staker.toString())).toEqual([STAKERS.tony])
+        expect(traces_of('evmstakelog').length).toEqual(1)
+
+        expect(get_stake(STAKERS.amy)).toEqual(MAX_STAKING)
+        expect(get_stake(STAKERS.anna)).toEqual(0)
+        expect(get_stake(STAKERS.tony)).toEqual(MAX_STAKING)
+        expect(get_custody(STAKERS.tony).value).toEqual(MAX_STAKING)
+        expect(get_custody(STAKERS.unknown)).toBeUndefined()
+    })
+
+    it('creditstakes: nothing is sent when no stake changes', async () => {
+        await contracts.custody.actions
+            .creditstakes([[{ staker: STAKERS.tony, balance: MAX_STAKING }]])
+            .send('custody.xsat@active')
+
+        // custody.xsat::creditstakes only
+        expect(traces_of('creditstakes').length).toEqual(1)
+    })
+
+    it('creditstakes: the stake in endrmng.xsat decides when `value` drifted', async () => {
+        // endrmng.xsat no longer holds the stake custody.xsat last sent
+        await contracts.endrmng.actions
+            .creditstake([PROXY, STAKERS.tony, 'alice', Asset.from(0, BTC)])
+            .send('custody.xsat@active')
+        expect(get_stake(STAKERS.tony)).toEqual(0)
+        expect(get_custody(STAKERS.tony).value).toEqual(MAX_STAKING)
+
+        await contracts.custody.actions
+            .creditstakes([[{ staker: STAKERS.tony, balance: MAX_STAKING }]])
+            .send('custody.xsat@active')
+
+        expect(traces_of('creditstakes').length).toEqual(2)
+        expect(get_stake(STAKERS.tony)).toEqual(MAX_STAKING)
+        expect(get_custody(STAKERS.tony).value).toEqual(MAX_STAKING)
+    })
+
+    it('syncbalances: missing required authority', async () => {
+        await expectToThrow(
+            contracts.custody.actions.syncbalances([1, [{ id: 1, value: 1 }]]).send('custody.xsat@active'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('syncbalances: a custody without a seeded balance is skipped', async () => {
+        await contracts.custody.actions
+            .addcustody([STAKERS.legacy, PROXY, 'alice', null, '5104'])
+            .send('custody.xsat@active')
+        await contracts.endrmng.actions
+            .creditstake([PROXY, STAKERS.legacy, 'alice', Asset.from(MAX_STAKING / 100000000, BTC)])
+            .send('custody.xsat@active')
+        expect(get_stake(STAKERS.legacy)).toEqual(MAX_STAKING)
+
+        await contracts.custody.actions
+            .syncbalances([1, [{ id: get_custody(STAKERS.legacy).id, value: 1000 }]])
+            .send('utxomng.xsat@active')
+
+        expect(get_balance(STAKERS.legacy)).toBeUndefined()
+        expect(traces_of('creditstakes').length).toEqual(0)
+        expect(get_stake(STAKERS.legacy)).toEqual(MAX_STAKING)
+    })
+
+    it('syncbalances: a stake endrmng.xsat rejects is flagged and retried with the next change', async () => {
+        await contracts.endrmng.actions.setstatus(['alice', true]).send('endrmng.xsat@active')
+
+        // amy drops below `MAX_STAKING`, the unstake would fail on the disabled validator
+        await contracts.custody.actions
+            .syncbalances([1, [{ id: get_custody(STAKERS.amy).id, value: -2 }]])
+            .send('utxomng.xsat@active')
+        expect(traces_of('creditstakes').length).toEqual(0)
+        expect(get_stake(STAKERS.amy)).toEqual(MAX_STAKING)
+        expect(get_balance(STAKERS.amy)).toMatchObject({ balance: MAX_STAKING - 1, stake_pending: true })
+
+        await contracts.endrmng.actions.setstatus(['alice', false]).send('endrmng.xsat@active')
+        await contracts.custody.actions
+            .syncbalances([2, [{ id: get_custody(STAKERS.amy).id, value: -1 }]])
+            .send('utxomng.xsat@active')
+        expect(traces_of('creditstakes').length).toEqual(1)
+        expect(get_stake(STAKERS.amy)).toEqual(0)
+        expect(get_balance(STAKERS.amy)).toMatchObject({ balance: MAX_STAKING - 2, stake_pending: false })
+    })
+})
@@ -11,6 +11,7 @@ const contracts = {
     endrmng: blockchain.createContract('endrmng.xsat', 'tests/wasm/endrmng.xsat', true),
     eos: blockchain.createContract('eosio.token', 'tests/wasm/exsat.xsat', true),
     exsat: blockchain.createContract('exsat.xsat', 'tests/wasm/exsat.xsat', true),
+    blkendt: blockchain.createContract('blkendt.xsat', 'tests/wasm/blkendt.xsat', true),
 }
 
 blockchain.createAccounts(
@@ -19,6 +20,8 @@ blockchain.createAccounts(
     'rwddist.xsat',
     'custody.xsat',
     'donate.xsat',
+    'evmutil.xsat',
+    'erc2o.xsat',
     'alice',
     'bob',
     'amy',
@@ -47,10 +50,31 @@ const get_validator = validatory => {
     return contracts.endrmng.tables.validators().getTableRow(key)
 }
 
+const get_qualified = scope => {
+    return contracts.endrmng.tables.qualified(Name.from(scope).value.value).getTableRows()
+}
+
+const get_qualified_stat = () => {
+    return contracts.endrmng.tables.qualstat().getTableRows()[0]
+}
+
+const get_pending_reward = validator => {
+    const key = Name.from(validator).value.value
+    return contracts.endrmng.tables.pendingrwds().getTableRow(key)
+}
+
 const get_native_staker = staker_id => {
     return contracts.endrmng.tables.stakers().getTableRow(BigInt(staker_id))
 }
 
+const get_stat = () => {
+    return contracts.endrmng.tables.stat().getTableRows()[0]
+}
+
+const units = asset => Asset.from(asset).units.toNumber()
+
+const traces_of = action => blockchain.actionTraces.filter(trace => trace.action.toString() === action)
+
 const get_evm_staker = staker => {
     const key = Name.from(staker).value.value
     return contracts.endrmng.tables.evmstakers().getTableRow(key)
@@ -555,6 +579,27 @@ describe('endrmng.xsat', () => {
         })
     })
 
+    it('stake: validator crosses the qualification threshold', async () => {
+        expect(get_qualified('btc')).toEqual([
+            { validator: 'alice', quantity: '100.00000000 BTC', xsat_quantity: '0.00000000 XSAT' },
+        ])
+        expect(get_qualified('xsat')).toEqual([])
+        expect(get_qualified_stat()).toEqual({
+            min_xsat_qualification: '0.00000000 XSAT',
+            num_btc_validators: 1,
+            btc_qualified_staking: '100.00000000 BTC',
+            num_xsat_validators: 0,
+            xsat_qualified_staking: '0.00000000 XSAT',
+        })
+    })
+
+    it('setxsatqual: missing required authority', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.setxsatqual(['21000.00000000 XSAT']).send('alice@active'),
+            'missing required authority blkendt.xsat'
+        )
+    })
+
     it('unstake: missing required authority', async () => {
         await expectToThrow(
             contracts.endrmng.actions.unstake(['tony', 'amy', Asset.from(100, BTC)]).send('alice@active'),
@@ -627,6 +672,17 @@ describe('endrmng.xsat', () => {
         })
     })
 
+    it('unstake: validator drops below the qualification threshold', async () => {
+        expect(get_qualified('btc')).toEqual([])
+        expect(get_qualified_stat()).toEqual({
+            min_xsat_qualification: '0.00000000 XSAT',
+            num_btc_validators: 0,
+            btc_qualified_staking: '0.00000000 BTC',
+            num_xsat_validators: 0,
+            xsat_qualified_staking: '0.00000000 XSAT',
+        })
+    })
+
     it('newstake: missing required authority', async () => {
         await expectToThrow(
             contracts.endrmng.actions.newstake(['tony', 'alice', 'tony', Asset.from(100, BTC)]).send('alice@active'),
@@ -798,6 +854,24 @@ describe('endrmng.xsat', () => {
             ])
             .send('rwddist.xsat@active')
 
+        // rewards are only accumulated until the validator is settled
+        expect(get_pending_reward('alice')).toEqual({
+            validator: 'alice',
+            staking_rewards: '22.50000000 XSAT',
+            consensus_rewards: '2.50000000 XSAT',
+            latest_reward_block: 840000,
+            latest_reward_time: TimePointSec.from(blockchain.timestamp).toString(),
+        })
+        expect(get_validator('alice').latest_reward_block).toEqual(0)
+
+        await contracts.endrmng.actions.settle(['alice']).send('anna@active')
+        expect(get_pending_reward('alice')).toEqual({
+            validator: 'alice',
+            staking_rewards: '0.00000000 XSAT',
+            consensus_rewards: '0.00000000 XSAT',
+            latest_reward_block: 840000,
+            latest_reward_time: TimePointSec.from(blockchain.timestamp).toString(),
+        })
         expect(get_validator('alice')).toEqual({
             commission_rate: 3000,
             consensus_acc_per_share: Asset.from('1.75000000 XSAT')
@@ -831,6 +905,25 @@ describe('endrmng.xsat', () => {
         })
     })
 
+    it('distribute: the block height has been rewarded', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions
+                .distribute([
+                    840000,
+                    [{ validator: 'alice', staking_rewards: '22.50000000 XSAT', consensus_rewards: '2.50000000 XSAT' }],
+                ])
+                .send('rwddist.xsat@active'),
+            'eosio_assert: endrmng.xsat: the block height has been rewarded'
+        )
+    })
+
+    it('settle: [validators] does not exists', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.settle(['tom']).send('anna@active'),
+            'eosio_assert: endrmng.xsat::settle: [validators] does not exists'
+        )
+    })
+
     it('claim: missing required authority', async () => {
         await expectToThrow(
             contracts.endrmng.actions.claim(['tony', 'tony', 0]).send('alice@active'),
@@ -893,6 +986,34 @@ describe('endrmng.xsat', () => {
         })
     })
 
+    it('batchclaim: missing required authority', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.batchclaim(['tony', ['alice'], 0]).send('alice@active'),
+            'missing required authority tony'
+        )
+    })
+
+    it('batchclaim: donate_rate must be less than or equal to 10000', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.batchclaim(['tony', ['alice'], 10001]).send('tony@active'),
+            'eosio_assert: endrmng.xsat::batchclaim: donate_rate must be less than or equal to 10000'
+        )
+    })
+
+    it('batchclaim: [stakers] does not exists', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.batchclaim(['tony', ['alice', 'tom'], 0]).send('tony@active'),
+            'eosio_assert: endrmng.xsat::batchclaim: [stakers] does not exists'
+        )
+    })
+
+    it('batchclaim: no balance to claim', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.batchclaim(['tony', [], 0]).send('tony@active'),
+            'eosio_assert: endrmng.xsat::batchclaim: no balance to claim'
+        )
+    })
+
     it('stake', async () => {
         await contracts.endrmng.actions.stake(['tony', 'alice', Asset.from(2, BTC)]).send('staking.xsat@active')
         expect(get_native_staker(1)).toEqual({
@@ -1314,6 +1435,25 @@ describe('endrmng.xsat', () => {
         })
     })
 
+    it('syncqualify: seeds the XSAT threshold from blkendt.xsat', async () => {
+        // blkendt.xsat is configured before endrmng.xsat had a `qualstat` table
+        await contracts.blkendt.actions.config([0, 0, 2, 860000, 0, '50.00000000 XSAT']).send('blkendt.xsat@active')
+        await contracts.endrmng.actions.cleartable(['qualified', 'btc', 0]).send('endrmng.xsat@active')
+        await contracts.endrmng.actions.cleartable(['qualified', 'xsat', 0]).send('endrmng.xsat@active')
+        await contracts.endrmng.actions.cleartable(['qualstat', null, 0]).send('endrmng.xsat@active')
+        expect(get_qualified('xsat')).toEqual([])
+
+        await contracts.endrmng.actions.syncqualify(['', 0]).send('endrmng.xsat@active')
+        expect(get_qualified('xsat')).toEqual([
+            { validator: 'alice', quantity: '98.00000000 BTC', xsat_quantity: '98.00000000 XSAT' },
+        ])
+        expect(get_qualified_stat()).toMatchObject({
+            min_xsat_qualification: '50.00000000 XSAT',
+            num_xsat_validators: 1,
+            xsat_qualified_staking: '98.00000000 XSAT',
+        })
+    })
+
     /// Not implemented _ashlti3
     //it('creditstake: quantity symbol must be BTC', async () => {
     //    await expectToThrow(
@@ -1336,6 +1476,20 @@ describe('endrmng.xsat', () => {
     //    )
     //})
 
+    it('creditstakes: missing required authority', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.creditstakes([[]]).send('alice@active'),
+            'missing required authority custody.xsat'
+        )
+    })
+
+    it('creditstakes: stakes are empty', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.creditstakes([[]]).send('custody.xsat@active'),
+            'eosio_assert: endrmng.xsat::creditstakes: stakes are empty'
+        )
+    })
+
     it('setdonate: missing required authority', async () => {
         await expectToThrow(
             contracts.endrmng.actions.setdonate(['alice', 100]).send('bob@active'),
@@ -1473,4 +1627,131 @@ describe('endrmng.xsat', () => {
         expect(donate_after_balance - donate_before_balance).toEqual(1749999916)
     })
 
+    it('batchclaim', async () => {
+        await contracts.exsat.actions
+            .transfer(['rwddist.xsat', 'endrmng.xsat', '20.00000000 XSAT', ''])
+            .send('rwddist.xsat@active')
+        await contracts.endrmng.actions
+            .distribute([
+                840004,
+                [
+                    { validator: 'alice', staking_rewards: '10.00000000 XSAT', consensus_rewards: '0.00000000 XSAT' },
+                    { validator: 'tony', staking_rewards: '10.00000000 XSAT', consensus_rewards: '0.00000000 XSAT' },
+                ],
+            ])
+            .send('rwddist.xsat@active')
+
+        const positions = [get_native_staker(1), get_native_staker(2)]
+        const tony_before_balance = getTokenBalance(blockchain, 'tony', 'exsat.xsat', XSAT.code)
+        const donate_before_balance = getTokenBalance(blockchain, 'donate.xsat', 'exsat.xsat', XSAT.code)
+        const total_donated = units(get_stat().xsat_total_donated)
+        await contracts.endrmng.actions.batchclaim(['tony', ['alice', 'tony'], 2000]).send('tony@active')
+
+        // every position is claimed and reset
+        let claimable = 0
+        let donated = 0
+        positions.forEach(position => {
+            const row = get_native_staker(position.id)
+            const position_claimable
+                = units(row.staking_reward_claimed)
+                - units(position.staking_reward_claimed)
+                + units(row.consensus_reward_claimed)
+                - units(position.consensus_reward_claimed)
+            const position_donated = Math.floor((position_claimable * 2000) / 10000)
+            expect(position_claimable).toBeGreaterThan(0)
+            expect(row.staking_reward_unclaimed).toEqual('0.00000000 XSAT')
+            expect(row.consensus_reward_unclaimed).toEqual('0.00000000 XSAT')
+            expect(units(row.total_donated) - units(position.total_donated)).toEqual(position_donated)
+            claimable += position_claimable
+            donated += position_donated
+        })
+
+        // the donation and the reward are paid with `transfer`, so both accounts get a `transfer` notification
+        expect(traces_of('transfers')).toEqual([])
+        const transfers = traces_of('transfer')
+            .filter(trace => trace.contract.toString() === 'exsat.xsat')
+            .map(trace => trace.decodedData)
+        expect(transfers.map(data => [String(data.to), units(data.quantity)])).toEqual([
+            ['donate.xsat', donated],
+            ['tony', claimable - donated],
+        ])
+        expect(getTokenBalance(blockchain, 'tony', 'exsat.xsat', XSAT.code) - tony_before_balance).toEqual(
+            claimable - donated
+        )
+        expect(getTokenBalance(blockchain, 'donate.xsat', 'exsat.xsat', XSAT.code) - donate_before_balance).toEqual(
+            donated
+        )
+        expect(units(get_stat().xsat_total_donated) - total_donated).toEqual(donated)
+    })
+
+    it('evmbtchclaim', async () => {
+        const proxy = 'bb776ae86d5996908af46482f24be8ccde2d4c41'
+        const staker = 'e4d68a77714d9d388d8233bee18d578559950cf5'
+        await contracts.endrmng.actions.addwhitelist(['evmcaller', 'evmutil.xsat']).send('endrmng.xsat@active')
+        await contracts.endrmng.actions.addevmproxy(['evmutil.xsat', proxy]).send('endrmng.xsat@active')
+        for (const validator of ['alice', 'tony']) {
+            await contracts.endrmng.actions
+                .evmstake(['evmutil.xsat', proxy, staker, validator, Asset.from(1, BTC)])
+                .send('evmutil.xsat@active')
+        }
+
+        await contracts.exsat.actions
+            .transfer(['rwddist.xsat', 'endrmng.xsat', '20.00000000 XSAT', ''])
+            .send('rwddist.xsat@active')
+        await contracts.endrmng.actions
+            .distribute([
+                840005,
+                [
+                    { validator: 'alice', staking_rewards: '10.00000000 XSAT', consensus_rewards: '0.00000000 XSAT' },
+                    { validator: 'tony', staking_rewards: '10.00000000 XSAT', consensus_rewards: '0.00000000 XSAT' },
+                ],
+            ])
+            .send('rwddist.xsat@active')
+
+        const get_positions = () =>
+            contracts.endrmng.tables
+                .evmstakers()
+                .getTableRows()
+                .filter(row => row.staker == staker)
+        const positions = get_positions()
+        expect(positions.length).toEqual(2)
+        const erc20_before_balance = getTokenBalance(blockchain, 'erc2o.xsat', 'exsat.xsat', XSAT.code)
+        const total_donated = units(get_stat().xsat_total_donated)
+
+        // an empty list claims every position of the staker through the proxy
+        await contracts.endrmng.actions
+            .evmbtchclaim(['evmutil.xsat', proxy, staker, [], 1000])
+            .send('evmutil.xsat@active')
+
+        let claimable = 0
+        let donated = 0
+        get_positions().forEach((row, i) => {
+            const position_claimable
+                = units(row.staking_reward_claimed)
+                - units(positions[i].staking_reward_claimed)
+                + units(row.consensus_reward_claimed)
+                - units(positions[i].consensus_reward_claimed)
+            const position_donated = Math.floor((position_claimable * 1000) / 10000)
+            expect(position_claimable).toBeGreaterThan(0)
+            expect(row.staking_reward_unclaimed).toEqual('0.00000000 XSAT')
+            expect(row.consensus_reward_unclaimed).toEqual('0.00000000 XSAT')
+            expect(units(row.total_donated) - units(positions[i].total_donated)).toEqual(position_donated)
+            claimable += position_claimable
+            donated += position_donated
+        })
+
+        // the ERC20 bridge only handles `transfer`, the rewards reach it in a single transfer
+        expect(traces_of('transfers')).toEqual([])
+        const transfers = traces_of('transfer')
+            .filter(trace => trace.contract.toString() === 'exsat.xsat')
+            .map(trace => trace.decodedData)
+        expect(transfers.map(data => [String(data.to), units(data.quantity), data.memo])).toEqual([
+            ['donate.xsat', donated, ''],
+            ['erc2o.xsat', claimable - donated, '0x' + staker],
+        ])
+        expect(getTokenBalance(blockchain, 'erc2o.xsat', 'exsat.xsat', XSAT.code) - erc20_before_balance).toEqual(
+            claimable - donated
+        )
+        expect(units(get_stat().xsat_total_donated) - total_donated).toEqual(donated)
+    })
 })
@@ -0,0 +1,139 @@
+// log channels of contracts/internal/events.hpp, against the default builds and the `-DLEGACY_LOG` builds
+const { ABI, Asset, Serializer } = require('@greymass/eosio')
+const { Blockchain } = require('@proton/vert')
+const { BTC } = require('./src/constants')
+
+// the return value of an action is a packed `vector<event>`
+const EVENTS_ABI = ABI.from({
+    structs: [
+        {
+            name: 'event',
+            base: '',
+            fields: [
+                { name: 'tag', type: 'name' },
+                { name: 'data', type: 'bytes' },
+            ],
+        },
+    ],
+})
+
+// events returned by `trace`, each decoded with the log action's struct of `contract`
+const decode_events = (contract, trace) => {
+    const events = Serializer.decode({ data: trace.returnValue, type: 'event[]', abi: EVENTS_ABI })
+    return events.map(event => ({
+        tag: event.tag.toString(),
+        data: Serializer.objectify(
+            Serializer.decode({ data: event.data.array, type: event.tag.toString(), abi: contract.abi })
+        ),
+    }))
+}
+
+const create = wasm => {
+    const blockchain = new Blockchain()
+    const contracts = {
+        rescmng: blockchain.createContract('rescmng.xsat', `tests/wasm/${wasm}rescmng.xsat`, true),
+        btc: blockchain.createContract('btc.xsat', `tests/wasm/${wasm}btc.xsat`, true),
+    }
+    blockchain.createAccounts('alice', 'bob', 'fees.xsat')
+    const traces_of = action => blockchain.actionTraces.filter(trace => trace.action.toString() === action)
+    return { blockchain, contracts, traces_of }
+}
+
+const setup = async ({ contracts }) => {
+    await contracts.btc.actions.create(['btc.xsat', '10000000.00000000 BTC']).send('btc.xsat@active')
+    await contracts.btc.actions.issue(['btc.xsat', '10000000.00000000 BTC', 'init']).send('btc.xsat@active')
+    await contracts.btc.actions.transfer(['btc.xsat', 'bob', '1000.00000000 BTC', '']).send('btc.xsat@active')
+    await contracts.rescmng.actions
+        .init({
+            cost_per_slot: '0.00000001 BTC',
+            cost_per_endorsement: '0.00000004 BTC',
+            cost_per_parse: '0.00000005 BTC',
+            cost_per_upload: '0.00000002 BTC',
+            cost_per_verification: '0.00000003 BTC',
+            fee_account: 'fees.xsat',
+            disabled_withdraw: false,
+        })
+        .send('rescmng.xsat@active')
+    await contracts.btc.actions.transfer(['bob', 'rescmng.xsat', '10.00000000 BTC', 'bob']).send('bob@active')
+}
+
+// a memo that alone does not fit the action return value
+const LONG_MEMO = 'x'.repeat(256)
+
+describe('events', () => {
+    const chain = create('')
+
+    beforeAll(async () => {
+        await setup(chain)
+    })
+
+    it('withdrawlog is returned as an event', async () => {
+        const { contracts, traces_of } = chain
+        await contracts.rescmng.actions.withdraw(['bob', Asset.from(1, BTC)]).send('bob@active')
+
+        expect(traces_of('withdrawlog').length).toEqual(0)
+        const [withdraw] = traces_of('withdraw')
+        expect(decode_events(contracts.rescmng, withdraw)).toEqual([
+            {
+                tag: 'withdrawlog',
+                data: { owner: 'bob', quantity: '1.00000000 BTC', balance: '9.00000000 BTC' },
+            },
+        ])
+    })
+
+    it('transferlog is sent inline whatever the size of the memo', async () => {
+        const { contracts, traces_of } = chain
+        for (const memo of ['', LONG_MEMO]) {
+            await contracts.btc.actions.transfer(['bob', 'alice', '1.00000000 BTC', memo]).send('bob@active')
+
+            const [transfer] = traces_of('transfer')
+            expect(transfer.returnValue.length).toEqual(0)
+            const logs = traces_of('transferlog')
+            expect(logs.length).toEqual(1)
+            expect(logs[0].decodedData.memo).toEqual(memo)
+        }
+    })
+
+    it('transferslog is sent inline', async () => {
+        const { contracts, traces_of } = chain
+        const recipients = [
+            { to: 'alice', quantity: '1.00000000 BTC', memo: LONG_MEMO },
+            { to: 'fees.xsat', quantity: '2.00000000 BTC', memo: '' },
+        ]
+        await contracts.btc.actions.transfers(['bob', recipients]).send('bob@active')
+
+        const [transfers] = traces_of('transfers')
+        expect(transfers.returnValue.length).toEqual(0)
+        const logs = traces_of('transferslog')
+        expect(logs.length).toEqual(1)
+        expect(Asset.from(logs[0].decodedData.quantity).toString()).toEqual('3.00000000 BTC')
+        expect(logs[0].decodedData.recipients.length).toEqual(2)
+    })
+})
+
+describe('events: -DLEGACY_LOG', () => {
+    const chain = create('legacy_log/')
+
+    beforeAll(async () => {
+        await setup(chain)
+    })
+
+    it('withdrawlog is sent inline', async () => {
+        const { contracts, traces_of } = chain
+        await contracts.rescmng.actions.withdraw(['bob', Asset.from(1, BTC)]).send('bob@active')
+
+        const [withdraw] = traces_of('withdraw')
+        expect(withdraw.returnValue.length).toEqual(0)
+        const logs = traces_of('withdrawlog')
+        expect(logs.length).toEqual(1)
+        expect(logs[0].decodedData.owner.toString()).toEqual('bob')
+        expect(Asset.from(logs[0].decodedData.balance).toString()).toEqual('9.00000000 BTC')
+    })
+
+    it('transferlog is sent inline', async () => {
+        const { contracts, traces_of } = chain
+        await contracts.btc.actions.transfer(['bob', 'alice', '1.00000000 BTC', LONG_MEMO]).send('bob@active')
+
+        expect(traces_of('transferlog').length).toEqual(1)
+    })
+})
@@ -443,6 +443,16 @@ describe('poolreg.xsat', () => {
         const donate_after_balance = getTokenBalance(blockchain, 'donate.xsat', 'exsat.xsat', XSAT.code)
         expect(alice_after_balance - alice_before_balance).toEqual(9900000000)
         expect(donate_after_balance - donate_before_balance).toEqual(100000000)
+
+        // the donation and the reward are paid with `transfer`, so both accounts get a `transfer` notification
+        expect(blockchain.actionTraces.filter(trace => trace.action.toString() === 'transfers')).toEqual([])
+        const transfers = blockchain.actionTraces
+            .filter(trace => trace.action.toString() === 'transfer' && trace.contract.toString() === 'exsat.xsat')
+            .map(trace => trace.decodedData)
+        expect(transfers.map(data => [String(data.to), Asset.from(data.quantity).units.toNumber()])).toEqual([
+            ['donate.xsat', 100000000],
+            ['alice', 9900000000],
+        ])
     })
 
     it('claim:  donate_rate < min_donate_rate', async () => {
@@ -0,0 +1,87 @@
+// operation budgets, asserted against the `-DPROFILE` builds of blksync.xsat and utxomng.xsat
+//
+// The counters are derived by the table, send and sha256 shims of contracts/internal/profile.hpp, an emplace writes
+// the row and one entry per secondary index and a modify writes the row and the secondary keys it changes.
+process.env.PIPELINE_PROFILE = '1'
+const { contracts, get_chain_state, setup, replay } = require('./bench/pipeline')
+
+// number of transactions of mainnet block 840000
+const NUM_TRANSACTIONS = 3050
+// `num_txs_per_verification` of the utxomng.xsat config set by `setup`
+const NUM_TXS_PER_VERIFICATION = 2048
+
+jest.setTimeout(10 * 60 * 1000)
+
+// counters of the last action executed by the contract
+const get_profile = contract => {
+    const row = contract.tables.profile().getTableRows()[0]
+    return Object.fromEntries(Object.entries(row).map(([key, value]) => [key, Number(value)]))
+}
+
+// counters of every sample, keyed by action and stage
+const samples = {}
+let num_pending_utxos = 0
+
+const measure = async (key, send) => {
+    await send()
+    const contract = key.startsWith('processblock') ? contracts.utxomng : contracts.blksync
+    ;(samples[key] = samples[key] || []).push(get_profile(contract))
+}
+
+const sum = (key, counter) => (samples[key] || []).reduce((total, sample) => total + sample[counter], 0)
+
+beforeAll(async () => {
+    await setup()
+    await replay(840000, '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5', { measure })
+    expect(get_chain_state().parsed_height).toEqual(840000)
+
+    // 840000 is not irreversible yet, its utxos are still pending
+    num_pending_utxos = contracts.utxomng.tables
+        .pendingutxos()
+        .getTableRows()
+        .filter(row => Number(row.height) === 840000).length
+})
+
+describe('profile', () => {
+    it('pushchunk', () => {
+        const pushchunks = samples['pushchunk']
+        pushchunks.forEach((sample, i) => {
+            // `headers` and `forktree` of `check_consensus`, the bucket and the chunk
+            expect(sample.db_reads).toEqual(4)
+            // the chunk and the bucket, the last chunk also moves the bucket in `bystatus` to upload_complete
+            expect(sample.db_writes).toEqual(i === pushchunks.length - 1 ? 3 : 2)
+            // `pay`, `chunklog` is returned
+            expect(sample.inline_sends).toEqual(1)
+            expect(sample.deserializations).toEqual(0)
+        })
+    })
+
+    it('verify: every transaction is deserialized once', () => {
+        const merkle = ['verify:upload_complete', 'verify:verify_merkle'].map(key => sum(key, 'deserializations'))
+        expect(merkle[0] + merkle[1]).toEqual(NUM_TRANSACTIONS)
+        expect(sum('verify:verify_parent_hash', 'deserializations')).toBeLessThanOrEqual(1)
+    })
+
+    it('verify: merkle steps stay within num_txs_per_verification', () => {
+        for (const sample of [...samples['verify:upload_complete'], ...(samples['verify:verify_merkle'] || [])]) {
+            expect(sample.deserializations).toBeLessThanOrEqual(NUM_TXS_PER_VERIFICATION)
+            // the bucket and its `bystatus` entry
+            expect(sample.db_writes).toEqual(2)
+        }
+    })
+
+    it('processblock: parsing', () => {
+        expect(sum('processblock:parsing', 'deserializations')).toEqual(NUM_TRANSACTIONS)
+        expect(num_pending_utxos).toBeGreaterThan(0)
+        // each pending utxo is the row and 6 secondary entries, each step saves `chainstate` and the last one marks the
+        // block parsed, which moves it in `parseheight`
+        const num_steps = samples['processblock:parsing'].length
+        expect(sum('processblock:parsing', 'db_writes')).toEqual(7 * num_pending_utxos + num_steps + 2)
+        // one `available_primary_key` per pending utxo, each step also reads `chainstate`, `config` and the chunks
+        const num_chunks = samples['pushchunk'].length
+        expect(sum('processblock:parsing', 'db_reads')).toBeGreaterThanOrEqual(num_pending_utxos)
+        expect(sum('processblock:parsing', 'db_reads')).toBeLessThanOrEqual(
+            num_pending_utxos + num_steps * (4 + 3 * num_chunks) + 2
+        )
+    })
+})
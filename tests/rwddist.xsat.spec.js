@@ -42,6 +42,21 @@ describe('rwddist.xsat', () => {
         )
     })
 
+    it('config: missing required authority', async () => {
+        await expectToThrow(
+            contracts.rwddist.actions.config([144]).send('alice@active'),
+            'missing required authority rwddist.xsat'
+        )
+    })
+
+    it('config', async () => {
+        await contracts.rwddist.actions.config([144]).send('rwddist.xsat@active')
+        expect(contracts.rwddist.tables.config().getTableRows()[0]).toEqual({ num_blocks_per_settlement: 144 })
+
+        await contracts.rwddist.actions.config([0]).send('rwddist.xsat@active')
+        expect(contracts.rwddist.tables.config().getTableRows()[0]).toEqual({ num_blocks_per_settlement: 0 })
+    })
+
     it('distribute', async () => {
         await expectToThrow(
             contracts.rwddist.actions.distribute([840000]).send('utxomng.xsat@active'),
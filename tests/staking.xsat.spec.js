@@ -31,6 +31,11 @@ const get_release = staker => {
     return contracts.staking.tables.releases(scope).getTableRows()
 }
 
+const get_withdrawable = staker => {
+    const scope = Name.from(staker).value.value
+    return contracts.staking.tables.withdrawable(scope).getTableRows()
+}
+
 // one-time setup
 beforeAll(async () => {
     blockchain.setTime(TimePointSec.from(new Date()))
@@ -198,6 +203,25 @@ describe('staking.xsat', () => {
         ])
     })
 
+    it('withdraw: aggregate expired releases', async () => {
+        blockchain.addTime(TimePointSec.fromInteger(UNLOCKING_DURATION))
+        await contracts.btc.actions.transfer(['bob', 'staking.xsat', Asset.from(2, BTC), 'alice']).send('bob@active')
+        await contracts.staking.actions.release([1, 'bob', 'alice', Asset.from(1, BTC)]).send('bob@active')
+        expect(get_withdrawable('bob')).toEqual([
+            { id: 0, quantity: { contract: 'btc.xsat', quantity: '1.00000000 BTC' } },
+        ])
+
+        await contracts.staking.actions.release([1, 'bob', 'alice', Asset.from(1, BTC)]).send('bob@active')
+        blockchain.addTime(TimePointSec.fromInteger(UNLOCKING_DURATION))
+
+        const before_balance = getTokenBalance(blockchain, 'bob', 'btc.xsat', BTC.code)
+        await contracts.staking.actions.withdraw(['bob']).send('bob@active')
+        const after_balance = getTokenBalance(blockchain, 'bob', 'btc.xsat', BTC.code)
+        expect(after_balance - before_balance).toEqual(Asset.from(3, BTC).units.toNumber())
+        expect(get_release('bob')).toEqual([])
+        expect(get_withdrawable('bob')).toEqual([])
+    })
+
     it('setstatus: missing required authority', async () => {
         await expectToThrow(
             contracts.staking.actions.setstatus([1, true]).send('bob@active'),
@@ -1,9 +1,9 @@
-const { TimePointSec } = require('@greymass/eosio')
+const { Asset, Serializer, TimePointSec } = require('@greymass/eosio')
 const { Blockchain, expectToThrow } = require('@proton/vert')
 const { BTC, BTC_CONTRACT } = require('./src/constants')
 const fs = require('fs')
 const path = require('path')
-const { addTime, decodeReturn_verify, max_chunk_size } = require('./src/help')
+const { addTime, decodeReturn_verify, getTokenBalance, max_chunk_size } = require('./src/help')
 
 // Vert EOS VM
 const blockchain = new Blockchain()
@@ -20,6 +20,7 @@ const contracts = {
     btc: blockchain.createContract('btc.xsat', 'tests/wasm/btc.xsat', true),
     exsat: blockchain.createContract('exsat.xsat', 'tests/wasm/exsat.xsat', true),
     rwddist: blockchain.createContract('rwddist.xsat', 'tests/wasm/rwddist.xsat', true),
+    custody: blockchain.createContract('custody.xsat', 'tests/wasm/custody.xsat', true),
 }
 
 // accounts
@@ -47,10 +48,38 @@ const get_block = height => {
     return contracts.utxomng.tables.blocks().getTableRow(BigInt(height))
 }
 
+const get_header = height => {
+    return contracts.utxomng.tables.headers().getTableRow(BigInt(height))
+}
+
+const get_header_archive = () => {
+    return contracts.utxomng.tables.hdrarchive().getTableRows()[0]
+}
+
+const get_header_epoch = epoch => {
+    return contracts.utxomng.tables.hdrepochs().getTableRow(BigInt(epoch))
+}
+
+const get_utxo_commit = () => {
+    return contracts.utxomng.tables.utxocommit().getTableRows()[0]
+}
+
+const get_utxo_checkpoint = height => {
+    return contracts.utxomng.tables.utxocommits().getTableRow(BigInt(height))
+}
+
 const get_config = () => {
     return contracts.utxomng.tables.config().getTableRows()[0]
 }
 
+const get_chain_tips = () => {
+    return contracts.utxomng.tables.chaintips().getTableRows()
+}
+
+const get_fork_node = bucket_id => {
+    return contracts.utxomng.tables.forktree().getTableRow(BigInt(bucket_id))
+}
+
 const pushUpload = async (sender, height, hash, block) => {
     const chunks = []
     let next_offset = 0
@@ -179,6 +208,21 @@ describe('utxomng.xsat', () => {
         expect(blockchain.actionTraces[0].returnValue[0]).toEqual(0)
     })
 
+    it('setwatch: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setwatch([true]).send('alice@active'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('setwatch', async () => {
+        await contracts.utxomng.actions.setwatch([true]).send('utxomng.xsat@active')
+        expect(contracts.utxomng.tables.watchconfig().getTableRows()[0]).toEqual({ custody_enabled: true })
+
+        await contracts.utxomng.actions.setwatch([false]).send('utxomng.xsat@active')
+        expect(contracts.utxomng.tables.watchconfig().getTableRows()[0]).toEqual({ custody_enabled: false })
+    })
+
     it('addutxo: missing required authority', async () => {
         await expectToThrow(
             contracts.utxomng.actions
@@ -205,10 +249,16 @@ describe('utxomng.xsat', () => {
         await contracts.utxomng.actions.addutxo(utxo).send('utxomng.xsat@active')
         expect(get_utxo(1)).toEqual(utxo)
         expect(get_chain_state().num_utxos).toEqual(1)
+        expect(get_utxo_commit()).toEqual({
+            utxo_set_hash: 'c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0',
+        })
         // update
         await contracts.utxomng.actions.addutxo(utxo).send('utxomng.xsat@active')
         expect(get_utxo(1)).toEqual(utxo)
         expect(get_chain_state().num_utxos).toEqual(1)
+        expect(get_utxo_commit()).toEqual({
+            utxo_set_hash: 'c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0',
+        })
     })
 
     it('delutxo: missing required authority utxomng.xsat', async () => {
@@ -228,6 +278,9 @@ describe('utxomng.xsat', () => {
     it('delutxo', async () => {
         await contracts.utxomng.actions.delutxo([1]).send('utxomng.xsat@active')
         expect(get_utxo(1)).toEqual(undefined)
+        expect(get_utxo_commit()).toEqual({
+            utxo_set_hash: '0000000000000000000000000000000000000000000000000000000000000000',
+        })
         expect(get_chain_state()).toEqual({
             head_height: 0,
             irreversible_height: 0,
@@ -249,6 +302,42 @@ describe('utxomng.xsat', () => {
         })
     })
 
+    const utxo_page =
+        'a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf01000000fb80e4f2000000001976a914536ffa992491508dca0354e52f32a3a7a679a53a88ac'
+
+    it('addutxos: utxo_set_hash does not match the declared rolling hash', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .addutxos(['0000000000000000000000000000000000000000000000000000000000000001', utxo_page])
+                .send('utxomng.xsat@active'),
+            'eosio_assert: utxomng.xsat::addutxos: utxo_set_hash does not match the declared rolling hash'
+        )
+    })
+
+    it('addutxos', async () => {
+        await contracts.utxomng.actions
+            .addutxos(['c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0', utxo_page])
+            .send('utxomng.xsat@active')
+        expect(get_utxo(1)).toEqual({
+            id: 1,
+            index: 1,
+            scriptpubkey: '76a914536ffa992491508dca0354e52f32a3a7a679a53a88ac',
+            txid: 'a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf',
+            value: 4075061499,
+        })
+        expect(get_chain_state().num_utxos).toEqual(1)
+
+        await expectToThrow(
+            contracts.utxomng.actions
+                .addutxos(['c58a9bb102a9fac784a832f022bd139ae086b93dfb29a525fc58755f32f411a0', utxo_page])
+                .send('utxomng.xsat@active'),
+            'eosio_assert: utxomng.xsat::addutxos: [utxos] already exists'
+        )
+
+        await contracts.utxomng.actions.delutxo([1]).send('utxomng.xsat@active')
+        expect(get_chain_state().num_utxos).toEqual(0)
+    })
+
     it('addblock: missing required authority utxomng.xsat', async () => {
         await expectToThrow(
             contracts.utxomng.actions
@@ -306,6 +395,14 @@ describe('utxomng.xsat', () => {
         }
         await contracts.utxomng.actions.addblock(block).send('utxomng.xsat@active')
         expect(get_block(839999)).toEqual(block)
+        expect(get_header(839999)).toEqual({
+            height: block.height,
+            hash: block.hash,
+            previous_block_hash: block.previous_block_hash,
+            cumulative_work: block.cumulative_work,
+            timestamp: block.timestamp,
+            bits: block.bits,
+        })
     })
 
     it('delblock: missing required authority utxomng.xsat', async () => {
@@ -325,6 +422,67 @@ describe('utxomng.xsat', () => {
     it('delblock', async () => {
         await contracts.utxomng.actions.delblock([839999]).send('utxomng.xsat@active')
         expect(get_block(839999)).toEqual(undefined)
+        expect(get_header(839999)).toEqual(undefined)
+    })
+
+    const header_838656 =
+        '0000812e28e0ae3dea13180d58259e5e080ccf85034389b9ea3a020000000000000000001ad95d81e9bb6eebe2668c0826ae14cde2b19ec9d5dca9bc34369f1db566ad25ed011766194203175f4c38b0'
+
+    it('addheaders: missing required authority utxomng.xsat', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .addheaders([
+                    838656,
+                    '0000000000000000000000000000000000000000739f0c837d8538b068f839a0',
+                    header_838656,
+                ])
+                .send('alice@active'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('addheaders: the archive must start at the first block of an epoch', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .addheaders([
+                    838657,
+                    '0000000000000000000000000000000000000000739f0c837d8538b068f839a0',
+                    header_838656,
+                ])
+                .send('utxomng.xsat@active'),
+            'eosio_assert: utxomng.xsat::addheaders: the archive must start at the first block of an epoch'
+        )
+    })
+
+    it('addheaders', async () => {
+        await contracts.utxomng.actions
+            .addheaders([838656, '0000000000000000000000000000000000000000739f0c837d8538b068f839a0', header_838656])
+            .send('utxomng.xsat@active')
+        const hash = '00000000000000000001f2fa38c036edc385487c0226fbffc8bfe72c5a655899'
+        expect(get_header_archive()).toEqual({
+            start_height: 838656,
+            num_headers: 1,
+            last_hash: hash,
+            cumulative_work: '0000000000000000000000000000000000000000739f5b15b3757c13af5b1a6b',
+            peaks: [hash],
+            mmr_root: hash,
+        })
+        expect(get_header_epoch(416).cumulative_work).toEqual(
+            '0000000000000000000000000000000000000000739f0c837d8538b068f839a0'
+        )
+    })
+
+    it('addheaders: start_height must follow the last archived header', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .addheaders([
+                    838656,
+                    '0000000000000000000000000000000000000000739f0c837d8538b068f839a0',
+                    header_838656,
+                ])
+                .send('utxomng.xsat@active'),
+            'eosio_assert: utxomng.xsat::addheaders: start_height must follow the last archived header'
+        )
     })
 
     it('init: missing required authority', async () => {
@@ -699,6 +857,33 @@ describe('utxomng.xsat', () => {
         })
     })
 
+    it('chain tips: 840001', async () => {
+        for (const [bucket_id, parent_bucket_id] of [
+            [1, 0],
+            [2, 1],
+        ]) {
+            const consensus_block = get_consensus_block(bucket_id)
+            expect(get_fork_node(bucket_id)).toEqual({
+                bucket_id,
+                height: consensus_block.height,
+                parent_bucket_id,
+                hash: consensus_block.hash,
+                previous_block_hash: consensus_block.previous_block_hash,
+                cumulative_work: consensus_block.cumulative_work,
+                timestamp: consensus_block.timestamp,
+                bits: consensus_block.bits,
+            })
+        }
+        expect(get_chain_tips()).toEqual([
+            {
+                bucket_id: 2,
+                height: 840001,
+                hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463',
+                cumulative_work: get_consensus_block(2).cumulative_work,
+            },
+        ])
+    })
+
     it('there are currently no block to parse', async () => {
         await expectToThrow(
             contracts.utxomng.actions.processblock(['bob', 0, get_nonce()]).send('bob@active'),
@@ -1087,6 +1272,26 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 4,
             status: 4,
         })
+
+        // the irreversible block moves from the fork tree to the header index
+        const block = get_block(840000)
+        expect(get_header(840000)).toEqual({
+            height: 840000,
+            hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
+            previous_block_hash: '0000000000000000000172014ba58d66455762add0512355ad651207918494ab',
+            cumulative_work: block.cumulative_work,
+            timestamp: block.timestamp,
+            bits: block.bits,
+        })
+        expect(get_fork_node(1)).toEqual(undefined)
+
+        // the UTXO set commitment is checkpointed once the block has been migrated
+        expect(get_utxo_checkpoint(840000)).toEqual({
+            height: 840000,
+            hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
+            utxo_set_hash: get_utxo_commit().utxo_set_hash,
+            num_utxos: 6683,
+        })
     })
 
     it('parse 840006: distribute rewards', async () => {
@@ -1166,4 +1371,365 @@ describe('utxomng.xsat', () => {
                 status: 1,
             })
     })
+
+    // a custody address that receives outputs of 840001 and spends an output added to the UTXO set
+    const custody = {
+        proxy: '0000000000000000000000000000000000000001',
+        staker: 'e4d68a77714d9d388d8233bee18d578559950cf5',
+        spent: 1000,
+    }
+    const MAX_STAKING = 10000000000
+    let migrate_traces = []
+
+    const get_custody_balance = () => {
+        return contracts.custody.tables.balances().getTableRow(BigInt(custody.id))
+    }
+
+    it('migrate 840001: watch a custody address', async () => {
+        const pending_utxos = contracts.utxomng.tables
+            .pendingutxos()
+            .getTableRows()
+            .filter(row => Number(row.height) === 840001)
+        const vouts = pending_utxos.filter(row => row.type === 'vout')
+        const vout = vouts.find(row => Number(row.value) > custody.spent && Number(row.value) < 100000000)
+        // an input that does not spend an output of the same block
+        const vin = pending_utxos.find(row => row.type === 'vin' && !vouts.some(output => output.txid === row.txid))
+        custody.received = vouts
+            .filter(row => String(row.scriptpubkey) === String(vout.scriptpubkey))
+            .reduce((sum, row) => sum + Number(row.value), 0)
+
+        const utxo_id = Math.max(...contracts.utxomng.tables.utxos().getTableRows().map(row => Number(row.id))) + 1
+        await contracts.utxomng.actions
+            .addutxo([utxo_id, vin.txid, vin.index, vout.scriptpubkey, custody.spent])
+            .send('utxomng.xsat@active')
+
+        await contracts.endrmng.actions.addcrdtproxy([custody.proxy]).send('endrmng.xsat@active')
+        await contracts.custody.actions
+            .addcustody([custody.staker, custody.proxy, 'alice', null, vout.scriptpubkey])
+            .send('custody.xsat@active')
+        custody.id = contracts.custody.tables
+            .custodies()
+            .getTableRows()
+            .find(row => row.staker === custody.staker).id
+
+        // seeded at the irreversible 840000, 840001 takes the balance to `MAX_STAKING`
+        custody.seed = MAX_STAKING - (custody.received - custody.spent)
+        await contracts.custody.actions
+            .creditstakes([[{ staker: custody.staker, balance: custody.seed }]])
+            .send('custody.xsat@active')
+        expect(get_custody_balance()).toEqual({
+            id: custody.id,
+            balance: custody.seed,
+            seed_height: 840000,
+            drift: 0,
+            stake_pending: false,
+        })
+
+        await contracts.utxomng.actions.setwatch([true]).send('utxomng.xsat@active')
+    })
+
+    it('migrate 840001: validator rewards are accumulated and settled by rwddist.xsat', async () => {
+        const units = asset => Asset.from(asset).units.toNumber()
+        const traces_of = action => blockchain.actionTraces.filter(trace => trace.action.toString() === action)
+
+        // every block is its own settlement
+        await contracts.rwddist.actions.config([1]).send('rwddist.xsat@active')
+        const endrmng_balance = getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT')
+
+        blockchain.addTime(TimePointSec.from(600))
+        let settlelogs = []
+        while (get_chain_state().status != 3) {
+            await contracts.utxomng.actions.processblock(['alice', 5000, get_nonce()]).send('alice@active')
+            settlelogs = settlelogs.concat(traces_of('settlelog'))
+            migrate_traces = migrate_traces.concat(blockchain.actionTraces)
+        }
+
+        // `distribute` allocates every validator at once, accumulates them and settles the block
+        const reward_log = contracts.rwddist.tables.rewardlogs().getTableRow(BigInt(840001))
+        expect(reward_log.num_validators_assigned).toEqual(reward_log.provider_validators.length)
+        expect(contracts.rwddist.tables.accstat().getTableRows()).toEqual([])
+        expect(contracts.rwddist.tables.accrewards().getTableRows()).toEqual([])
+
+        const total_rewards = units(reward_log.staking_rewards) + units(reward_log.consensus_rewards)
+        expect(getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT') - endrmng_balance).toEqual(
+            total_rewards
+        )
+
+        expect(settlelogs.length).toEqual(1)
+        const settlelog = settlelogs[0].decodedData
+        expect(Number(settlelog.start_height)).toEqual(840001)
+        expect(Number(settlelog.end_height)).toEqual(840001)
+        expect(settlelog.reward_details.map(detail => String(detail.validator)).sort()).toEqual(
+            reward_log.provider_validators.map(validator => validator.account).sort()
+        )
+        expect(
+            settlelog.reward_details.reduce(
+                (sum, detail) => sum + units(detail.staking_rewards) + units(detail.consensus_rewards),
+                0
+            )
+        ).toEqual(total_rewards)
+
+        // the fully assigned block skips `distributing_rewards`
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(traces_of('endtreward')).toEqual([])
+        expect(get_chain_state()).toMatchObject({
+            irreversible_hash: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463',
+            irreversible_height: 840001,
+            migrating_height: 0,
+            num_validators_assigned: 0,
+            num_provider_validators: 0,
+            status: 5,
+        })
+
+        await contracts.rwddist.actions.config([0]).send('rwddist.xsat@active')
+    })
+
+    it('migrate 840001: custody balances are synced and cross the staking threshold', async () => {
+        const traces_of = (contract, action) =>
+            migrate_traces.filter(
+                trace => trace.contract.toString() === contract && trace.action.toString() === action
+            )
+
+        // one `syncbalances` per migrate call that touched the custody address
+        const syncs = traces_of('custody.xsat', 'syncbalances')
+        expect(syncs.length).toBeGreaterThan(0)
+        for (const sync of syncs) {
+            expect(Number(sync.decodedData.height)).toEqual(840001)
+        }
+        const delta = syncs
+            .flatMap(sync => sync.decodedData.deltas)
+            .filter(item => Number(item.id) === Number(custody.id))
+            .reduce((sum, item) => sum + Number(item.value), 0)
+        expect(delta).toEqual(custody.received - custody.spent)
+        expect(get_custody_balance()).toEqual({
+            id: custody.id,
+            balance: MAX_STAKING,
+            seed_height: 840000,
+            drift: 0,
+            stake_pending: false,
+        })
+
+        const credit_stakes = traces_of('endrmng.xsat', 'creditstakes')
+        expect(credit_stakes.length).toEqual(1)
+        expect(credit_stakes[0].decodedData.stakes.map(stake => stake.staker.toString())).toEqual([custody.staker])
+        expect(Asset.from(credit_stakes[0].decodedData.stakes[0].quantity).units.toNumber()).toEqual(MAX_STAKING)
+
+        // deltas at or below the seed height are already part of the balance
+        await contracts.custody.actions
+            .creditstakes([[{ staker: custody.staker, balance: MAX_STAKING }]])
+            .send('custody.xsat@active')
+        expect(get_custody_balance().seed_height).toEqual(840001)
+        await contracts.custody.actions
+            .syncbalances([840001, [{ id: custody.id, value: -MAX_STAKING }]])
+            .send('utxomng.xsat@active')
+        expect(get_custody_balance().balance).toEqual(MAX_STAKING)
+
+        // a spend larger than the balance is recorded as drift and keeps the credit stake
+        await contracts.custody.actions
+            .syncbalances([840002, [{ id: custody.id, value: -(MAX_STAKING + 1) }]])
+            .send('utxomng.xsat@active')
+        expect(get_custody_balance()).toEqual({
+            id: custody.id,
+            balance: 0,
+            seed_height: 840001,
+            drift: 1,
+            stake_pending: false,
+        })
+        expect(blockchain.actionTraces.filter(trace => trace.action.toString() === 'creditstakes')).toEqual([])
+
+        await contracts.utxomng.actions.setwatch([false]).send('utxomng.xsat@active')
+    })
+
+    describe('rwddist.xsat: rewards accumulated across blocks', () => {
+        const units = asset => Asset.from(asset).units.toNumber()
+        const block_hash = n => n.toString(16).padStart(64, '0')
+        const validators = ['alice', 'amy', 'anna']
+        const traces_of = (contract, action) =>
+            blockchain.actionTraces.filter(
+                trace => trace.contract.toString() === contract && trace.action.toString() === action
+            )
+        const get_reward_log = height => contracts.rwddist.tables.rewardlogs().getTableRow(BigInt(height))
+        const get_accumulation = () => contracts.rwddist.tables.accstat().getTableRows()[0]
+        const get_accumulated_rewards = () => contracts.rwddist.tables.accrewards().getTableRows()
+        const block_rewards = height => {
+            const reward_log = get_reward_log(height)
+            return units(reward_log.staking_rewards) + units(reward_log.consensus_rewards)
+        }
+        const accumulated_rewards = () =>
+            get_accumulated_rewards().reduce(
+                (sum, row) => sum + units(row.staking_rewards) + units(row.consensus_rewards),
+                0
+            )
+
+        // endorsed by every validator and pointed to by `migrating_height`, without migrating any UTXO
+        const migrate_block = async height => {
+            const created_at = TimePointSec.from(blockchain.timestamp).toString()
+            await contracts.blkendt.actions
+                .addlegacyend([
+                    height,
+                    block_hash(height),
+                    validators.map(account => ({ account, staking: '10000000000', created_at })),
+                    [],
+                ])
+                .send('blkendt.xsat@active')
+            await contracts.blkendt.actions.migrateendt([height]).send('blkendt.xsat@active')
+            await contracts.utxomng.actions
+                .setmigrating([height, block_hash(height), 'alice'])
+                .send('utxomng.xsat@active')
+        }
+        const distribute = height => contracts.rwddist.actions.distribute([height]).send('utxomng.xsat@active')
+        const endtreward = (height, from_index, to_index) =>
+            contracts.rwddist.actions.endtreward([height, from_index, to_index]).send('utxomng.xsat@active')
+
+        let endrmng_balance = 0
+
+        beforeAll(async () => {
+            // `distribute` allocates two of the three validators, `endtreward` the last one
+            await contracts.utxomng.actions.config([600, 2, 5000, 100, 11, 0]).send('utxomng.xsat@active')
+            await contracts.rwddist.actions.config([2]).send('rwddist.xsat@active')
+            endrmng_balance = getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT')
+        })
+
+        afterAll(async () => {
+            await contracts.rwddist.actions.config([0]).send('rwddist.xsat@active')
+            await contracts.utxomng.actions.config([600, 100, 5000, 100, 11, 0]).send('utxomng.xsat@active')
+            await contracts.utxomng.actions.setmigrating([0, block_hash(0), '']).send('utxomng.xsat@active')
+        })
+
+        it('a block allocated over several actions is counted once', async () => {
+            await migrate_block(850001)
+            await distribute(850001)
+            expect(get_reward_log(850001).num_validators_assigned).toEqual(2)
+            expect(get_accumulation()).toMatchObject({ start_height: 850001, latest_height: 850001, num_blocks: 1 })
+            expect(get_accumulated_rewards().map(row => String(row.validator)).sort()).toEqual(['alice', 'amy'])
+
+            // `endtreward` keeps accumulating the block `distribute` started, nothing is paid to endrmng.xsat
+            await endtreward(850001, 2, 3)
+            expect(traces_of('endrmng.xsat', 'distribute')).toEqual([])
+            expect(traces_of('rwddist.xsat', 'endtrwdlog')).toEqual([])
+            expect(traces_of('rwddist.xsat', 'settlelog')).toEqual([])
+            expect(get_reward_log(850001).num_validators_assigned).toEqual(3)
+            expect(get_accumulation()).toMatchObject({ start_height: 850001, latest_height: 850001, num_blocks: 1 })
+            expect(get_accumulated_rewards().map(row => String(row.validator)).sort()).toEqual(validators)
+            expect(accumulated_rewards()).toEqual(block_rewards(850001))
+            expect(getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT')).toEqual(endrmng_balance)
+        })
+
+        it('rewards are settled once `num_blocks_per_settlement` blocks are accumulated', async () => {
+            await migrate_block(850002)
+            await distribute(850002)
+            expect(traces_of('rwddist.xsat', 'settlelog')).toEqual([])
+            expect(get_accumulation()).toMatchObject({ start_height: 850001, latest_height: 850002, num_blocks: 2 })
+            expect(accumulated_rewards()).toBeLessThan(block_rewards(850001) + block_rewards(850002))
+
+            await endtreward(850002, 2, 3)
+            const settlelogs = traces_of('rwddist.xsat', 'settlelog')
+            expect(settlelogs.length).toEqual(1)
+            const settlelog = settlelogs[0].decodedData
+            expect(Number(settlelog.start_height)).toEqual(850001)
+            expect(Number(settlelog.end_height)).toEqual(850002)
+            expect(settlelog.reward_details.map(detail => String(detail.validator)).sort()).toEqual(validators)
+
+            // one payment covers both blocks
+            const distributions = traces_of('endrmng.xsat', 'distribute')
+            expect(distributions.length).toEqual(1)
+            expect(Number(distributions[0].decodedData.height)).toEqual(850002)
+            expect(get_accumulation()).toEqual(undefined)
+            expect(get_accumulated_rewards()).toEqual([])
+            expect(getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT') - endrmng_balance).toEqual(
+                block_rewards(850001) + block_rewards(850002)
+            )
+        })
+
+        it('switching back to settling every block flushes the pending rewards', async () => {
+            await migrate_block(850003)
+            await distribute(850003)
+            await endtreward(850003, 2, 3)
+            expect(traces_of('rwddist.xsat', 'settlelog')).toEqual([])
+            expect(get_accumulation()).toMatchObject({ start_height: 850003, latest_height: 850003, num_blocks: 1 })
+
+            await contracts.rwddist.actions.config([0]).send('rwddist.xsat@active')
+            await migrate_block(850004)
+            await distribute(850004)
+            const settlelogs = traces_of('rwddist.xsat', 'settlelog')
+            expect(settlelogs.length).toEqual(1)
+            expect(Number(settlelogs[0].decodedData.start_height)).toEqual(850003)
+            expect(Number(settlelogs[0].decodedData.end_height)).toEqual(850003)
+            expect(get_accumulation()).toEqual(undefined)
+            expect(get_accumulated_rewards()).toEqual([])
+
+            // the new block is not accumulated, `endtreward` pays it
+            expect(get_reward_log(850004).num_validators_assigned).toEqual(0)
+            await endtreward(850004, 0, 3)
+            expect(traces_of('rwddist.xsat', 'endtrwdlog').length).toEqual(1)
+            expect(get_accumulation()).toEqual(undefined)
+            expect(getTokenBalance(blockchain, 'endrmng.xsat', 'exsat.xsat', 'XSAT') - endrmng_balance).toEqual(
+                block_rewards(850001) + block_rewards(850002) + block_rewards(850003) + block_rewards(850004)
+            )
+        })
+    })
+
+    describe('chain tips: out-of-order consensus', () => {
+        const block_hash = n => n.toString(16).padStart(64, '0')
+        const irreversible_hash = block_hash(0x9000)
+
+        const add_consensus_block = (bucket_id, height, hash, previous_block_hash, work) =>
+            contracts.utxomng.actions
+                .addconsesblk([
+                    bucket_id,
+                    height,
+                    hash,
+                    block_hash(work),
+                    0,
+                    previous_block_hash,
+                    block_hash(0),
+                    0,
+                    0,
+                    0,
+                    'alice',
+                    'alice',
+                    TimePointSec.from(blockchain.timestamp),
+                ])
+                .send('utxomng.xsat@active')
+
+        const next_irreversible_block = async () => {
+            await contracts.utxomng.actions.nextirrblk([900000, irreversible_hash]).send('utxomng.xsat@active')
+            return Serializer.decode({
+                data: blockchain.actionTraces[0].returnValue,
+                abi: contracts.utxomng.abi,
+                type: 'consensus_block_row',
+            })
+        }
+
+        // fork a: a1 <- a2, fork b: b1 <- b2 <- b3, b3 is the heaviest tip and reaches consensus before b2
+        const a1 = block_hash(0x9a01)
+        const a2 = block_hash(0x9a02)
+        const b1 = block_hash(0x9b01)
+        const b2 = block_hash(0x9b02)
+        const b3 = block_hash(0x9b03)
+
+        it('child is stored without a parent', async () => {
+            await add_consensus_block(101, 900001, a1, irreversible_hash, 10)
+            await add_consensus_block(102, 900002, a2, a1, 25)
+            await add_consensus_block(103, 900001, b1, irreversible_hash, 11)
+            await add_consensus_block(105, 900003, b3, b2, 31)
+
+            expect(get_fork_node(105).parent_bucket_id).toEqual(0)
+        })
+
+        it('parent relinks the child', async () => {
+            await add_consensus_block(104, 900002, b2, b1, 21)
+
+            expect(get_fork_node(104).parent_bucket_id).toEqual(103)
+            expect(get_fork_node(105).parent_bucket_id).toEqual(104)
+            const tips = get_chain_tips().filter(tip => tip.height >= 900000)
+            expect(tips.map(tip => tip.bucket_id).sort()).toEqual([102, 105])
+        })
+
+        it('irreversible block follows the heaviest tip', async () => {
+            const block = await next_irreversible_block()
+            expect(block.bucket_id.toNumber()).toEqual(103)
+            expect(String(block.hash)).toEqual(b1)
+        })
+    })
 })
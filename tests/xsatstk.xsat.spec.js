@@ -27,6 +27,11 @@ const get_release = staker => {
     return contracts.xsatstk.tables.releases(scope).getTableRows()
 }
 
+const get_withdrawable = staker => {
+    const key = Name.from(staker).value.value
+    return contracts.xsatstk.tables.withdrawable().getTableRow(key)
+}
+
 // one-time setup
 beforeAll(async () => {
     blockchain.setTime(TimePointSec.from(new Date()))
@@ -149,6 +154,23 @@ describe('xsatstk.xsat', () => {
         ])
     })
 
+    it('withdraw: aggregate expired releases', async () => {
+        blockchain.addTime(TimePointSec.fromInteger(UNLOCKING_DURATION))
+        await contracts.xsat.actions.transfer(['bob', 'xsatstk.xsat', Asset.from(2, XSAT), 'alice']).send('bob@active')
+        await contracts.xsatstk.actions.release(['bob', 'alice', Asset.from(1, XSAT)]).send('bob@active')
+        expect(get_withdrawable('bob')).toEqual({ staker: 'bob', quantity: '1.00000000 XSAT' })
+
+        await contracts.xsatstk.actions.release(['bob', 'alice', Asset.from(1, XSAT)]).send('bob@active')
+        blockchain.addTime(TimePointSec.fromInteger(UNLOCKING_DURATION))
+
+        const before_balance = getTokenBalance(blockchain, 'bob', 'exsat.xsat', XSAT.code)
+        await contracts.xsatstk.actions.withdraw(['bob']).send('bob@active')
+        const after_balance = getTokenBalance(blockchain, 'bob', 'exsat.xsat', XSAT.code)
+        expect(after_balance - before_balance).toEqual(Asset.from(3, XSAT).units.toNumber())
+        expect(get_release('bob')).toEqual([])
+        expect(get_withdrawable('bob')).toBeUndefined()
+    })
+
     it('setstatus: missing required authority', async () => {
         await expectToThrow(
             contracts.xsatstk.actions.setstatus([true]).send('bob@active'),